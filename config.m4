@@ -133,15 +133,19 @@ if test "$PHP_MONGODB" != "no"; then
     src/BSON/UTCDateTimeInterface.c \
     src/BSON/functions.c \
     src/MongoDB/BulkWrite.c \
+    src/MongoDB/ClientBulkWrite.c \
     src/MongoDB/ClientEncryption.c \
     src/MongoDB/Command.c \
     src/MongoDB/Cursor.c \
     src/MongoDB/CursorId.c \
     src/MongoDB/CursorInterface.c \
     src/MongoDB/Manager.c \
+    src/MongoDB/MergedCursor.c \
+    src/MongoDB/PreparedOperation.c \
     src/MongoDB/Query.c \
     src/MongoDB/ReadConcern.c \
     src/MongoDB/ReadPreference.c \
+    src/MongoDB/ResultSet.c \
     src/MongoDB/Server.c \
     src/MongoDB/Session.c \
     src/MongoDB/WriteConcern.c \
@@ -98,11 +98,13 @@ void php_phongo_zval_to_bson(zval* data, php_phongo_bson_flags_t flags, bson_t*
 bool php_phongo_bson_to_zval_ex(const unsigned char* data, int data_len, php_phongo_bson_state* state);
 bool php_phongo_bson_to_zval(const unsigned char* data, int data_len, zval* out);
 bool php_phongo_bson_value_to_zval(const bson_value_t* value, zval* zv);
+int  php_phongo_bson_value_compare(const bson_value_t* a, const bson_value_t* b);
 void php_phongo_zval_to_bson_value(zval* data, php_phongo_bson_flags_t flags, bson_value_t* value);
 bool php_phongo_bson_typemap_to_state(zval* typemap, php_phongo_bson_typemap* map);
 void php_phongo_bson_state_ctor(php_phongo_bson_state* state);
 void php_phongo_bson_state_dtor(php_phongo_bson_state* state);
 void php_phongo_bson_state_copy_ctor(php_phongo_bson_state* dst, php_phongo_bson_state* src);
+void php_phongo_bson_typemap_copy(php_phongo_bson_typemap* dst, const php_phongo_bson_typemap* src);
 void php_phongo_bson_typemap_dtor(php_phongo_bson_typemap* map);
 
 void php_phongo_bson_new_timestamp_from_increment_and_timestamp(zval* object, uint32_t increment, uint32_t timestamp);
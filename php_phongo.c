@@ -22,6 +22,8 @@
 #include <php.h>
 #include <php_ini.h>
 #include <ext/standard/info.h>
+#include <ext/standard/md5.h>
+#include <ext/standard/php_string.h>
 #include <ext/standard/file.h>
 #include <Zend/zend_hash.h>
 #include <Zend/zend_interfaces.h>
@@ -67,6 +69,7 @@
 #include "php_phongo.h"
 #include "php_bson.h"
 #include "src/BSON/functions.h"
+#include "src/MongoDB/BulkWrite.h"
 #include "src/MongoDB/Monitoring/functions.h"
 
 #undef MONGOC_LOG_DOMAIN
@@ -74,9 +77,33 @@
 
 #define PHONGO_DEBUG_INI "mongodb.debug"
 #define PHONGO_DEBUG_INI_DEFAULT ""
+#define PHONGO_PRECONNECT_INI "mongodb.preconnect"
+#define PHONGO_PRECONNECT_INI_DEFAULT ""
+#define PHONGO_PRECONNECT_PING_INI "mongodb.preconnect_ping"
+#define PHONGO_PRECONNECT_PING_INI_DEFAULT "0"
+#define PHONGO_CLIENT_POOL_INI "mongodb.client_pool"
+#define PHONGO_CLIENT_POOL_INI_DEFAULT "0"
+#define PHONGO_MAX_PERSISTENT_CLIENTS_INI "mongodb.max_persistent_clients"
+#define PHONGO_MAX_PERSISTENT_CLIENTS_INI_DEFAULT "0"
+#define PHONGO_PERSISTENT_CLIENT_IDLE_TIMEOUT_INI "mongodb.persistent_client_idle_timeout"
+#define PHONGO_PERSISTENT_CLIENT_IDLE_TIMEOUT_INI_DEFAULT "0"
 #define PHONGO_METADATA_SEPARATOR " / "
 #define PHONGO_METADATA_SEPARATOR_LEN (sizeof(PHONGO_METADATA_SEPARATOR) - 1)
 
+/* libmongoc's default heartbeatFrequencyMS for single-threaded clients */
+#define PHONGO_DEFAULT_HEARTBEAT_FREQUENCY_MS 60000
+
+/* The bulkWrite command requires MongoDB 8.0. The default limits are only
+ * used if a server's hello response does not include them. */
+#define PHONGO_CLIENT_BULK_WRITE_MIN_WIRE_VERSION 25
+#define PHONGO_CLIENT_BULK_WRITE_DEFAULT_MAX_BSON_SIZE (16 * 1024 * 1024)
+#define PHONGO_CLIENT_BULK_WRITE_DEFAULT_MAX_WRITE_BATCH_SIZE 100000
+
+/* Limits for the results coalesced by a Manager with the "coalesceReads"
+ * driver option. The oldest results are evicted once either is exceeded. */
+#define PHONGO_READ_CACHE_MAX_ENTRIES 1000
+#define PHONGO_READ_CACHE_MAX_SIZE (16 * 1024 * 1024)
+
 ZEND_DECLARE_MODULE_GLOBALS(mongodb)
 #if defined(ZTS) && defined(COMPILE_DL_MONGODB)
 ZEND_TSRMLS_CACHE_DEFINE();
@@ -89,6 +116,14 @@ ZEND_TSRMLS_CACHE_DEFINE();
  * destroyed. */
 static int32_t phongo_num_threads = 0;
 
+#ifdef ZTS
+/* Process-wide registry of client pools, which are shared by all threads if
+ * the "mongodb.client_pool" INI setting is enabled. Pools are keyed by client
+ * hash and destroyed in MSHUTDOWN. */
+static HashTable phongo_client_pools;
+static MUTEX_T   phongo_client_pools_mutex;
+#endif
+
 /* Declare zend_class_entry dependencies, which are initialized in MINIT */
 zend_class_entry* php_phongo_date_immutable_ce;
 zend_class_entry* php_phongo_json_serializable_ce;
@@ -116,7 +151,9 @@ zend_object_handlers* phongo_get_std_object_handlers(void)
 /* }}} */
 
 /* Forward declarations */
-static bool phongo_split_namespace(const char* namespace, char** dbname, char** cname);
+static php_phongo_pclient_t* php_phongo_find_pclient_for_client(mongoc_client_t* client);
+static void                  php_phongo_pclient_clear_selected_servers(php_phongo_pclient_t* pclient);
+static void                  php_phongo_evict_persistent_clients(void);
 
 /* {{{ Error reporting and logging */
 zend_class_entry* phongo_exception_from_phongo_domain(php_phongo_error_domain_t domain)
@@ -392,6 +429,26 @@ void phongo_session_init(zval* return_value, zval* manager, mongoc_client_sessio
 }
 /* }}} */
 
+/* Initializes a Query with the options of an existing Query but a different
+ * filter. The filter is copied. */
+void phongo_query_init_with_filter(zval* return_value, zval* zquery, const bson_t* filter) /* {{{ */
+{
+	const php_phongo_query_t* query = Z_QUERY_OBJ_P(zquery);
+	php_phongo_query_t*       intern;
+
+	object_init_ex(return_value, php_phongo_query_ce);
+
+	intern                    = Z_QUERY_OBJ_P(return_value);
+	intern->filter            = bson_copy(filter);
+	intern->opts              = bson_copy(query->opts);
+	intern->max_await_time_ms = query->max_await_time_ms;
+
+	if (query->read_concern) {
+		intern->read_concern = mongoc_read_concern_copy(query->read_concern);
+	}
+}
+/* }}} */
+
 void phongo_readconcern_init(zval* return_value, const mongoc_read_concern_t* read_concern) /* {{{ */
 {
 	php_phongo_readconcern_t* intern;
@@ -524,7 +581,7 @@ static php_phongo_writeresult_t* phongo_writeresult_init(zval* return_value, bso
 
 /* {{{ CRUD */
 /* Splits a namespace name into the database and collection names, allocated with estrdup. */
-static bool phongo_split_namespace(const char* namespace, char** dbname, char** cname) /* {{{ */
+bool phongo_split_namespace(const char* namespace, char** dbname, char** cname) /* {{{ */
 {
 	char* dot = strchr(namespace, '.');
 
@@ -707,203 +764,1636 @@ static bool phongo_parse_write_concern(zval* options, bson_t* mongoc_opts, zval*
 	return true;
 }
 
-bool phongo_execute_bulk_write(zval* manager, const char* namespace, php_phongo_bulkwrite_t* bulk_write, zval* options, uint32_t server_id, zval* return_value) /* {{{ */
+/* {{{ Read coalescing */
+/* Returns whether the results of a query may be coalesced. Tailable cursors
+ * and queries using an explicit session (e.g. within a transaction) are always
+ * executed. */
+static bool phongo_read_cache_is_eligible(const php_phongo_query_t* query, const bson_t* opts, zval* zsession) /* {{{ */
 {
-	mongoc_client_t*              client = NULL;
-	bson_error_t                  error  = { 0 };
-	int                           success;
-	bson_t                        reply = BSON_INITIALIZER;
-	mongoc_bulk_operation_t*      bulk  = bulk_write->bulk;
-	php_phongo_writeresult_t*     writeresult;
-	zval*                         zwriteConcern = NULL;
-	zval*                         zsession      = NULL;
-	const mongoc_write_concern_t* write_concern = NULL;
-
-	client = Z_MANAGER_OBJ_P(manager)->client;
+	bson_iter_t iter;
 
-	if (bulk_write->executed) {
-		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "BulkWrite objects may only be executed once and this instance has already been executed");
+	if (zsession || query->max_await_time_ms) {
 		return false;
 	}
 
-	if (!phongo_split_namespace(namespace, &bulk_write->database, &bulk_write->collection)) {
-		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "%s: %s", "Invalid namespace provided", namespace);
+	if (bson_iter_init_find(&iter, opts, "tailable") && bson_iter_as_bool(&iter)) {
 		return false;
 	}
 
-	if (!phongo_parse_session(options, client, NULL, &zsession)) {
-		/* Exception should already have been thrown */
-		return false;
+	return true;
+} /* }}} */
+
+/* Returns the key for a query's results, which is its namespace followed by a
+ * document describing the filter, options, read concern, and read preference.
+ * Since namespaces may not contain null bytes, entries for a namespace can be
+ * identified by their prefix. */
+static zend_string* phongo_read_cache_make_key(const char* namespace, const php_phongo_query_t* query, const bson_t* opts, const mongoc_read_prefs_t* read_prefs) /* {{{ */
+{
+	bson_t       key           = BSON_INITIALIZER;
+	size_t       namespace_len = strlen(namespace);
+	zend_string* str;
+
+	BSON_APPEND_DOCUMENT(&key, "filter", query->filter);
+	BSON_APPEND_DOCUMENT(&key, "opts", opts);
+
+	if (query->read_concern && mongoc_read_concern_get_level(query->read_concern)) {
+		BSON_APPEND_UTF8(&key, "readConcern", mongoc_read_concern_get_level(query->read_concern));
 	}
 
-	if (!phongo_parse_write_concern(options, NULL, &zwriteConcern)) {
-		/* Exception should already have been thrown */
-		return false;
+	if (read_prefs) {
+		BSON_APPEND_INT32(&key, "mode", mongoc_read_prefs_get_mode(read_prefs));
+		BSON_APPEND_ARRAY(&key, "tags", mongoc_read_prefs_get_tags(read_prefs));
+		BSON_APPEND_INT64(&key, "maxStalenessSeconds", mongoc_read_prefs_get_max_staleness_seconds(read_prefs));
+		BSON_APPEND_DOCUMENT(&key, "hedge", mongoc_read_prefs_get_hedge(read_prefs));
 	}
 
-	/* If a write concern was not specified, libmongoc will use the client's
-	 * write concern; however, we should still fetch it for the write result.
-	 * Additionally, we need to check if an unacknowledged write concern would
-	 * conflict with an explicit session. */
-	write_concern = zwriteConcern ? Z_WRITECONCERN_OBJ_P(zwriteConcern)->write_concern : mongoc_client_get_write_concern(client);
+	str = zend_string_alloc(namespace_len + 1 + key.len, 0);
+	memcpy(ZSTR_VAL(str), namespace, namespace_len + 1);
+	memcpy(ZSTR_VAL(str) + namespace_len + 1, bson_get_data(&key), key.len);
+	ZSTR_VAL(str)[ZSTR_LEN(str)] = '\0';
 
-	if (zsession && !mongoc_write_concern_is_acknowledged(write_concern)) {
-		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Cannot combine \"session\" option with an unacknowledged write concern");
+	bson_destroy(&key);
+
+	return str;
+} /* }}} */
+
+/* Copies the remaining results of an exhausted cursor, which has already been
+ * advanced to its first result, into a BSON array. Returns NULL on error. */
+static bson_t* phongo_read_cache_drain(mongoc_cursor_t* cursor) /* {{{ */
+{
+	bson_t*       batch = bson_new();
+	const bson_t* doc   = mongoc_cursor_current(cursor);
+	uint32_t      i     = 0;
+
+	while (doc) {
+		const char* key;
+		char        key_str[16];
+
+		bson_uint32_to_string(i++, &key, key_str, sizeof(key_str));
+		bson_append_document(batch, key, -1, doc);
+
+		if (!mongoc_cursor_next(cursor, &doc)) {
+			doc = NULL;
+		}
+	}
+
+	if (mongoc_cursor_error(cursor, NULL)) {
+		bson_destroy(batch);
+		return NULL;
+	}
+
+	return batch;
+} /* }}} */
+
+/* Creates a cursor replaying the coalesced results of a query, which does not
+ * contact the server since its cursor ID is zero. The cursor is advanced to
+ * its first result. */
+static mongoc_cursor_t* phongo_read_cache_replay(mongoc_client_t* client, const char* namespace, const bson_t* batch, uint32_t server_id) /* {{{ */
+{
+	bson_t           reply       = BSON_INITIALIZER;
+	bson_t           cursor_opts = BSON_INITIALIZER;
+	bson_t           cursor_doc;
+	mongoc_cursor_t* cursor;
+	const bson_t*    doc;
+
+	BSON_APPEND_DOCUMENT_BEGIN(&reply, "cursor", &cursor_doc);
+	BSON_APPEND_INT64(&cursor_doc, "id", 0);
+	BSON_APPEND_UTF8(&cursor_doc, "ns", namespace);
+	BSON_APPEND_ARRAY(&cursor_doc, "firstBatch", batch);
+	bson_append_document_end(&reply, &cursor_doc);
+	BSON_APPEND_DOUBLE(&reply, "ok", 1);
+
+	BSON_APPEND_INT32(&cursor_opts, "serverId", server_id);
+
+	/* According to mongoc_cursor_new_from_command_reply_with_opts(), the reply
+	 * bson_t is ultimately destroyed on both success and failure. */
+	cursor = mongoc_cursor_new_from_command_reply_with_opts(client, &reply, &cursor_opts);
+	bson_destroy(&cursor_opts);
+
+	(void) mongoc_cursor_next(cursor, &doc);
+
+	return cursor;
+} /* }}} */
+
+static void phongo_read_cache_dtor(zval* ptr) /* {{{ */
+{
+	bson_destroy(Z_PTR_P(ptr));
+} /* }}} */
+
+/* Initializes the read cache for a Manager with the "coalesceReads" driver
+ * option. Results are held until they are invalidated or evicted, or the
+ * request ends (see: phongo_read_cache_clear_all). */
+static void phongo_read_cache_init(php_phongo_manager_t* manager) /* {{{ */
+{
+	ALLOC_HASHTABLE(manager->read_cache);
+	zend_hash_init(manager->read_cache, 0, NULL, phongo_read_cache_dtor, 0);
+	manager->read_cache_size = 0;
+} /* }}} */
+
+static void phongo_read_cache_del(php_phongo_manager_t* manager, zend_string* key) /* {{{ */
+{
+	const bson_t* batch = zend_hash_find_ptr(manager->read_cache, key);
+
+	if (batch) {
+		manager->read_cache_size -= batch->len;
+		zend_hash_del(manager->read_cache, key);
+	}
+} /* }}} */
+
+/* Adds the results of a query to the read cache, first evicting the oldest
+ * results if the cache would exceed its limits. Returns false if the results
+ * were not cached because they alone exceed the size limit, in which case the
+ * caller retains ownership of batch. */
+static bool phongo_read_cache_add(php_phongo_manager_t* manager, zend_string* key, bson_t* batch) /* {{{ */
+{
+	if (batch->len > PHONGO_READ_CACHE_MAX_SIZE) {
 		return false;
 	}
 
-	mongoc_bulk_operation_set_database(bulk, bulk_write->database);
-	mongoc_bulk_operation_set_collection(bulk, bulk_write->collection);
-	mongoc_bulk_operation_set_client(bulk, client);
-	mongoc_bulk_operation_set_hint(bulk, server_id);
+	while (zend_hash_num_elements(manager->read_cache) >= PHONGO_READ_CACHE_MAX_ENTRIES || manager->read_cache_size + batch->len > PHONGO_READ_CACHE_MAX_SIZE) {
+		HashPosition pos;
+		zend_string* oldest;
+		zend_ulong   index;
 
-	if (zsession) {
-		ZVAL_ZVAL(&bulk_write->session, zsession, 1, 0);
-		mongoc_bulk_operation_set_client_session(bulk, Z_SESSION_OBJ_P(zsession)->client_session);
+		zend_hash_internal_pointer_reset_ex(manager->read_cache, &pos);
+
+		if (zend_hash_get_current_key_ex(manager->read_cache, &oldest, &index, &pos) != HASH_KEY_IS_STRING) {
+			break;
+		}
+
+		phongo_read_cache_del(manager, oldest);
 	}
 
-	if (zwriteConcern) {
-		mongoc_bulk_operation_set_write_concern(bulk, Z_WRITECONCERN_OBJ_P(zwriteConcern)->write_concern);
+	zend_hash_update_ptr(manager->read_cache, key, batch);
+	manager->read_cache_size += batch->len;
+
+	return true;
+} /* }}} */
+
+/* Drops all coalesced results for a Manager */
+static void phongo_read_cache_clear(php_phongo_manager_t* manager) /* {{{ */
+{
+	if (!manager->read_cache) {
+		return;
 	}
 
-	success              = mongoc_bulk_operation_execute(bulk, &reply, &error);
-	bulk_write->executed = true;
+	zend_hash_clean(manager->read_cache);
+	manager->read_cache_size = 0;
+} /* }}} */
 
-	writeresult                = phongo_writeresult_init(return_value, &reply, manager, mongoc_bulk_operation_get_hint(bulk));
-	writeresult->write_concern = mongoc_write_concern_copy(write_concern);
+/* Drops the coalesced results of all Managers at the end of a request. Managers
+ * still referenced at this point are only freed after RSHUTDOWN, when the
+ * registry used to find them no longer exists. */
+static void phongo_read_cache_clear_all(void) /* {{{ */
+{
+	php_phongo_manager_t* manager;
 
-	/* A BulkWriteException is always thrown if mongoc_bulk_operation_execute()
-	 * fails to ensure that the write result is accessible. If the error does
-	 * not originate from the server (e.g. socket error), throw the appropriate
-	 * exception first. It will be included in BulkWriteException's message and
-	 * will also be accessible via Exception::getPrevious(). */
-	if (!success) {
-		if (error.domain != MONGOC_ERROR_SERVER && error.domain != MONGOC_ERROR_WRITE_CONCERN) {
-			phongo_throw_exception_from_bson_error_t_and_reply(&error, &reply);
+	if (!MONGODB_G(managers)) {
+		return;
+	}
+
+	ZEND_HASH_FOREACH_PTR(MONGODB_G(managers), manager)
+	{
+		phongo_read_cache_clear(manager);
+	}
+	ZEND_HASH_FOREACH_END();
+} /* }}} */
+
+/* Drops coalesced results for a namespace, or all results if namespace is
+ * NULL. This is called for any write executed through the Manager. */
+static void phongo_read_cache_invalidate(php_phongo_manager_t* manager, const char* namespace) /* {{{ */
+{
+	zend_string* key;
+	size_t       namespace_len;
+
+	if (!manager->read_cache || zend_hash_num_elements(manager->read_cache) == 0) {
+		return;
+	}
+
+	if (!namespace) {
+		phongo_read_cache_clear(manager);
+		return;
+	}
+
+	namespace_len = strlen(namespace);
+
+	ZEND_HASH_FOREACH_STR_KEY(manager->read_cache, key)
+	{
+		if (ZSTR_LEN(key) > namespace_len && ZSTR_VAL(key)[namespace_len] == '\0' && memcmp(ZSTR_VAL(key), namespace, namespace_len) == 0) {
+			phongo_read_cache_del(manager, key);
 		}
+	}
+	ZEND_HASH_FOREACH_END();
+} /* }}} */
 
-		/* Argument errors occur before command execution, so there is no need
-		 * to layer this InvalidArgumentException behind a BulkWriteException.
-		 * In practice, this will be a "Cannot do an empty bulk write" error. */
-		if (error.domain == MONGOC_ERROR_COMMAND && error.code == MONGOC_ERROR_COMMAND_INVALID_ARG) {
-			goto cleanup;
+static void phongo_read_cache_invalidate_collection(php_phongo_manager_t* manager, const char* db, const char* collection) /* {{{ */
+{
+	char* namespace;
+
+	if (!manager->read_cache) {
+		return;
+	}
+
+	(void) spprintf(&namespace, 0, "%s.%s", db, collection);
+	phongo_read_cache_invalidate(manager, namespace);
+	efree(namespace);
+} /* }}} */
+/* }}} */
+
+static int32_t phongo_bulk_write_reply_int32(const bson_t* reply, const char* key) /* {{{ */
+{
+	bson_iter_t iter;
+
+	if (bson_iter_init_find(&iter, reply, key) && (BSON_ITER_HOLDS_INT32(&iter) || BSON_ITER_HOLDS_INT64(&iter) || BSON_ITER_HOLDS_DOUBLE(&iter))) {
+		return (int32_t) bson_iter_as_int64(&iter);
+	}
+
+	return 0;
+} /* }}} */
+
+/* Appends a document to one of the result arrays, consisting of the given
+ * index (unless it is negative) and the named fields copied from doc. */
+static void phongo_bulk_write_result_append(bson_t* array, uint32_t* array_len, int32_t index, const bson_t* doc, const char* const* fields) /* {{{ */
+{
+	const char* key;
+	char        key_str[16];
+	bson_t      child;
+	bson_iter_t iter;
+
+	bson_uint32_to_string((*array_len)++, &key, key_str, sizeof(key_str));
+	bson_append_document_begin(array, key, -1, &child);
+
+	if (index >= 0) {
+		BSON_APPEND_INT32(&child, "index", index);
+	}
+
+	for (; *fields; fields++) {
+		if (bson_iter_init_find(&iter, doc, *fields)) {
+			bson_append_iter(&child, *fields, -1, &iter);
 		}
+	}
 
-		if (EG(exception)) {
-			char* message;
+	bson_append_document_end(array, &child);
+} /* }}} */
+
+static const char* const phongo_bulk_write_error_fields[]         = { "code", "errmsg", "errInfo", NULL };
+static const char* const phongo_bulk_write_upserted_fields[]      = { "_id", NULL };
+static const char* const phongo_bulk_write_concern_error_fields[] = { "code", "codeName", "errmsg", "errInfo", NULL };
 
-			(void) spprintf(&message, 0, "Bulk write failed due to previous %s: %s", PHONGO_ZVAL_EXCEPTION_NAME(EG(exception)), error.message);
-			zend_throw_exception(php_phongo_bulkwriteexception_ce, message, 0);
-			efree(message);
+/* Appends each document in the array field of a reply to one of the result
+ * arrays. If indexes is not NULL, it is used to map each document's "index"
+ * field to the index of the ClientBulkWrite operation; otherwise, a
+ * non-negative index_offset is added to the "index" field. If neither is
+ * given, the index is omitted. */
+static void phongo_bulk_write_result_append_all(bson_t* array, uint32_t* array_len, const bson_t* reply, const char* field, const char* const* fields, const uint32_t* indexes, int32_t index_offset) /* {{{ */
+{
+	bson_iter_t iter, child;
+
+	if (!bson_iter_init_find(&iter, reply, field) || !BSON_ITER_HOLDS_ARRAY(&iter) || !bson_iter_recurse(&iter, &child)) {
+		return;
+	}
+
+	while (bson_iter_next(&child)) {
+		uint32_t       len;
+		const uint8_t* data;
+		bson_t         doc;
+		int32_t        index;
+
+		if (!BSON_ITER_HOLDS_DOCUMENT(&child)) {
+			continue;
+		}
+
+		bson_iter_document(&child, &len, &data);
+		bson_init_static(&doc, data, len);
+
+		if (indexes) {
+			index = (int32_t) indexes[phongo_bulk_write_reply_int32(&doc, "index")];
+		} else if (index_offset >= 0) {
+			index = index_offset + phongo_bulk_write_reply_int32(&doc, "index");
 		} else {
-			zend_throw_exception(php_phongo_bulkwriteexception_ce, error.message, error.code);
+			index = -1;
 		}
 
-		/* Ensure error labels are added to the final BulkWriteException. If a
-		 * previous exception was also thrown, error labels will already have
-		 * been added by phongo_throw_exception_from_bson_error_t_and_reply. */
-		phongo_exception_add_error_labels(&reply);
-		phongo_add_exception_prop(ZEND_STRL("writeResult"), return_value);
+		phongo_bulk_write_result_append(array, array_len, index, &doc, fields);
 	}
+} /* }}} */
 
-cleanup:
-	bson_destroy(&reply);
-
-	return success;
+/* Merges a reply from mongoc_bulk_operation_execute() into the result. The
+ * indexes array maps the bulk's operations to those of the ClientBulkWrite. If
+ * it is NULL, index_offset is added to the index of each operation instead. */
+static void phongo_bulk_write_result_merge_bulk_reply(phongo_bulk_write_result_t* result, const bson_t* reply, const uint32_t* indexes, int32_t index_offset) /* {{{ */
+{
+	result->n_inserted += phongo_bulk_write_reply_int32(reply, "nInserted");
+	result->n_matched += phongo_bulk_write_reply_int32(reply, "nMatched");
+	result->n_modified += phongo_bulk_write_reply_int32(reply, "nModified");
+	result->n_removed += phongo_bulk_write_reply_int32(reply, "nRemoved");
+	result->n_upserted += phongo_bulk_write_reply_int32(reply, "nUpserted");
+
+	phongo_bulk_write_result_append_all(&result->upserted, &result->upserted_len, reply, "upserted", phongo_bulk_write_upserted_fields, indexes, index_offset);
+	phongo_bulk_write_result_append_all(&result->write_errors, &result->write_errors_len, reply, "writeErrors", phongo_bulk_write_error_fields, indexes, index_offset);
+	phongo_bulk_write_result_append_all(&result->write_concern_errors, &result->write_concern_errors_len, reply, "writeConcernErrors", phongo_bulk_write_concern_error_fields, NULL, -1);
 } /* }}} */
 
-/* Advance the cursor and return whether there is an error. On error, false is
- * returned and an exception is thrown. */
-bool phongo_cursor_advance_and_check_for_error(mongoc_cursor_t* cursor) /* {{{ */
+/* Appends the accumulated result to reply, which can then be used to
+ * initialize a WriteResult. */
+static void phongo_bulk_write_result_to_reply(phongo_bulk_write_result_t* result, bson_t* reply) /* {{{ */
 {
-	const bson_t* doc = NULL;
+	BSON_APPEND_INT32(reply, "nInserted", result->n_inserted);
+	BSON_APPEND_INT32(reply, "nMatched", result->n_matched);
+	BSON_APPEND_INT32(reply, "nModified", result->n_modified);
+	BSON_APPEND_INT32(reply, "nRemoved", result->n_removed);
+	BSON_APPEND_INT32(reply, "nUpserted", result->n_upserted);
+	BSON_APPEND_ARRAY(reply, "upserted", &result->upserted);
+	BSON_APPEND_ARRAY(reply, "writeErrors", &result->write_errors);
+	BSON_APPEND_ARRAY(reply, "writeConcernErrors", &result->write_concern_errors);
+} /* }}} */
 
-	if (!mongoc_cursor_next(cursor, &doc)) {
-		bson_error_t error = { 0 };
+/* Sets the error from the first document in one of the result's error arrays.
+ * Returns false if the array is empty. */
+static bool phongo_bulk_write_result_first_error(const bson_t* array, uint32_t domain, bson_error_t* error) /* {{{ */
+{
+	bson_iter_t iter, child;
+	int32_t     code   = 0;
+	const char* errmsg = "";
 
-		/* Check for connection related exceptions */
-		if (EG(exception)) {
-			return false;
-		}
+	if (!bson_iter_init(&iter, array) || !bson_iter_next(&iter) || !BSON_ITER_HOLDS_DOCUMENT(&iter) || !bson_iter_recurse(&iter, &child)) {
+		return false;
+	}
 
-		/* Could simply be no docs, which is not an error */
-		if (mongoc_cursor_error_document(cursor, &error, &doc)) {
-			phongo_throw_exception_from_bson_error_t_and_reply(&error, doc);
-			return false;
+	while (bson_iter_next(&child)) {
+		if (!strcmp(bson_iter_key(&child), "code")) {
+			code = (int32_t) bson_iter_as_int64(&child);
+		} else if (!strcmp(bson_iter_key(&child), "errmsg") && BSON_ITER_HOLDS_UTF8(&child)) {
+			errmsg = bson_iter_utf8(&child, NULL);
 		}
 	}
 
+	bson_set_error(error, domain, (uint32_t) code, "%s", errmsg);
+
 	return true;
 } /* }}} */
 
-bool phongo_execute_query(zval* manager, const char* namespace, zval* zquery, zval* options, uint32_t server_id, zval* return_value) /* {{{ */
+void phongo_bulk_write_result_init(phongo_bulk_write_result_t* result) /* {{{ */
 {
-	mongoc_client_t*          client;
-	const php_phongo_query_t* query;
-	bson_t                    opts = BSON_INITIALIZER;
-	mongoc_cursor_t*          cursor;
-	char*                     dbname;
-	char*                     collname;
-	mongoc_collection_t*      collection;
-	zval*                     zreadPreference = NULL;
-	zval*                     zsession        = NULL;
+	memset(result, 0, sizeof(phongo_bulk_write_result_t));
 
-	client = Z_MANAGER_OBJ_P(manager)->client;
+	bson_init(&result->upserted);
+	bson_init(&result->write_errors);
+	bson_init(&result->write_concern_errors);
+} /* }}} */
 
-	if (!phongo_split_namespace(namespace, &dbname, &collname)) {
-		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "%s: %s", "Invalid namespace provided", namespace);
-		return false;
+void phongo_bulk_write_result_destroy(phongo_bulk_write_result_t* result) /* {{{ */
+{
+	bson_destroy(&result->upserted);
+	bson_destroy(&result->write_errors);
+	bson_destroy(&result->write_concern_errors);
+} /* }}} */
+
+/* Throws a BulkWriteException for a failed bulk write, which exposes the write
+ * result. If the error does not originate from the server (e.g. socket error),
+ * the appropriate exception is thrown first. It will be included in the
+ * BulkWriteException's message and will also be accessible via
+ * Exception::getPrevious(). */
+static void phongo_throw_bulk_write_exception(bson_error_t* error, const bson_t* reply, zval* zwriteresult) /* {{{ */
+{
+	if (error->domain != MONGOC_ERROR_SERVER && error->domain != MONGOC_ERROR_WRITE_CONCERN) {
+		phongo_throw_exception_from_bson_error_t_and_reply(error, reply);
 	}
-	collection = mongoc_client_get_collection(client, dbname, collname);
-	efree(dbname);
-	efree(collname);
 
-	query = Z_QUERY_OBJ_P(zquery);
+	/* Argument errors occur before command execution, so there is no need
+	 * to layer this InvalidArgumentException behind a BulkWriteException.
+	 * In practice, this will be a "Cannot do an empty bulk write" error. */
+	if (error->domain == MONGOC_ERROR_COMMAND && error->code == MONGOC_ERROR_COMMAND_INVALID_ARG) {
+		return;
+	}
 
-	bson_copy_to(query->opts, &opts);
+	if (EG(exception)) {
+		char* message;
 
-	if (query->read_concern) {
-		mongoc_collection_set_read_concern(collection, query->read_concern);
+		(void) spprintf(&message, 0, "Bulk write failed due to previous %s: %s", PHONGO_ZVAL_EXCEPTION_NAME(EG(exception)), error->message);
+		zend_throw_exception(php_phongo_bulkwriteexception_ce, message, 0);
+		efree(message);
+	} else {
+		zend_throw_exception(php_phongo_bulkwriteexception_ce, error->message, error->code);
 	}
 
-	if (!phongo_parse_read_preference(options, &zreadPreference)) {
-		/* Exception should already have been thrown */
-		mongoc_collection_destroy(collection);
-		bson_destroy(&opts);
-		return false;
+	/* Ensure error labels are added to the final BulkWriteException. If a
+	 * previous exception was also thrown, error labels will already have
+	 * been added by phongo_throw_exception_from_bson_error_t_and_reply. */
+	phongo_exception_add_error_labels(reply);
+	phongo_add_exception_prop(ZEND_STRL("writeResult"), zwriteresult);
+} /* }}} */
+
+/* Executes the operations buffered by an auto-flushing BulkWrite and merges
+ * the reply into its accumulated result. The raw reply of the most recent
+ * failed flush is retained, since the accumulated result does not include
+ * top-level fields such as error labels. A new libmongoc bulk operation is then
+ * started for any subsequent operations. Returns false and sets the error if no
+ * further operations should be executed, which is the case for any error other
+ * than a write concern error or a write error in an unordered bulk write. */
+static bool phongo_bulk_write_flush_to_server(php_phongo_bulkwrite_t* bulk_write, uint32_t server_id, bson_error_t* error) /* {{{ */
+{
+	mongoc_bulk_operation_t* bulk             = bulk_write->bulk;
+	uint32_t                 write_errors_len = bulk_write->flushed->write_errors_len;
+	bson_t                   reply;
+	bool                     success;
+
+	mongoc_bulk_operation_set_database(bulk, bulk_write->database);
+	mongoc_bulk_operation_set_collection(bulk, bulk_write->collection);
+	mongoc_bulk_operation_set_client(bulk, Z_MANAGER_OBJ_P(&bulk_write->manager)->client);
+	mongoc_bulk_operation_set_hint(bulk, server_id);
+
+	if (!Z_ISUNDEF(bulk_write->write_concern)) {
+		mongoc_bulk_operation_set_write_concern(bulk, Z_WRITECONCERN_OBJ_P(&bulk_write->write_concern)->write_concern);
+	} else if (Z_MANAGER_OBJ_P(&bulk_write->manager)->write_concern) {
+		mongoc_bulk_operation_set_write_concern(bulk, Z_MANAGER_OBJ_P(&bulk_write->manager)->write_concern);
 	}
 
-	if (!phongo_parse_session(options, client, &opts, &zsession)) {
-		/* Exception should already have been thrown */
-		mongoc_collection_destroy(collection);
-		bson_destroy(&opts);
-		return false;
+	phongo_read_cache_invalidate_collection(Z_MANAGER_OBJ_P(&bulk_write->manager), bulk_write->database, bulk_write->collection);
+
+	success = mongoc_bulk_operation_execute(bulk, &reply, error);
+
+	/* Indexes in the reply are relative to the operations in this flush */
+	phongo_bulk_write_result_merge_bulk_reply(bulk_write->flushed, &reply, NULL, (int32_t) (bulk_write->num_ops - bulk_write->buffered_ops));
+
+	if (!success) {
+		if (bulk_write->flush_error_reply) {
+			bson_destroy(bulk_write->flush_error_reply);
+		}
+
+		bulk_write->flush_error_reply = bson_copy(&reply);
+	}
+
+	bson_destroy(&reply);
+
+	mongoc_bulk_operation_destroy(bulk);
+	bulk_write->bulk           = mongoc_bulk_operation_new(bulk_write->ordered);
+	bulk_write->buffered_ops   = 0;
+	bulk_write->buffered_bytes = 0;
+
+	if (bulk_write->bypass != PHONGO_BULKWRITE_BYPASS_UNSET) {
+		mongoc_bulk_operation_set_bypass_document_validation(bulk_write->bulk, bulk_write->bypass);
+	}
+
+	if (success || error->domain == MONGOC_ERROR_WRITE_CONCERN) {
+		return true;
+	}
+
+	/* Write errors are reported through the result, but stop execution of an
+	 * ordered bulk write */
+	if (error->domain == MONGOC_ERROR_SERVER && bulk_write->flushed->write_errors_len > write_errors_len) {
+		return !bulk_write->ordered;
+	}
+
+	return false;
+} /* }}} */
+
+/* Marks an auto-flushing BulkWrite as executed and initializes a WriteResult
+ * from the results of all of its flushes. If execution failed or any errors
+ * were reported, a BulkWriteException is thrown and false is returned. */
+static bool phongo_bulk_write_finish(php_phongo_bulkwrite_t* bulk_write, bool success, bson_error_t* error, uint32_t server_id, zval* return_value) /* {{{ */
+{
+	bson_t                        reply = BSON_INITIALIZER;
+	php_phongo_writeresult_t*     writeresult;
+	const mongoc_write_concern_t* write_concern;
+
+	bulk_write->executed = true;
+
+	if (success && (phongo_bulk_write_result_first_error(&bulk_write->flushed->write_errors, MONGOC_ERROR_SERVER, error) || phongo_bulk_write_result_first_error(&bulk_write->flushed->write_concern_errors, MONGOC_ERROR_WRITE_CONCERN, error))) {
+		success = false;
+	}
+
+	if (!Z_ISUNDEF(bulk_write->write_concern)) {
+		write_concern = Z_WRITECONCERN_OBJ_P(&bulk_write->write_concern)->write_concern;
+	} else {
+		write_concern = phongo_manager_get_write_concern(Z_MANAGER_OBJ_P(&bulk_write->manager));
+	}
+
+	phongo_bulk_write_result_to_reply(bulk_write->flushed, &reply);
+
+	writeresult                = phongo_writeresult_init(return_value, &reply, &bulk_write->manager, server_id);
+	writeresult->write_concern = mongoc_write_concern_copy(write_concern);
+
+	/* The exception's error labels come from the failed flush's reply, while
+	 * its WriteResult reports the results of all flushes */
+	if (!success) {
+		phongo_throw_bulk_write_exception(error, bulk_write->flush_error_reply ? bulk_write->flush_error_reply : &reply, return_value);
+	}
+
+	bson_destroy(&reply);
+
+	return success;
+} /* }}} */
+
+/* Flushes the operations buffered by an auto-flushing BulkWrite after one of
+ * its thresholds has been reached. If no further operations should be
+ * executed, the BulkWrite is considered executed and a BulkWriteException is
+ * thrown with the results of all flushes so far. Returns false on error. */
+bool phongo_bulk_write_flush(php_phongo_bulkwrite_t* bulk_write) /* {{{ */
+{
+	bson_error_t error     = { 0 };
+	uint32_t     server_id = 0;
+	zval         zwriteresult;
+
+	if (!php_phongo_manager_select_server(true, false, NULL, NULL, Z_MANAGER_OBJ_P(&bulk_write->manager), &server_id)) {
+		/* Exception should already have been thrown */
+		return false;
+	}
+
+	if (phongo_bulk_write_flush_to_server(bulk_write, server_id, &error)) {
+		return true;
+	}
+
+	phongo_bulk_write_finish(bulk_write, false, &error, server_id, &zwriteresult);
+	zval_ptr_dtor(&zwriteresult);
+
+	return false;
+} /* }}} */
+
+/* Executes an auto-flushing BulkWrite, which must use the Manager and namespace
+ * it was constructed with. Any buffered operations are flushed and the results
+ * of all flushes are reported through a single WriteResult. */
+static bool phongo_execute_auto_flush_bulk_write(zval* manager, const char* namespace, php_phongo_bulkwrite_t* bulk_write, zval* options, uint32_t server_id, zval* return_value) /* {{{ */
+{
+	bson_error_t error   = { 0 };
+	size_t       db_len  = strlen(bulk_write->database);
+	bool         success = true;
+
+	if (bulk_write->executed) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "BulkWrite objects may only be executed once and this instance has already been executed");
+		return false;
+	}
+
+	if (Z_OBJ_P(manager) != Z_OBJ(bulk_write->manager)) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Auto-flushing BulkWrite objects must be executed by the Manager they were constructed with");
+		return false;
+	}
+
+	if (strncmp(namespace, bulk_write->database, db_len) != 0 || namespace[db_len] != '.' || strcmp(namespace + db_len + 1, bulk_write->collection) != 0) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Auto-flushing BulkWrite objects must be executed on the namespace they were constructed with: %s.%s", bulk_write->database, bulk_write->collection);
+		return false;
+	}
+
+	/* Operations may already have been flushed, so these options can only be
+	 * specified when constructing the BulkWrite */
+	if (options && Z_TYPE_P(options) == IS_ARRAY && (php_array_existsc(options, "session") || php_array_existsc(options, "writeConcern"))) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "The \"session\" and \"writeConcern\" options cannot be specified when executing an auto-flushing BulkWrite");
+		return false;
+	}
+
+	if (bulk_write->num_ops == 0) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Cannot do an empty bulk write");
+		return false;
+	}
+
+	if (bulk_write->buffered_ops > 0) {
+		success = phongo_bulk_write_flush_to_server(bulk_write, server_id, &error);
+	}
+
+	return phongo_bulk_write_finish(bulk_write, success, &error, server_id, return_value);
+} /* }}} */
+
+bool phongo_execute_bulk_write(zval* manager, const char* namespace, php_phongo_bulkwrite_t* bulk_write, zval* options, uint32_t server_id, zval* return_value) /* {{{ */
+{
+	mongoc_client_t*              client = NULL;
+	bson_error_t                  error  = { 0 };
+	int                           success;
+	bson_t                        reply = BSON_INITIALIZER;
+	mongoc_bulk_operation_t*      bulk  = bulk_write->bulk;
+	php_phongo_writeresult_t*     writeresult;
+	zval*                         zwriteConcern = NULL;
+	zval*                         zsession      = NULL;
+	const mongoc_write_concern_t* write_concern = NULL;
+
+	if (!Z_ISUNDEF(bulk_write->manager)) {
+		return phongo_execute_auto_flush_bulk_write(manager, namespace, bulk_write, options, server_id, return_value);
+	}
+
+	client = Z_MANAGER_OBJ_P(manager)->client;
+
+	if (bulk_write->executed) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "BulkWrite objects may only be executed once and this instance has already been executed");
+		return false;
+	}
+
+	if (!phongo_split_namespace(namespace, &bulk_write->database, &bulk_write->collection)) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "%s: %s", "Invalid namespace provided", namespace);
+		return false;
+	}
+
+	if (!phongo_parse_session(options, client, NULL, &zsession)) {
+		/* Exception should already have been thrown */
+		return false;
+	}
+
+	if (!phongo_parse_write_concern(options, NULL, &zwriteConcern)) {
+		/* Exception should already have been thrown */
+		return false;
+	}
+
+	/* If a write concern was not specified, the Manager's write concern is
+	 * used; however, we should still fetch it for the write result.
+	 * Additionally, we need to check if an unacknowledged write concern would
+	 * conflict with an explicit session. */
+	write_concern = zwriteConcern ? Z_WRITECONCERN_OBJ_P(zwriteConcern)->write_concern : phongo_manager_get_write_concern(Z_MANAGER_OBJ_P(manager));
+
+	if (zsession && !mongoc_write_concern_is_acknowledged(write_concern)) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Cannot combine \"session\" option with an unacknowledged write concern");
+		return false;
+	}
+
+	phongo_read_cache_invalidate(Z_MANAGER_OBJ_P(manager), namespace);
+
+	mongoc_bulk_operation_set_database(bulk, bulk_write->database);
+	mongoc_bulk_operation_set_collection(bulk, bulk_write->collection);
+	mongoc_bulk_operation_set_client(bulk, client);
+	mongoc_bulk_operation_set_hint(bulk, server_id);
+
+	if (zsession) {
+		ZVAL_ZVAL(&bulk_write->session, zsession, 1, 0);
+		mongoc_bulk_operation_set_client_session(bulk, Z_SESSION_OBJ_P(zsession)->client_session);
+	}
+
+	/* libmongoc only knows the client's write concern, so a default write
+	 * concern for the Manager must be set explicitly */
+	if (zwriteConcern || Z_MANAGER_OBJ_P(manager)->write_concern) {
+		mongoc_bulk_operation_set_write_concern(bulk, write_concern);
+	}
+
+	success              = mongoc_bulk_operation_execute(bulk, &reply, &error);
+	bulk_write->executed = true;
+
+	writeresult                = phongo_writeresult_init(return_value, &reply, manager, mongoc_bulk_operation_get_hint(bulk));
+	writeresult->write_concern = mongoc_write_concern_copy(write_concern);
+
+	/* A BulkWriteException is always thrown if mongoc_bulk_operation_execute()
+	 * fails to ensure that the write result is accessible. */
+	if (!success) {
+		phongo_throw_bulk_write_exception(&error, &reply, return_value);
+	}
+
+	bson_destroy(&reply);
+
+	return success;
+} /* }}} */
+
+/* A BulkWrite queued by Manager::deferBulkWrite(). The BulkWrite has already
+ * been bound to its namespace and client and uses an unacknowledged write
+ * concern. */
+typedef struct {
+	zval manager;
+	zval bulk;
+} php_phongo_deferred_write_t;
+
+static void php_phongo_deferred_write_destroy_ptr(zval* ptr) /* {{{ */
+{
+	php_phongo_deferred_write_t* deferred = Z_PTR_P(ptr);
+
+	zval_ptr_dtor(&deferred->bulk);
+	zval_ptr_dtor(&deferred->manager);
+	efree(deferred);
+} /* }}} */
+
+/* Queues a BulkWrite to be executed with an unacknowledged write concern when
+ * deferred writes are flushed, which happens in RSHUTDOWN unless the
+ * application flushes them earlier (e.g. after fastcgi_finish_request()). The
+ * BulkWrite is considered executed once it has been queued. Returns false and
+ * throws an exception if the BulkWrite cannot be deferred. */
+bool phongo_defer_bulk_write(zval* manager, const char* namespace, zval* zbulk) /* {{{ */
+{
+	php_phongo_bulkwrite_t*      bulk_write = Z_BULKWRITE_OBJ_P(zbulk);
+	php_phongo_deferred_write_t* deferred;
+	mongoc_write_concern_t*      write_concern;
+
+	if (bulk_write->executed) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "BulkWrite objects may only be executed once and this instance has already been executed");
+		return false;
+	}
+
+	if (!Z_ISUNDEF(bulk_write->manager)) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Auto-flushing BulkWrite objects cannot be deferred");
+		return false;
+	}
+
+	if (bulk_write->num_ops == 0) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Cannot do an empty bulk write");
+		return false;
+	}
+
+	if (!phongo_split_namespace(namespace, &bulk_write->database, &bulk_write->collection)) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "%s: %s", "Invalid namespace provided", namespace);
+		return false;
+	}
+
+	/* Nothing can observe the outcome of a deferred write */
+	write_concern = mongoc_write_concern_new();
+	mongoc_write_concern_set_w(write_concern, MONGOC_WRITE_CONCERN_W_UNACKNOWLEDGED);
+
+	mongoc_bulk_operation_set_database(bulk_write->bulk, bulk_write->database);
+	mongoc_bulk_operation_set_collection(bulk_write->bulk, bulk_write->collection);
+	mongoc_bulk_operation_set_client(bulk_write->bulk, Z_MANAGER_OBJ_P(manager)->client);
+	mongoc_bulk_operation_set_write_concern(bulk_write->bulk, write_concern);
+
+	mongoc_write_concern_destroy(write_concern);
+
+	bulk_write->executed = true;
+
+	deferred = emalloc(sizeof(php_phongo_deferred_write_t));
+	ZVAL_COPY(&deferred->manager, manager);
+	ZVAL_COPY(&deferred->bulk, zbulk);
+
+	zend_hash_next_index_insert_ptr(MONGODB_G(deferred_writes), deferred);
+
+	return true;
+} /* }}} */
+
+/* Executes a deferred BulkWrite. Errors cannot be reported to the application
+ * at this point, so they are only logged. */
+static void php_phongo_execute_deferred_write(php_phongo_deferred_write_t* deferred) /* {{{ */
+{
+	php_phongo_bulkwrite_t* bulk_write = Z_BULKWRITE_OBJ_P(&deferred->bulk);
+	bson_error_t            error      = { 0 };
+	uint32_t                server_id  = 0;
+
+	if (!php_phongo_manager_select_server(true, false, NULL, NULL, Z_MANAGER_OBJ_P(&deferred->manager), &server_id)) {
+		MONGOC_WARNING("Could not select a server for deferred bulk write on %s.%s", bulk_write->database, bulk_write->collection);
+		zend_clear_exception();
+		return;
+	}
+
+	mongoc_bulk_operation_set_hint(bulk_write->bulk, server_id);
+
+	phongo_read_cache_invalidate_collection(Z_MANAGER_OBJ_P(&deferred->manager), bulk_write->database, bulk_write->collection);
+
+	if (!mongoc_bulk_operation_execute(bulk_write->bulk, NULL, &error)) {
+		MONGOC_WARNING("Deferred bulk write on %s.%s failed: %s", bulk_write->database, bulk_write->collection, error.message);
+	}
+} /* }}} */
+
+/* Executes and dequeues deferred writes in the order they were queued. If
+ * manager is not NULL, only writes deferred by that Manager are executed. */
+void phongo_flush_deferred_writes(zval* manager) /* {{{ */
+{
+	HashTable*                   pending;
+	php_phongo_deferred_write_t* deferred;
+
+	if (!MONGODB_G(deferred_writes) || zend_hash_num_elements(MONGODB_G(deferred_writes)) == 0) {
+		return;
+	}
+
+	/* Detach the queue before executing any writes, since APM subscribers may
+	 * defer additional writes while it is being iterated. Those writes remain
+	 * queued for the next flush. */
+	pending = MONGODB_G(deferred_writes);
+	ALLOC_HASHTABLE(MONGODB_G(deferred_writes));
+	zend_hash_init(MONGODB_G(deferred_writes), 0, NULL, php_phongo_deferred_write_destroy_ptr, 0);
+
+	/* Writes deferred by other Managers are requeued in their original order */
+	ZEND_HASH_FOREACH_PTR(pending, deferred)
+	{
+		php_phongo_deferred_write_t* requeued;
+
+		if (!manager || Z_OBJ_P(manager) == Z_OBJ(deferred->manager)) {
+			continue;
+		}
+
+		requeued = emalloc(sizeof(php_phongo_deferred_write_t));
+		ZVAL_COPY(&requeued->manager, &deferred->manager);
+		ZVAL_COPY(&requeued->bulk, &deferred->bulk);
+
+		zend_hash_next_index_insert_ptr(MONGODB_G(deferred_writes), requeued);
+	}
+	ZEND_HASH_FOREACH_END();
+
+	ZEND_HASH_FOREACH_PTR(pending, deferred)
+	{
+		if (manager && Z_OBJ_P(manager) != Z_OBJ(deferred->manager)) {
+			continue;
+		}
+
+		php_phongo_execute_deferred_write(deferred);
+	}
+	ZEND_HASH_FOREACH_END();
+
+	zend_hash_destroy(pending);
+	FREE_HASHTABLE(pending);
+} /* }}} */
+
+/* Adds a ClientBulkWrite operation to a libmongoc bulk operation. On error,
+ * false is returned and the error is set. */
+static bool phongo_client_bulk_write_add_to_bulk(mongoc_bulk_operation_t* bulk, php_phongo_clientbulkwrite_op_t* op, bson_error_t* error) /* {{{ */
+{
+	switch (op->type) {
+		case PHONGO_CLIENTBULKWRITE_INSERT:
+			return mongoc_bulk_operation_insert_with_opts(bulk, op->document, op->opts, error);
+		case PHONGO_CLIENTBULKWRITE_UPDATE_ONE:
+			return mongoc_bulk_operation_update_one_with_opts(bulk, op->document, op->update, op->opts, error);
+		case PHONGO_CLIENTBULKWRITE_UPDATE_MANY:
+			return mongoc_bulk_operation_update_many_with_opts(bulk, op->document, op->update, op->opts, error);
+		case PHONGO_CLIENTBULKWRITE_REPLACE_ONE:
+			return mongoc_bulk_operation_replace_one_with_opts(bulk, op->document, op->update, op->opts, error);
+		case PHONGO_CLIENTBULKWRITE_DELETE_ONE:
+			return mongoc_bulk_operation_remove_one_with_opts(bulk, op->document, op->opts, error);
+		case PHONGO_CLIENTBULKWRITE_DELETE_MANY:
+			return mongoc_bulk_operation_remove_many_with_opts(bulk, op->document, op->opts, error);
+	}
+
+	return false;
+} /* }}} */
+
+/* Executes the operations with the given indexes, which must all use the same
+ * namespace, using a single libmongoc bulk operation. Write errors and write
+ * concern errors are added to the result. Returns false and sets the error if
+ * any other error prevented execution. The reply will be initialized. */
+static bool phongo_client_bulk_write_execute_bulk(mongoc_client_t* client, php_phongo_clientbulkwrite_t* bulk_write, const uint32_t* indexes, uint32_t indexes_len, const mongoc_write_concern_t* write_concern, zval* zsession, uint32_t server_id, phongo_bulk_write_result_t* result, bson_t* reply, bson_error_t* error) /* {{{ */
+{
+	mongoc_bulk_operation_t* bulk;
+	char*                    dbname;
+	char*                    collname;
+	uint32_t                 write_errors_len = result->write_errors_len;
+	uint32_t                 i;
+	bool                     success = false;
+
+	/* Namespaces were validated when the operations were added */
+	phongo_split_namespace(bulk_write->ops[indexes[0]].namespace, &dbname, &collname);
+
+	bulk = mongoc_bulk_operation_new(bulk_write->ordered);
+	mongoc_bulk_operation_set_database(bulk, dbname);
+	mongoc_bulk_operation_set_collection(bulk, collname);
+	mongoc_bulk_operation_set_client(bulk, client);
+	mongoc_bulk_operation_set_hint(bulk, server_id);
+
+	if (bulk_write->bypass != -1) {
+		mongoc_bulk_operation_set_bypass_document_validation(bulk, bulk_write->bypass);
+	}
+
+	if (zsession) {
+		mongoc_bulk_operation_set_client_session(bulk, Z_SESSION_OBJ_P(zsession)->client_session);
+	}
+
+	if (write_concern) {
+		mongoc_bulk_operation_set_write_concern(bulk, write_concern);
+	}
+
+	for (i = 0; i < indexes_len; i++) {
+		if (!phongo_client_bulk_write_add_to_bulk(bulk, &bulk_write->ops[indexes[i]], error)) {
+			goto cleanup;
+		}
+	}
+
+	bson_destroy(reply);
+
+	success = mongoc_bulk_operation_execute(bulk, reply, error);
+
+	phongo_bulk_write_result_merge_bulk_reply(result, reply, indexes, 0);
+
+	/* Write errors and write concern errors are reported through the result */
+	if (!success && (error->domain == MONGOC_ERROR_WRITE_CONCERN || (error->domain == MONGOC_ERROR_SERVER && result->write_errors_len > write_errors_len))) {
+		success = true;
+	}
+
+cleanup:
+	mongoc_bulk_operation_destroy(bulk);
+	efree(dbname);
+	efree(collname);
+
+	return success;
+} /* }}} */
+
+/* Executes the operations with one libmongoc bulk operation per namespace. For
+ * ordered writes, each run of consecutive operations on the same namespace is
+ * executed in turn and execution stops after the first write error; otherwise,
+ * all operations for a namespace are executed together. */
+static bool phongo_client_bulk_write_execute_bulks(mongoc_client_t* client, php_phongo_clientbulkwrite_t* bulk_write, const mongoc_write_concern_t* write_concern, zval* zsession, uint32_t server_id, phongo_bulk_write_result_t* result, bson_t* reply, bson_error_t* error) /* {{{ */
+{
+	bool*     executed = ecalloc(bulk_write->num_ops, sizeof(bool));
+	uint32_t* indexes  = emalloc(bulk_write->num_ops * sizeof(uint32_t));
+	uint32_t  i, j, indexes_len;
+	bool      success = true;
+
+	for (i = 0; i < bulk_write->num_ops; i++) {
+		if (executed[i]) {
+			continue;
+		}
+
+		indexes_len = 0;
+
+		for (j = i; j < bulk_write->num_ops; j++) {
+			if (executed[j]) {
+				continue;
+			}
+
+			if (strcmp(bulk_write->ops[i].namespace, bulk_write->ops[j].namespace) != 0) {
+				if (bulk_write->ordered) {
+					break;
+				}
+
+				continue;
+			}
+
+			indexes[indexes_len++] = j;
+			executed[j]            = true;
+		}
+
+		if (!phongo_client_bulk_write_execute_bulk(client, bulk_write, indexes, indexes_len, write_concern, zsession, server_id, result, reply, error)) {
+			success = false;
+			break;
+		}
+
+		if (bulk_write->ordered && result->write_errors_len > 0) {
+			break;
+		}
+	}
+
+	efree(executed);
+	efree(indexes);
+
+	return success;
+} /* }}} */
+
+/* Returns whether the server supports the bulkWrite command and, if so, sets
+ * the limits used to split operations into batches. */
+static bool phongo_client_bulk_write_command_supported(mongoc_client_t* client, uint32_t server_id, int32_t* max_bson_size, int32_t* max_write_batch_size) /* {{{ */
+{
+	mongoc_server_description_t* sd;
+	const bson_t*                hello;
+	bool                         supported;
+
+	if (!(sd = mongoc_client_get_server_description(client, server_id))) {
+		return false;
+	}
+
+	hello     = mongoc_server_description_ismaster(sd);
+	supported = phongo_bulk_write_reply_int32(hello, "maxWireVersion") >= PHONGO_CLIENT_BULK_WRITE_MIN_WIRE_VERSION;
+
+	*max_bson_size        = phongo_bulk_write_reply_int32(hello, "maxBsonObjectSize");
+	*max_write_batch_size = phongo_bulk_write_reply_int32(hello, "maxWriteBatchSize");
+
+	if (*max_bson_size <= 0) {
+		*max_bson_size = PHONGO_CLIENT_BULK_WRITE_DEFAULT_MAX_BSON_SIZE;
+	}
+
+	if (*max_write_batch_size <= 0) {
+		*max_write_batch_size = PHONGO_CLIENT_BULK_WRITE_DEFAULT_MAX_WRITE_BATCH_SIZE;
+	}
+
+	mongoc_server_description_destroy(sd);
+
+	return supported;
+} /* }}} */
+
+/* Appends an operation in the format of the bulkWrite command's "ops" array. */
+static void phongo_client_bulk_write_append_op(bson_t* doc, php_phongo_clientbulkwrite_op_t* op, int32_t ns_index) /* {{{ */
+{
+	bson_iter_t iter;
+
+	switch (op->type) {
+		case PHONGO_CLIENTBULKWRITE_INSERT:
+			BSON_APPEND_INT32(doc, "insert", ns_index);
+			BSON_APPEND_DOCUMENT(doc, "document", op->document);
+			return;
+
+		case PHONGO_CLIENTBULKWRITE_UPDATE_ONE:
+		case PHONGO_CLIENTBULKWRITE_UPDATE_MANY:
+		case PHONGO_CLIENTBULKWRITE_REPLACE_ONE:
+			BSON_APPEND_INT32(doc, "update", ns_index);
+			BSON_APPEND_DOCUMENT(doc, "filter", op->document);
+
+			if (php_phongo_bulkwrite_update_is_pipeline(op->update)) {
+				BSON_APPEND_ARRAY(doc, "updateMods", op->update);
+			} else {
+				BSON_APPEND_DOCUMENT(doc, "updateMods", op->update);
+			}
+			break;
+
+		case PHONGO_CLIENTBULKWRITE_DELETE_ONE:
+		case PHONGO_CLIENTBULKWRITE_DELETE_MANY:
+			BSON_APPEND_INT32(doc, "delete", ns_index);
+			BSON_APPEND_DOCUMENT(doc, "filter", op->document);
+			BSON_APPEND_BOOL(doc, "multi", op->type == PHONGO_CLIENTBULKWRITE_DELETE_MANY);
+			break;
+	}
+
+	/* The remaining options (i.e. multi, upsert, arrayFilters, collation, and
+	 * hint) use the same names in the bulkWrite command. The "limit" option for
+	 * deletes has already been converted to "multi". */
+	if (bson_iter_init(&iter, op->opts)) {
+		while (bson_iter_next(&iter)) {
+			if (strcmp(bson_iter_key(&iter), "limit") != 0) {
+				bson_append_iter(doc, NULL, 0, &iter);
+			}
+		}
+	}
+} /* }}} */
+
+/* Initializes a bulkWrite command with as many operations, starting at offset,
+ * as the server's limits allow and returns the number of operations. At least
+ * one operation is always included. The server accepts command documents up
+ * to 16KiB larger than maxBsonObjectSize, which leaves room for the fields
+ * appended by libmongoc. */
+static uint32_t phongo_client_bulk_write_build_command(php_phongo_clientbulkwrite_t* bulk_write, uint32_t offset, int32_t max_bson_size, int32_t max_write_batch_size, bool errors_only, bson_t* command) /* {{{ */
+{
+	HashTable ns_indexes;
+	bson_t    ops     = BSON_INITIALIZER;
+	bson_t    ns_info = BSON_INITIALIZER;
+	uint32_t  ops_len = 0;
+	uint32_t  i;
+
+	zend_hash_init(&ns_indexes, 0, NULL, NULL, 0);
+
+	for (i = offset; i < bulk_write->num_ops && ops_len < (uint32_t) max_write_batch_size; i++) {
+		php_phongo_clientbulkwrite_op_t* op        = &bulk_write->ops[i];
+		zval*                            zns_index = zend_hash_str_find(&ns_indexes, op->namespace, strlen(op->namespace));
+		int32_t                          ns_index  = zns_index ? (int32_t) Z_LVAL_P(zns_index) : (int32_t) zend_hash_num_elements(&ns_indexes);
+		bson_t                           op_doc    = BSON_INITIALIZER;
+		bson_t                           ns_doc    = BSON_INITIALIZER;
+		const char*                      key;
+		char                             key_str[16];
+
+		phongo_client_bulk_write_append_op(&op_doc, op, ns_index);
+
+		if (!zns_index) {
+			BSON_APPEND_UTF8(&ns_doc, "ns", op->namespace);
+		}
+
+		/* Allow for the type and key of each array element */
+		if (ops_len > 0 && ops.len + ns_info.len + op_doc.len + ns_doc.len + 2 * sizeof(key_str) > (uint32_t) max_bson_size) {
+			bson_destroy(&op_doc);
+			bson_destroy(&ns_doc);
+			break;
+		}
+
+		if (!zns_index) {
+			zval zindex;
+
+			ZVAL_LONG(&zindex, ns_index);
+			zend_hash_str_add(&ns_indexes, op->namespace, strlen(op->namespace), &zindex);
+
+			bson_uint32_to_string((uint32_t) ns_index, &key, key_str, sizeof(key_str));
+			bson_append_document(&ns_info, key, -1, &ns_doc);
+		}
+
+		bson_uint32_to_string(ops_len++, &key, key_str, sizeof(key_str));
+		bson_append_document(&ops, key, -1, &op_doc);
+
+		bson_destroy(&op_doc);
+		bson_destroy(&ns_doc);
+	}
+
+	BSON_APPEND_INT32(command, "bulkWrite", 1);
+	BSON_APPEND_BOOL(command, "errorsOnly", errors_only);
+	BSON_APPEND_BOOL(command, "ordered", bulk_write->ordered);
+
+	if (bulk_write->bypass != -1) {
+		BSON_APPEND_BOOL(command, "bypassDocumentValidation", bulk_write->bypass);
+	}
+
+	BSON_APPEND_ARRAY(command, "ops", &ops);
+	BSON_APPEND_ARRAY(command, "nsInfo", &ns_info);
+
+	zend_hash_destroy(&ns_indexes);
+	bson_destroy(&ops);
+	bson_destroy(&ns_info);
+
+	return ops_len;
+} /* }}} */
+
+/* Executes a bulkWrite command whose first operation is at offset within the
+ * ClientBulkWrite and adds its results, including any per-operation results
+ * returned through its cursor, to the result. Write errors and write concern
+ * errors are added to the result. Returns false and sets the error if any other
+ * error prevented execution. The reply will be initialized. */
+static bool phongo_client_bulk_write_execute_command(mongoc_client_t* client, const bson_t* command, uint32_t offset, const mongoc_write_concern_t* write_concern, mongoc_client_session_t* client_session, uint32_t server_id, phongo_bulk_write_result_t* result, bson_t* reply, bson_error_t* error) /* {{{ */
+{
+	bson_t           opts        = BSON_INITIALIZER;
+	bson_t           cursor_opts = BSON_INITIALIZER;
+	bson_t           initial_reply;
+	bson_iter_t      iter;
+	mongoc_cursor_t* cursor;
+	const bson_t*    doc;
+	bool             success;
+
+	BSON_APPEND_INT32(&opts, "serverId", server_id);
+	BSON_APPEND_INT32(&cursor_opts, "serverId", server_id);
+
+	if (write_concern) {
+		mongoc_write_concern_append((mongoc_write_concern_t*) write_concern, &opts);
+	}
+
+	/* The cursor must use the same session as the command */
+	if (client_session) {
+		mongoc_client_session_append(client_session, &opts, NULL);
+		mongoc_client_session_append(client_session, &cursor_opts, NULL);
+	}
+
+	bson_destroy(reply);
+
+	/* A write concern error does not prevent the results from being reported */
+	success = mongoc_client_write_command_with_opts(client, "admin", command, &opts, reply, error) || error->domain == MONGOC_ERROR_WRITE_CONCERN;
+
+	if (!success) {
+		goto cleanup;
+	}
+
+	result->n_inserted += phongo_bulk_write_reply_int32(reply, "nInserted");
+	result->n_matched += phongo_bulk_write_reply_int32(reply, "nMatched");
+	result->n_modified += phongo_bulk_write_reply_int32(reply, "nModified");
+	result->n_removed += phongo_bulk_write_reply_int32(reply, "nDeleted");
+	result->n_upserted += phongo_bulk_write_reply_int32(reply, "nUpserted");
+
+	if (bson_iter_init_find(&iter, reply, "writeConcernError") && BSON_ITER_HOLDS_DOCUMENT(&iter)) {
+		uint32_t       len;
+		const uint8_t* data;
+		bson_t         wce;
+
+		bson_iter_document(&iter, &len, &data);
+		bson_init_static(&wce, data, len);
+		phongo_bulk_write_result_append(&result->write_concern_errors, &result->write_concern_errors_len, -1, &wce, phongo_bulk_write_concern_error_fields);
+	}
+
+	if (!bson_iter_init_find(&iter, reply, "cursor") || !BSON_ITER_HOLDS_DOCUMENT(&iter)) {
+		goto cleanup;
+	}
+
+	/* According to mongoc_cursor_new_from_command_reply_with_opts(), the reply
+	 * bson_t is ultimately destroyed on both success and failure. */
+	bson_copy_to(reply, &initial_reply);
+	cursor = mongoc_cursor_new_from_command_reply_with_opts(client, &initial_reply, &cursor_opts);
+
+	while (mongoc_cursor_next(cursor, &doc)) {
+		int32_t index = (int32_t) offset + phongo_bulk_write_reply_int32(doc, "idx");
+
+		if (!bson_iter_init_find(&iter, doc, "ok") || !bson_iter_as_bool(&iter)) {
+			phongo_bulk_write_result_append(&result->write_errors, &result->write_errors_len, index, doc, phongo_bulk_write_error_fields);
+		} else if (bson_iter_init_find(&iter, doc, "upserted") && BSON_ITER_HOLDS_DOCUMENT(&iter)) {
+			uint32_t       len;
+			const uint8_t* data;
+			bson_t         upserted;
+
+			bson_iter_document(&iter, &len, &data);
+			bson_init_static(&upserted, data, len);
+			phongo_bulk_write_result_append(&result->upserted, &result->upserted_len, index, &upserted, phongo_bulk_write_upserted_fields);
+		}
+	}
+
+	if (mongoc_cursor_error(cursor, error)) {
+		success = false;
+	}
+
+	mongoc_cursor_destroy(cursor);
+
+cleanup:
+	bson_destroy(&opts);
+	bson_destroy(&cursor_opts);
+
+	return success;
+} /* }}} */
+
+/* Returns whether any update operation has the "upsert" option enabled. */
+static bool phongo_client_bulk_write_has_upserts(php_phongo_clientbulkwrite_t* bulk_write) /* {{{ */
+{
+	bson_iter_t iter;
+	size_t      i;
+
+	for (i = 0; i < bulk_write->num_ops; i++) {
+		if (bson_iter_init_find(&iter, bulk_write->ops[i].opts, "upsert") && bson_iter_as_bool(&iter)) {
+			return true;
+		}
+	}
+
+	return false;
+} /* }}} */
+
+/* Executes the operations with as few bulkWrite commands as the server's
+ * limits allow. For ordered writes, execution stops after the first command
+ * reporting a write error. */
+static bool phongo_client_bulk_write_execute_commands(mongoc_client_t* client, php_phongo_clientbulkwrite_t* bulk_write, const mongoc_write_concern_t* write_concern, mongoc_client_session_t* client_session, uint32_t server_id, int32_t max_bson_size, int32_t max_write_batch_size, phongo_bulk_write_result_t* result, bson_t* reply, bson_error_t* error) /* {{{ */
+{
+	/* Per-operation results are only needed to report upserted IDs */
+	bool     errors_only = !phongo_client_bulk_write_has_upserts(bulk_write);
+	uint32_t offset      = 0;
+
+	while (offset < bulk_write->num_ops) {
+		bson_t   command = BSON_INITIALIZER;
+		uint32_t ops_len = phongo_client_bulk_write_build_command(bulk_write, offset, max_bson_size, max_write_batch_size, errors_only, &command);
+		bool     success = phongo_client_bulk_write_execute_command(client, &command, offset, write_concern, client_session, server_id, result, reply, error);
+
+		bson_destroy(&command);
+
+		if (!success) {
+			return false;
+		}
+
+		if (bulk_write->ordered && result->write_errors_len > 0) {
+			break;
+		}
+
+		offset += ops_len;
+	}
+
+	return true;
+} /* }}} */
+
+/* Executes a ClientBulkWrite, whose operations may span multiple namespaces.
+ * If the server supports the bulkWrite command, operations for all namespaces
+ * are sent together; otherwise, they are executed with one bulk write per
+ * namespace. Results are mapped back to the indexes of the ClientBulkWrite's
+ * operations and reported through a single WriteResult. */
+bool phongo_execute_client_bulk_write(zval* manager, php_phongo_clientbulkwrite_t* bulk_write, zval* options, uint32_t server_id, zval* return_value) /* {{{ */
+{
+	mongoc_client_t*              client;
+	bson_error_t                  error        = { 0 };
+	bson_t                        reply        = BSON_INITIALIZER;
+	bson_t                        merged_reply = BSON_INITIALIZER;
+	phongo_bulk_write_result_t    result;
+	php_phongo_writeresult_t*     writeresult;
+	zval*                         zwriteConcern          = NULL;
+	zval*                         zsession               = NULL;
+	const mongoc_write_concern_t* write_concern          = NULL;
+	const mongoc_write_concern_t* explicit_write_concern = NULL;
+	mongoc_client_session_t*      implicit_session       = NULL;
+	int32_t                       max_bson_size, max_write_batch_size;
+	uint32_t                      i;
+	bool                          success;
+
+	client = Z_MANAGER_OBJ_P(manager)->client;
+
+	if (bulk_write->executed) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "ClientBulkWrite objects may only be executed once and this instance has already been executed");
+		return false;
+	}
+
+	if (bulk_write->num_ops == 0) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Cannot do an empty bulk write");
+		return false;
+	}
+
+	if (!phongo_parse_session(options, client, NULL, &zsession)) {
+		/* Exception should already have been thrown */
+		return false;
+	}
+
+	if (!phongo_parse_write_concern(options, NULL, &zwriteConcern)) {
+		/* Exception should already have been thrown */
+		return false;
+	}
+
+	write_concern = zwriteConcern ? Z_WRITECONCERN_OBJ_P(zwriteConcern)->write_concern : phongo_manager_get_write_concern(Z_MANAGER_OBJ_P(manager));
+
+	if (zsession && !mongoc_write_concern_is_acknowledged(write_concern)) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Cannot combine \"session\" option with an unacknowledged write concern");
+		return false;
+	}
+
+	if (zsession) {
+		ZVAL_ZVAL(&bulk_write->session, zsession, 1, 0);
+	}
+
+	bulk_write->executed = true;
+
+	for (i = 0; i < bulk_write->num_ops; i++) {
+		phongo_read_cache_invalidate(Z_MANAGER_OBJ_P(manager), bulk_write->ops[i].namespace);
+	}
+
+	phongo_bulk_write_result_init(&result);
+
+	/* libmongoc only knows the client's write concern, so a default write
+	 * concern for the Manager must be passed explicitly */
+	if (zwriteConcern || Z_MANAGER_OBJ_P(manager)->write_concern) {
+		explicit_write_concern = write_concern;
+	}
+
+	/* Unacknowledged writes always use libmongoc bulk operations, which do not
+	 * wait for a reply. Otherwise, the bulkWrite command's cursor must use the
+	 * same session as the command, so an implicit session is started here. */
+	if (mongoc_write_concern_is_acknowledged(write_concern) && phongo_client_bulk_write_command_supported(client, server_id, &max_bson_size, &max_write_batch_size)) {
+		mongoc_client_session_t* client_session;
+
+		if (zsession) {
+			client_session = Z_SESSION_OBJ_P(zsession)->client_session;
+		} else {
+			client_session = implicit_session = mongoc_client_start_session(client, NULL, NULL);
+		}
+
+		success = phongo_client_bulk_write_execute_commands(client, bulk_write, explicit_write_concern, client_session, server_id, max_bson_size, max_write_batch_size, &result, &reply, &error);
+	} else {
+		success = phongo_client_bulk_write_execute_bulks(client, bulk_write, explicit_write_concern, zsession, server_id, &result, &reply, &error);
+	}
+
+	if (implicit_session) {
+		mongoc_client_session_destroy(implicit_session);
+	}
+
+	if (success && (phongo_bulk_write_result_first_error(&result.write_errors, MONGOC_ERROR_SERVER, &error) || phongo_bulk_write_result_first_error(&result.write_concern_errors, MONGOC_ERROR_WRITE_CONCERN, &error))) {
+		success = false;
+	}
+
+	phongo_bulk_write_result_to_reply(&result, &merged_reply);
+
+	writeresult                = phongo_writeresult_init(return_value, &merged_reply, manager, server_id);
+	writeresult->write_concern = mongoc_write_concern_copy(write_concern);
+
+	/* As with phongo_execute_bulk_write(), a BulkWriteException is thrown for
+	 * any failure so that the write result is accessible. */
+	if (!success) {
+		phongo_throw_bulk_write_exception(&error, &reply, return_value);
+	}
+
+	bson_destroy(&reply);
+	bson_destroy(&merged_reply);
+	phongo_bulk_write_result_destroy(&result);
+
+	return success;
+} /* }}} */
+
+/* Advance the cursor and return whether there is an error. On error, false is
+ * returned and an exception is thrown. */
+bool phongo_cursor_advance_and_check_for_error(mongoc_cursor_t* cursor) /* {{{ */
+{
+	const bson_t* doc = NULL;
+
+	if (!mongoc_cursor_next(cursor, &doc)) {
+		bson_error_t error = { 0 };
+
+		/* Check for connection related exceptions */
+		if (EG(exception)) {
+			return false;
+		}
+
+		/* Could simply be no docs, which is not an error */
+		if (mongoc_cursor_error_document(cursor, &error, &doc)) {
+			phongo_throw_exception_from_bson_error_t_and_reply(&error, doc);
+			return false;
+		}
+	}
+
+	return true;
+} /* }}} */
+
+/* Applies the Manager's default read preference and read concern to a
+ * collection, which otherwise inherits them from the client. */
+static void phongo_collection_apply_manager_defaults(mongoc_collection_t* collection, php_phongo_manager_t* manager) /* {{{ */
+{
+	if (manager->read_prefs) {
+		mongoc_collection_set_read_prefs(collection, manager->read_prefs);
+	}
+
+	if (manager->read_concern) {
+		mongoc_collection_set_read_concern(collection, manager->read_concern);
+	}
+} /* }}} */
+
+/* Resolves the collection for a query and initializes opts from the query's
+ * options. These do not depend on the session or selected server, so they may
+ * be reused across executions of the same query. On error, false is returned
+ * and an exception is thrown. */
+bool phongo_query_prepare(zval* manager, const char* namespace, zval* zquery, mongoc_collection_t** collection, bson_t* opts) /* {{{ */
+{
+	mongoc_client_t*          client;
+	const php_phongo_query_t* query;
+	char*                     dbname;
+	char*                     collname;
+
+	client = Z_MANAGER_OBJ_P(manager)->client;
+
+	if (!phongo_split_namespace(namespace, &dbname, &collname)) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "%s: %s", "Invalid namespace provided", namespace);
+		return false;
+	}
+	*collection = mongoc_client_get_collection(client, dbname, collname);
+	efree(dbname);
+	efree(collname);
+
+	phongo_collection_apply_manager_defaults(*collection, Z_MANAGER_OBJ_P(manager));
+
+	query = Z_QUERY_OBJ_P(zquery);
+
+	bson_copy_to(query->opts, opts);
+
+	if (query->read_concern) {
+		mongoc_collection_set_read_concern(*collection, query->read_concern);
+	}
+
+	return true;
+} /* }}} */
+
+/* Executes a query using a collection and opts initialized by
+ * phongo_query_prepare(). The session and server ID are appended to opts. */
+bool phongo_execute_query_with_opts(zval* manager, const char* namespace, zval* zquery, mongoc_collection_t* collection, bson_t* opts, zval* zreadPreference, zval* zsession, uint32_t server_id, zval* return_value) /* {{{ */
+{
+	const php_phongo_query_t* query  = Z_QUERY_OBJ_P(zquery);
+	php_phongo_manager_t*     intern = Z_MANAGER_OBJ_P(manager);
+	mongoc_cursor_t*          cursor;
+	zend_string*              cache_key = NULL;
+	bson_t*                   batch;
+
+	/* Identical reads through a Manager with the "coalesceReads" driver option
+	 * replay the results of the first read. The key is computed before any
+	 * session or server ID is appended to the options. */
+	if (intern->read_cache && phongo_read_cache_is_eligible(query, opts, zsession)) {
+		cache_key = phongo_read_cache_make_key(namespace, query, opts, phongo_read_preference_from_zval(zreadPreference));
+
+		if ((batch = zend_hash_find_ptr(intern->read_cache, cache_key))) {
+			zend_string_release(cache_key);
+
+			cursor = phongo_read_cache_replay(intern->client, namespace, batch, server_id);
+			phongo_cursor_init_for_query(return_value, manager, cursor, namespace, zquery, zreadPreference, zsession);
+
+			return true;
+		}
+	}
+
+	if (zsession && !mongoc_client_session_append(Z_SESSION_OBJ_P(zsession)->client_session, opts, NULL)) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Error appending \"session\" option");
+		return false;
+	}
+
+	if (!BSON_APPEND_INT32(opts, "serverId", server_id)) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Error appending \"serverId\" option");
+		return false;
+	}
+
+	cursor = mongoc_collection_find_with_opts(collection, query->filter, opts, phongo_read_preference_from_zval(zreadPreference));
+
+	/* maxAwaitTimeMS must be set before the cursor is sent */
+	if (query->max_await_time_ms) {
+		mongoc_cursor_set_max_await_time_ms(cursor, query->max_await_time_ms);
+	}
+
+	if (!phongo_cursor_advance_and_check_for_error(cursor)) {
+		mongoc_cursor_destroy(cursor);
+
+		if (cache_key) {
+			zend_string_release(cache_key);
+		}
+
+		return false;
+	}
+
+	/* Only results returned in a single batch are coalesced, so that reads
+	 * with many results are not buffered in their entirety */
+	if (cache_key) {
+		if (mongoc_cursor_get_id(cursor) == 0 && (batch = phongo_read_cache_drain(cursor))) {
+			mongoc_cursor_destroy(cursor);
+
+			cursor = phongo_read_cache_replay(intern->client, namespace, batch, server_id);
+
+			if (!phongo_read_cache_add(intern, cache_key, batch)) {
+				bson_destroy(batch);
+			}
+		}
+
+		zend_string_release(cache_key);
+	}
+
+	phongo_cursor_init_for_query(return_value, manager, cursor, namespace, zquery, zreadPreference, zsession);
+
+	return true;
+} /* }}} */
+
+bool phongo_execute_query(zval* manager, const char* namespace, zval* zquery, zval* options, uint32_t server_id, zval* return_value) /* {{{ */
+{
+	bson_t               opts = BSON_INITIALIZER;
+	mongoc_collection_t* collection;
+	zval*                zreadPreference = NULL;
+	zval*                zsession        = NULL;
+	bool                 retval          = false;
+
+	if (!phongo_query_prepare(manager, namespace, zquery, &collection, &opts)) {
+		/* Exception should already have been thrown */
+		bson_destroy(&opts);
+		return false;
+	}
+
+	if (!phongo_parse_read_preference(options, &zreadPreference)) {
+		/* Exception should already have been thrown */
+		goto cleanup;
+	}
+
+	if (!phongo_parse_session(options, Z_MANAGER_OBJ_P(manager)->client, NULL, &zsession)) {
+		/* Exception should already have been thrown */
+		goto cleanup;
+	}
+
+	retval = phongo_execute_query_with_opts(manager, namespace, zquery, collection, &opts, zreadPreference, zsession, server_id, return_value);
+
+cleanup:
+	mongoc_collection_destroy(collection);
+	bson_destroy(&opts);
+
+	return retval;
+} /* }}} */
+
+/* Samples the collection's _id values and appends up to (partitions - 1)
+ * ascending, distinct split points to the split_points array. Sampling does not
+ * apply the query's filter, since $sample may only use a random cursor when it
+ * is the first pipeline stage. Split points all share the BSON type of the
+ * first one, so that each can be used as a bound for the others in a range
+ * query. If zsession is not NULL, sampling uses the same session as the
+ * partitions. On error, false is returned and an exception is thrown. */
+bool phongo_query_get_split_points(zval* manager, const char* namespace, zval* zquery, zval* zreadPreference, zval* zsession, uint32_t server_id, zend_long partitions, bson_t* split_points) /* {{{ */
+{
+	mongoc_client_t*     client;
+	mongoc_collection_t* collection;
+	mongoc_cursor_t*     cursor;
+	char*                dbname;
+	char*                collname;
+	bson_t*              pipeline;
+	bson_t               opts    = BSON_INITIALIZER;
+	bson_value_t*        samples = NULL;
+	size_t               samples_count;
+	size_t               samples_size;
+	const bson_t*        doc;
+	bson_error_t         error = { 0 };
+	bool                 retval = false;
+	const bson_value_t*  last = NULL;
+	size_t               i;
+	zend_long            appended = 0;
+
+	client = Z_MANAGER_OBJ_P(manager)->client;
+
+	if (!phongo_split_namespace(namespace, &dbname, &collname)) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "%s: %s", "Invalid namespace provided", namespace);
+		return false;
+	}
+	collection = mongoc_client_get_collection(client, dbname, collname);
+	efree(dbname);
+	efree(collname);
+
+	phongo_collection_apply_manager_defaults(collection, Z_MANAGER_OBJ_P(manager));
+
+	if (Z_QUERY_OBJ_P(zquery)->read_concern) {
+		mongoc_collection_set_read_concern(collection, Z_QUERY_OBJ_P(zquery)->read_concern);
 	}
 
-	if (!BSON_APPEND_INT32(&opts, "serverId", server_id)) {
-		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Error appending \"serverId\" option");
+	samples_size = (size_t) partitions * PHONGO_PARALLEL_SCAN_SAMPLES_PER_PARTITION;
+
+	pipeline = BCON_NEW("pipeline", "[", "{", "$sample", "{", "size", BCON_INT64((int64_t) samples_size), "}", "}", "{", "$project", "{", "_id", BCON_INT32(1), "}", "}", "{", "$sort", "{", "_id", BCON_INT32(1), "}", "}", "]");
+
+	if (zsession && !mongoc_client_session_append(Z_SESSION_OBJ_P(zsession)->client_session, &opts, NULL)) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Error appending \"session\" option");
 		mongoc_collection_destroy(collection);
+		bson_destroy(pipeline);
 		bson_destroy(&opts);
 		return false;
 	}
 
-	cursor = mongoc_collection_find_with_opts(collection, query->filter, &opts, phongo_read_preference_from_zval(zreadPreference));
+	BSON_APPEND_INT32(&opts, "serverId", server_id);
+
+	cursor = mongoc_collection_aggregate(collection, MONGOC_QUERY_NONE, pipeline, &opts, phongo_read_preference_from_zval(zreadPreference));
 	mongoc_collection_destroy(collection);
+	bson_destroy(pipeline);
 	bson_destroy(&opts);
 
-	/* maxAwaitTimeMS must be set before the cursor is sent */
-	if (query->max_await_time_ms) {
-		mongoc_cursor_set_max_await_time_ms(cursor, query->max_await_time_ms);
+	samples       = ecalloc(samples_size, sizeof(bson_value_t));
+	samples_count = 0;
+
+	while (samples_count < samples_size && mongoc_cursor_next(cursor, &doc)) {
+		bson_iter_t iter;
+
+		if (bson_iter_init_find(&iter, doc, "_id")) {
+			bson_value_copy(bson_iter_value(&iter), &samples[samples_count++]);
+		}
 	}
 
-	if (!phongo_cursor_advance_and_check_for_error(cursor)) {
-		mongoc_cursor_destroy(cursor);
-		return false;
+	/* Check for connection related exceptions */
+	if (EG(exception)) {
+		goto cleanup;
 	}
 
-	phongo_cursor_init_for_query(return_value, manager, cursor, namespace, zquery, zreadPreference, zsession);
+	if (mongoc_cursor_error_document(cursor, &error, &doc)) {
+		phongo_throw_exception_from_bson_error_t_and_reply(&error, doc);
+		goto cleanup;
+	}
 
-	return true;
+	for (i = 1; i < (size_t) partitions && samples_count > 0; i++) {
+		const bson_value_t* split_point = &samples[(samples_count * i) / (size_t) partitions];
+		char                key[16];
+		const char*         key_str;
+
+		/* Samples are sorted, so skipping equal values leaves split points
+		 * in strictly ascending order */
+		if (last && (split_point->value_type != last->value_type || php_phongo_bson_value_compare(last, split_point) == 0)) {
+			continue;
+		}
+
+		bson_uint32_to_string((uint32_t) appended, &key_str, key, sizeof(key));
+		bson_append_value(split_points, key_str, -1, split_point);
+		appended++;
+		last = split_point;
+	}
+
+	retval = true;
+
+cleanup:
+	for (i = 0; i < samples_count; i++) {
+		bson_value_destroy(&samples[i]);
+	}
+
+	efree(samples);
+	mongoc_cursor_destroy(cursor);
+
+	return retval;
 } /* }}} */
 
 static bson_t* create_wrapped_command_envelope(const char* db, bson_t* reply)
@@ -919,118 +2409,173 @@ static bson_t* create_wrapped_command_envelope(const char* db, bson_t* reply)
 	return tmp;
 }
 
-static zval* phongo_create_implicit_session(zval* manager) /* {{{ */
+/* Returns whether a command reply contains a cursor that the server has not
+ * yet exhausted (i.e. its ID is non-zero). */
+static bool phongo_command_reply_has_open_cursor(const bson_t* reply) /* {{{ */
 {
-	mongoc_client_session_t* cs;
-	zval*                    zsession;
-
-	cs = mongoc_client_start_session(Z_MANAGER_OBJ_P(manager)->client, NULL, NULL);
+	bson_iter_t iter;
 
-	if (!cs) {
-		return NULL;
+	if (!bson_iter_init(&iter, reply) || !bson_iter_find_descendant(&iter, "cursor.id", &iter)) {
+		return false;
 	}
 
-	zsession = ecalloc(sizeof(zval), 1);
-
-	phongo_session_init(zsession, manager, cs);
-
-	return zsession;
+	return BSON_ITER_HOLDS_INT(&iter) && bson_iter_as_int64(&iter) != 0;
 } /* }}} */
 
-bool phongo_execute_command(zval* manager, php_phongo_command_type_t type, const char* db, zval* zcommand, zval* options, uint32_t server_id, zval* return_value) /* {{{ */
+/* Parses the readConcern, readPreference, and writeConcern options for a
+ * command according to its type and appends them to opts. These do not depend
+ * on the session or selected server, so they may be reused across executions
+ * of the same command. On error, false is returned and an exception is
+ * thrown. */
+bool phongo_command_prepare(zval* manager, php_phongo_command_type_t type, zval* options, bson_t* opts, zval** zreadPreference, bool* is_unacknowledged_write_concern) /* {{{ */
 {
-	mongoc_client_t*            client;
-	const php_phongo_command_t* command;
-	bson_iter_t                 iter;
-	bson_t                      reply;
-	bson_error_t                error = { 0 };
-	bson_t                      opts  = BSON_INITIALIZER;
-	mongoc_cursor_t*            cmd_cursor;
-	zval*                       zreadPreference                 = NULL;
-	zval*                       zsession                        = NULL;
-	bool                        result                          = false;
-	bool                        free_reply                      = false;
-	bool                        free_zsession                   = false;
-	bool                        is_unacknowledged_write_concern = false;
-
-	client  = Z_MANAGER_OBJ_P(manager)->client;
-	command = Z_COMMAND_OBJ_P(zcommand);
+	*is_unacknowledged_write_concern = false;
 
-	if ((type & PHONGO_OPTION_READ_CONCERN) && !phongo_parse_read_concern(options, &opts)) {
+	if ((type & PHONGO_OPTION_READ_CONCERN) && !phongo_parse_read_concern(options, opts)) {
 		/* Exception should already have been thrown */
-		goto cleanup;
-	}
-
-	if ((type & PHONGO_OPTION_READ_PREFERENCE) && !phongo_parse_read_preference(options, &zreadPreference)) {
-		/* Exception should already have been thrown */
-		goto cleanup;
+		return false;
 	}
 
-	if (!phongo_parse_session(options, client, &opts, &zsession)) {
+	if ((type & PHONGO_OPTION_READ_PREFERENCE) && !phongo_parse_read_preference(options, zreadPreference)) {
 		/* Exception should already have been thrown */
-		goto cleanup;
+		return false;
 	}
 
 	if (type & PHONGO_OPTION_WRITE_CONCERN) {
 		zval* zwriteConcern = NULL;
 
-		if (!phongo_parse_write_concern(options, &opts, &zwriteConcern)) {
+		if (!phongo_parse_write_concern(options, opts, &zwriteConcern)) {
 			/* Exception should already have been thrown */
-			goto cleanup;
+			return false;
 		}
 
 		/* Determine if the explicit or inherited write concern is
 		 * unacknowledged so that we can ensure it does not conflict with an
 		 * explicit or implicit session. */
 		if (zwriteConcern) {
-			is_unacknowledged_write_concern = !mongoc_write_concern_is_acknowledged(Z_WRITECONCERN_OBJ_P(zwriteConcern)->write_concern);
+			*is_unacknowledged_write_concern = !mongoc_write_concern_is_acknowledged(Z_WRITECONCERN_OBJ_P(zwriteConcern)->write_concern);
 		} else if (type != PHONGO_COMMAND_RAW) {
-			is_unacknowledged_write_concern = !mongoc_write_concern_is_acknowledged(mongoc_client_get_write_concern(client));
+			*is_unacknowledged_write_concern = !mongoc_write_concern_is_acknowledged(phongo_manager_get_write_concern(Z_MANAGER_OBJ_P(manager)));
 		}
 	}
 
+	return true;
+} /* }}} */
+
+bool phongo_execute_command(zval* manager, php_phongo_command_type_t type, const char* db, zval* zcommand, zval* options, uint32_t server_id, zval* return_value) /* {{{ */
+{
+	bson_t opts                            = BSON_INITIALIZER;
+	zval*  zreadPreference                 = NULL;
+	zval*  zsession                        = NULL;
+	bool   is_unacknowledged_write_concern = false;
+	bool   retval                          = false;
+
+	if (!phongo_command_prepare(manager, type, options, &opts, &zreadPreference, &is_unacknowledged_write_concern)) {
+		/* Exception should already have been thrown */
+		goto cleanup;
+	}
+
+	if (!phongo_parse_session(options, Z_MANAGER_OBJ_P(manager)->client, NULL, &zsession)) {
+		/* Exception should already have been thrown */
+		goto cleanup;
+	}
+
+	retval = phongo_execute_command_with_opts(manager, type, db, zcommand, &opts, zreadPreference, zsession, is_unacknowledged_write_concern, server_id, return_value);
+
+cleanup:
+	bson_destroy(&opts);
+
+	return retval;
+} /* }}} */
+
+/* Executes a command using opts initialized by phongo_command_prepare(). The
+ * session and server ID are appended to opts. */
+bool phongo_execute_command_with_opts(zval* manager, php_phongo_command_type_t type, const char* db, zval* zcommand, bson_t* opts, zval* zreadPreference, zval* zsession, bool is_unacknowledged_write_concern, uint32_t server_id, zval* return_value) /* {{{ */
+{
+	mongoc_client_t*            client;
+	const php_phongo_command_t* command;
+	bson_iter_t                 iter;
+	bson_t                      reply;
+	bson_error_t                error = { 0 };
+	mongoc_cursor_t*            cmd_cursor;
+	mongoc_client_session_t*    implicit_session  = NULL;
+	zval                        zimplicit_session = ZVAL_STATIC_INIT;
+	bool                        result            = false;
+	bool                        free_reply        = false;
+	const mongoc_read_prefs_t*  read_preference   = phongo_read_preference_from_zval(zreadPreference);
+	php_phongo_manager_t*       intern            = Z_MANAGER_OBJ_P(manager);
+
+	client  = intern->client;
+	command = Z_COMMAND_OBJ_P(zcommand);
+
 	if (zsession && is_unacknowledged_write_concern) {
 		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Cannot combine \"session\" option with an unacknowledged write concern");
 		goto cleanup;
 	}
 
+	if (zsession && !mongoc_client_session_append(Z_SESSION_OBJ_P(zsession)->client_session, opts, NULL)) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Error appending \"session\" option");
+		goto cleanup;
+	}
+
 	/* If an explicit session was not provided and the effective write concern
-	 * is not unacknowledged, attempt to create an implicit client session
-	 * (ignoring any errors). */
+	 * is not unacknowledged, attempt to start an implicit client session
+	 * (ignoring any errors). Its server session is taken from the client's
+	 * pool and a Session object is only created if a cursor must outlive this
+	 * function and continue to use it. */
 	if (!zsession && !is_unacknowledged_write_concern) {
-		zsession = phongo_create_implicit_session(manager);
+		implicit_session = mongoc_client_start_session(client, NULL, NULL);
 
-		if (zsession) {
-			free_zsession = true;
-
-			if (!mongoc_client_session_append(Z_SESSION_OBJ_P(zsession)->client_session, &opts, NULL)) {
-				phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Error appending implicit \"sessionId\" option");
-				goto cleanup;
-			}
+		if (implicit_session && !mongoc_client_session_append(implicit_session, opts, NULL)) {
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Error appending implicit \"sessionId\" option");
+			goto cleanup;
 		}
 	}
 
-	if (!BSON_APPEND_INT32(&opts, "serverId", server_id)) {
+	if (!BSON_APPEND_INT32(opts, "serverId", server_id)) {
 		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Error appending \"serverId\" option");
 		goto cleanup;
 	}
 
+	/* libmongoc only applies the client's read and write options, so those
+	 * specified for the Manager itself are applied here. Raw commands do not
+	 * inherit any options, and transactions prohibit them. */
+	if (type != PHONGO_COMMAND_RAW && !(zsession && mongoc_client_session_in_transaction(Z_SESSION_OBJ_P(zsession)->client_session))) {
+		if ((type & PHONGO_OPTION_READ_CONCERN) && intern->read_concern && !bson_has_field(opts, "readConcern")) {
+			mongoc_read_concern_append(intern->read_concern, opts);
+		}
+
+		if ((type & PHONGO_OPTION_WRITE_CONCERN) && intern->write_concern && !mongoc_write_concern_is_default(intern->write_concern) && !bson_has_field(opts, "writeConcern")) {
+			mongoc_write_concern_append(intern->write_concern, opts);
+		}
+
+		if ((type & PHONGO_OPTION_READ_PREFERENCE) && !read_preference) {
+			read_preference = intern->read_prefs;
+		}
+	}
+
+	/* Commands other than reads may modify any collection, so all coalesced
+	 * reads for the Manager are dropped */
+	if (type != PHONGO_COMMAND_READ) {
+		phongo_read_cache_invalidate(Z_MANAGER_OBJ_P(manager), NULL);
+	}
+
 	/* Although "opts" already always includes the serverId option, the read
 	 * preference is added to the command parts, which is relevant for mongos
 	 * command construction. */
 	switch (type) {
 		case PHONGO_COMMAND_RAW:
-			result = mongoc_client_command_with_opts(client, db, command->bson, phongo_read_preference_from_zval(zreadPreference), &opts, &reply, &error);
+			result = mongoc_client_command_with_opts(client, db, command->bson, phongo_read_preference_from_zval(zreadPreference), opts, &reply, &error);
 			break;
 		case PHONGO_COMMAND_READ:
-			result = mongoc_client_read_command_with_opts(client, db, command->bson, phongo_read_preference_from_zval(zreadPreference), &opts, &reply, &error);
+			result = mongoc_client_read_command_with_opts(client, db, command->bson, read_preference, opts, &reply, &error);
 			break;
 		case PHONGO_COMMAND_WRITE:
-			result = mongoc_client_write_command_with_opts(client, db, command->bson, &opts, &reply, &error);
+			result = mongoc_client_write_command_with_opts(client, db, command->bson, opts, &reply, &error);
 			break;
 		case PHONGO_COMMAND_READ_WRITE:
 			/* We can pass NULL as readPreference, as this argument was added historically, but has no function */
-			result = mongoc_client_read_write_command_with_opts(client, db, command->bson, NULL, &opts, &reply, &error);
+			result = mongoc_client_read_write_command_with_opts(client, db, command->bson, NULL, opts, &reply, &error);
 			break;
 		default:
 			/* Should never happen, but if it does: exception */
@@ -1066,6 +2611,14 @@ bool phongo_execute_command(zval* manager, php_phongo_command_type_t type, const
 			bson_append_int64(&cursor_opts, "batchSize", -1, command->batch_size);
 		}
 
+		/* An exhausted cursor will not issue any further commands, so the
+		 * implicit session can be returned to the pool during cleanup. */
+		if (implicit_session && phongo_command_reply_has_open_cursor(&reply)) {
+			phongo_session_init(&zimplicit_session, manager, implicit_session);
+			implicit_session = NULL;
+			zsession         = &zimplicit_session;
+		}
+
 		if (zsession && !mongoc_client_session_append(Z_SESSION_OBJ_P(zsession)->client_session, &cursor_opts, &error)) {
 			phongo_throw_exception_from_bson_error_t(&error);
 			bson_destroy(&initial_reply);
@@ -1088,15 +2641,16 @@ bool phongo_execute_command(zval* manager, php_phongo_command_type_t type, const
 	phongo_cursor_init_for_command(return_value, manager, cmd_cursor, db, zcommand, zreadPreference, zsession);
 
 cleanup:
-	bson_destroy(&opts);
-
 	if (free_reply) {
 		bson_destroy(&reply);
 	}
 
-	if (free_zsession) {
-		zval_ptr_dtor(zsession);
-		efree(zsession);
+	if (implicit_session) {
+		mongoc_client_session_destroy(implicit_session);
+	}
+
+	if (!Z_ISUNDEF(zimplicit_session)) {
+		zval_ptr_dtor(&zimplicit_session);
 	}
 
 	return result;
@@ -2350,8 +3904,12 @@ static void php_phongo_dispatch_handlers(const char* name, zval* z_event)
 /* Search for a Manager associated with the given client in the request-scoped
  * registry. If any Manager is found, copy it into the output parameter
  * (incrementing its ref-count) and return true; otherwise, set the output
- * parameter to undefined and return false. */
-static bool php_phongo_copy_manager_for_client(mongoc_client_t* client, zval* out)
+ * parameter to undefined and return false.
+ *
+ * The context of a pooled client is its pool, which is shared by all clients
+ * in that pool, so events for a pooled client are attributed to the first
+ * Manager using the same pool. Such Managers have identical arguments. */
+static bool php_phongo_copy_manager_for_client(void* context, zval* out)
 {
 	php_phongo_manager_t* manager;
 
@@ -2361,7 +3919,7 @@ static bool php_phongo_copy_manager_for_client(mongoc_client_t* client, zval* ou
 
 	ZEND_HASH_FOREACH_PTR(MONGODB_G(managers), manager)
 	{
-		if (manager->client == client) {
+		if ((void*) manager->client == context || (manager->pclient && (void*) manager->pclient->pool == context)) {
 			ZVAL_OBJ(out, &manager->std);
 			Z_ADDREF_P(out);
 
@@ -2481,6 +4039,17 @@ static void php_phongo_command_failed(const mongoc_apm_command_failed_t* event)
 	zval_ptr_dtor(&z_event);
 }
 
+/* Invalidates cached server selection results for the client. This is not
+ * dispatched to APM subscribers. */
+static void php_phongo_topology_changed(const mongoc_apm_topology_changed_t* event)
+{
+	php_phongo_pclient_t* pclient = php_phongo_find_pclient_for_client((mongoc_client_t*) mongoc_apm_topology_changed_get_context(event));
+
+	if (pclient) {
+		php_phongo_pclient_clear_selected_servers(pclient);
+	}
+}
+
 /* Sets the callbacks for APM */
 bool php_phongo_set_monitoring_callbacks(mongoc_client_t* client)
 {
@@ -2491,6 +4060,7 @@ bool php_phongo_set_monitoring_callbacks(mongoc_client_t* client)
 	mongoc_apm_set_command_started_cb(callbacks, php_phongo_command_started);
 	mongoc_apm_set_command_succeeded_cb(callbacks, php_phongo_command_succeeded);
 	mongoc_apm_set_command_failed_cb(callbacks, php_phongo_command_failed);
+	mongoc_apm_set_topology_changed_cb(callbacks, php_phongo_topology_changed);
 
 	retval = mongoc_client_set_apm_callbacks(client, callbacks, client);
 
@@ -2503,109 +4073,301 @@ bool php_phongo_set_monitoring_callbacks(mongoc_client_t* client)
 	return retval;
 }
 
-static zval* php_phongo_manager_prepare_manager_for_hash(zval* driverOptions, bool* free)
+#ifdef ZTS
+/* Sets the callbacks for APM on a client pool. Topology events are emitted by
+ * the pool's monitoring thread, which cannot access request globals, so only
+ * command events are observed. The pool itself is used as the context (see:
+ * php_phongo_copy_manager_for_client). */
+static bool php_phongo_set_pool_monitoring_callbacks(mongoc_client_pool_t* pool)
 {
-	php_phongo_manager_t* manager;
-	zval*                 autoEncryptionOpts      = NULL;
-	zval*                 keyVaultClient          = NULL;
-	zval*                 driverOptionsClone      = NULL;
-	zval*                 autoEncryptionOptsClone = NULL;
-	zval                  stackAutoEncryptionOptsClone;
+	bool retval;
 
-	*free = false;
+	mongoc_apm_callbacks_t* callbacks = mongoc_apm_callbacks_new();
 
-	if (!driverOptions) {
-		return NULL;
+	mongoc_apm_set_command_started_cb(callbacks, php_phongo_command_started);
+	mongoc_apm_set_command_succeeded_cb(callbacks, php_phongo_command_succeeded);
+	mongoc_apm_set_command_failed_cb(callbacks, php_phongo_command_failed);
+
+	retval = mongoc_client_pool_set_apm_callbacks(pool, callbacks, pool);
+
+	if (!retval) {
+		phongo_throw_exception(PHONGO_ERROR_UNEXPECTED_VALUE, "Failed to set APM callbacks");
+	}
+
+	mongoc_apm_callbacks_destroy(callbacks);
+
+	return retval;
+}
+#endif
+
+static void php_phongo_client_hash_update_zval(PHP_MD5_CTX* context, zval* value);
+
+/* Feeds a length-prefixed string into the client hash, so that adjacent
+ * strings cannot be shifted into one another (e.g. "ab" + "c" vs. "a" + "bc"). */
+static void php_phongo_client_hash_update_string(PHP_MD5_CTX* context, const char* str, size_t str_len)
+{
+	uint64_t len = (uint64_t) str_len;
+
+	PHP_MD5Update(context, &len, sizeof(len));
+	PHP_MD5Update(context, str, str_len);
+}
+
+/* Feeds each key and value of an array into the client hash. Keys are tagged
+ * by type so that integer and string keys cannot collide. Recursive arrays
+ * only contribute their element count once recursion is detected. */
+static void php_phongo_client_hash_update_hash(PHP_MD5_CTX* context, HashTable* ht)
+{
+	zend_string* key;
+	zend_ulong   index;
+	zval*        value;
+	uint64_t     count = (uint64_t) zend_hash_num_elements(ht);
+
+	PHP_MD5Update(context, &count, sizeof(count));
+
+	if (!php_phongo_zend_hash_apply_protection_begin(ht)) {
+		return;
+	}
+
+	ZEND_HASH_FOREACH_KEY_VAL(ht, index, key, value)
+	{
+		if (key) {
+			PHP_MD5Update(context, "s", 1);
+			php_phongo_client_hash_update_string(context, ZSTR_VAL(key), ZSTR_LEN(key));
+		} else {
+			uint64_t uindex = (uint64_t) index;
+
+			PHP_MD5Update(context, "i", 1);
+			PHP_MD5Update(context, &uindex, sizeof(uindex));
+		}
+
+		php_phongo_client_hash_update_zval(context, value);
 	}
+	ZEND_HASH_FOREACH_END();
+
+	php_phongo_zend_hash_apply_protection_end(ht);
+}
+
+/* Feeds a value into the client hash, prefixed by its type. A Manager (e.g. the
+ * "keyVaultClient" auto encryption option) contributes its own client hash.
+ * Resources only contribute their type, as was the case when options were
+ * serialized. */
+static void php_phongo_client_hash_update_zval(PHP_MD5_CTX* context, zval* value)
+{
+	unsigned char type;
+
+	ZVAL_DEREF(value);
+
+	type = (unsigned char) Z_TYPE_P(value);
+	PHP_MD5Update(context, &type, 1);
 
-	if (!php_array_existsc(driverOptions, "autoEncryption")) {
-		goto ref;
+	switch (Z_TYPE_P(value)) {
+		case IS_LONG:
+			PHP_MD5Update(context, &Z_LVAL_P(value), sizeof(zend_long));
+			break;
+
+		case IS_DOUBLE:
+			PHP_MD5Update(context, &Z_DVAL_P(value), sizeof(double));
+			break;
+
+		case IS_STRING:
+			php_phongo_client_hash_update_string(context, Z_STRVAL_P(value), Z_STRLEN_P(value));
+			break;
+
+		case IS_ARRAY:
+			php_phongo_client_hash_update_hash(context, Z_ARRVAL_P(value));
+			break;
+
+		case IS_OBJECT:
+			if (instanceof_function(Z_OBJCE_P(value), php_phongo_manager_ce)) {
+				php_phongo_manager_t* manager = Z_MANAGER_OBJ_P(value);
+
+				PHP_MD5Update(context, "m", 1);
+				php_phongo_client_hash_update_string(context, manager->client_hash, manager->client_hash_len);
+				break;
+			}
+
+			PHP_MD5Update(context, "o", 1);
+			php_phongo_client_hash_update_string(context, ZSTR_VAL(Z_OBJCE_P(value)->name), ZSTR_LEN(Z_OBJCE_P(value)->name));
+			php_phongo_client_hash_update_hash(context, Z_OBJPROP_P(value));
+			break;
+
+		default:
+			/* Null, booleans (see: IS_TRUE and IS_FALSE), and resources */
+			break;
 	}
+}
 
-	autoEncryptionOpts = php_array_fetchc(driverOptions, "autoEncryption");
-	if (Z_TYPE_P(autoEncryptionOpts) != IS_ARRAY) {
-		goto ref;
+/* Returns whether an options array may be ignored when hashing a client. An
+ * empty array is equivalent to omitting the options altogether. */
+static inline bool php_phongo_client_hash_options_empty(zval* options)
+{
+	return !options || (Z_TYPE_P(options) == IS_ARRAY && zend_hash_num_elements(Z_ARRVAL_P(options)) == 0);
+}
+
+/* Returns whether a URI option only determines a Manager's default read
+ * preference, read concern, or write concern. Such options do not affect the
+ * connection and are applied to each Manager rather than its client (see:
+ * php_phongo_manager_apply_defaults). */
+static bool php_phongo_is_manager_default_option(const char* key, size_t key_len)
+{
+	static const char* const names[] = {
+		MONGOC_URI_JOURNAL,
+		MONGOC_URI_MAXSTALENESSSECONDS,
+		MONGOC_URI_READCONCERNLEVEL,
+		MONGOC_URI_READPREFERENCE,
+		MONGOC_URI_READPREFERENCETAGS,
+		MONGOC_URI_SAFE,
+		MONGOC_URI_SLAVEOK,
+		MONGOC_URI_W,
+		MONGOC_URI_WTIMEOUTMS,
+	};
+	size_t i;
+
+	for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		if (strlen(names[i]) == key_len && !strncasecmp(names[i], key, key_len)) {
+			return true;
+		}
 	}
 
-	if (!php_array_existsc(autoEncryptionOpts, "keyVaultClient")) {
-		goto ref;
+	return false;
+}
+
+/* Feeds the URI string into the client hash, omitting options in its query
+ * string that only determine Manager defaults. has_defaults will be set if any
+ * such option was omitted. */
+static void php_phongo_client_hash_update_uri(PHP_MD5_CTX* context, const char* uri_string, bool* has_defaults)
+{
+	const char* query = strchr(uri_string, '?');
+	const char* option;
+
+	if (!query) {
+		php_phongo_client_hash_update_string(context, uri_string, strlen(uri_string));
+		return;
 	}
 
-	keyVaultClient = php_array_fetchc(autoEncryptionOpts, "keyVaultClient");
-	if (Z_TYPE_P(keyVaultClient) != IS_OBJECT || !instanceof_function(Z_OBJCE_P(keyVaultClient), php_phongo_manager_ce)) {
-		goto ref;
+	php_phongo_client_hash_update_string(context, uri_string, query - uri_string);
+
+	for (option = query + 1; *option;) {
+		const char* end = strchr(option, '&');
+		const char* eq;
+		size_t      option_len = end ? (size_t)(end - option) : strlen(option);
+
+		eq = memchr(option, '=', option_len);
+
+		if (php_phongo_is_manager_default_option(option, eq ? (size_t)(eq - option) : option_len)) {
+			*has_defaults = true;
+		} else {
+			php_phongo_client_hash_update_string(context, option, option_len);
+		}
+
+		if (!end) {
+			break;
+		}
+
+		option = end + 1;
 	}
+}
 
-	*free = true;
+/* Feeds the options array into the client hash, omitting options that only
+ * determine Manager defaults. has_defaults will be set if any such option was
+ * omitted. */
+static void php_phongo_client_hash_update_options(PHP_MD5_CTX* context, zval* options, bool* has_defaults)
+{
+	zend_string* key;
+	zend_ulong   index;
+	zval*        value;
 
-	manager = Z_MANAGER_OBJ_P(keyVaultClient);
+	if (Z_TYPE_P(options) != IS_ARRAY) {
+		php_phongo_client_hash_update_zval(context, options);
+		return;
+	}
 
-	driverOptionsClone      = ecalloc(sizeof(zval), 1);
-	autoEncryptionOptsClone = &stackAutoEncryptionOptsClone;
+	PHP_MD5Update(context, "a", 1);
 
-	ZVAL_DUP(autoEncryptionOptsClone, autoEncryptionOpts);
-	ADD_ASSOC_STRINGL(autoEncryptionOptsClone, "keyVaultClient", manager->client_hash, manager->client_hash_len);
+	ZEND_HASH_FOREACH_KEY_VAL(Z_ARRVAL_P(options), index, key, value)
+	{
+		if (key && php_phongo_is_manager_default_option(ZSTR_VAL(key), ZSTR_LEN(key))) {
+			*has_defaults = true;
+			continue;
+		}
 
-	ZVAL_DUP(driverOptionsClone, driverOptions);
-	ADD_ASSOC_ZVAL_EX(driverOptionsClone, "autoEncryption", autoEncryptionOptsClone);
+		if (key) {
+			PHP_MD5Update(context, "s", 1);
+			php_phongo_client_hash_update_string(context, ZSTR_VAL(key), ZSTR_LEN(key));
+		} else {
+			uint64_t uindex = (uint64_t) index;
 
-	return driverOptionsClone;
+			PHP_MD5Update(context, "i", 1);
+			PHP_MD5Update(context, &uindex, sizeof(uindex));
+		}
 
-ref:
-	Z_ADDREF_P(driverOptions);
-	return driverOptions;
+		php_phongo_client_hash_update_zval(context, value);
+	}
+	ZEND_HASH_FOREACH_END();
 }
 
-/* Creates a hash for a client by concatenating the URI string with serialized
- * options arrays. On success, a persistent string is returned (i.e. pefree()
- * should be used to free it) and hash_len will be set to the string's length.
- * On error, an exception will have been thrown and NULL will be returned. */
-static char* php_phongo_manager_make_client_hash(const char* uri_string, zval* options, zval* driverOptions, size_t* hash_len)
+/* Creates a hash for a client by computing an MD5 digest over the process ID,
+ * URI string, and options arrays. Values are fed into the digest as they are
+ * walked, so no intermediate array or serialized string is created. The result
+ * is a hexadecimal string of PHONGO_CLIENT_HASH_LEN characters, which should be
+ * freed with efree(), and hash_len will be set to its length.
+ *
+ * Options that only determine the Manager's default read preference, read
+ * concern, or write concern are omitted, so that Managers differing only in
+ * those options share a client. has_defaults will be set if any such option
+ * was specified.
+ *
+ * Since most applications construct a Manager with only a URI string, the hash
+ * for the last such URI is retained and reused for subsequent Managers created
+ * by the same process. */
+static char* php_phongo_manager_make_client_hash(const char* uri_string, zval* options, zval* driverOptions, size_t* hash_len, bool* has_defaults)
 {
-	char*                hash    = NULL;
-	smart_str            var_buf = { 0 };
-	php_serialize_data_t var_hash;
-	zval*                serializable_driver_options = NULL;
-	bool                 free_driver_options         = false;
+	PHP_MD5_CTX   context;
+	unsigned char digest[16];
+	char          hash[PHONGO_CLIENT_HASH_LEN + 1];
+	zend_long     pid      = (zend_long) getpid();
+	size_t        uri_len  = strlen(uri_string);
+	bool          uri_only = php_phongo_client_hash_options_empty(options) && php_phongo_client_hash_options_empty(driverOptions);
 
-	zval args;
+	*hash_len     = PHONGO_CLIENT_HASH_LEN;
+	*has_defaults = false;
 
-	array_init_size(&args, 4);
-	ADD_ASSOC_LONG_EX(&args, "pid", getpid());
-	ADD_ASSOC_STRING(&args, "uri", uri_string);
+	if (uri_only && MONGODB_G(last_client_hash_uri) && MONGODB_G(last_client_hash_pid) == pid && strcmp(MONGODB_G(last_client_hash_uri), uri_string) == 0) {
+		return estrndup(MONGODB_G(last_client_hash), PHONGO_CLIENT_HASH_LEN);
+	}
 
-	if (options) {
-		ADD_ASSOC_ZVAL_EX(&args, "options", options);
-		Z_ADDREF_P(options);
+	PHP_MD5Init(&context);
+	PHP_MD5Update(&context, &pid, sizeof(pid));
+	php_phongo_client_hash_update_uri(&context, uri_string, has_defaults);
+
+	if (php_phongo_client_hash_options_empty(options)) {
+		PHP_MD5Update(&context, "\0", 1);
 	} else {
-		ADD_ASSOC_NULL_EX(&args, "options");
+		php_phongo_client_hash_update_options(&context, options, has_defaults);
 	}
 
-	if (driverOptions) {
-		serializable_driver_options = php_phongo_manager_prepare_manager_for_hash(driverOptions, &free_driver_options);
-		ADD_ASSOC_ZVAL_EX(&args, "driverOptions", serializable_driver_options);
+	if (php_phongo_client_hash_options_empty(driverOptions)) {
+		PHP_MD5Update(&context, "\0", 1);
 	} else {
-		ADD_ASSOC_NULL_EX(&args, "driverOptions");
+		php_phongo_client_hash_update_zval(&context, driverOptions);
 	}
 
-	PHP_VAR_SERIALIZE_INIT(var_hash);
-	php_var_serialize(&var_buf, &args, &var_hash);
-	PHP_VAR_SERIALIZE_DESTROY(var_hash);
-
-	if (!EG(exception)) {
-		*hash_len = ZSTR_LEN(var_buf.s);
-		hash      = estrndup(ZSTR_VAL(var_buf.s), *hash_len);
-	}
+	PHP_MD5Final(digest, &context);
+	make_digest_ex(hash, digest, sizeof(digest));
 
-	zval_ptr_dtor(&args);
+	/* URIs with default options cannot be cached, since has_defaults must be
+	 * reported for them */
+	if (uri_only && !*has_defaults) {
+		if (MONGODB_G(last_client_hash_uri)) {
+			pefree(MONGODB_G(last_client_hash_uri), 1);
+		}
 
-	if (free_driver_options) {
-		efree(serializable_driver_options);
+		MONGODB_G(last_client_hash_uri) = pestrndup(uri_string, uri_len, 1);
+		MONGODB_G(last_client_hash_pid) = pid;
+		memcpy(MONGODB_G(last_client_hash), hash, sizeof(hash));
 	}
 
-	smart_str_free(&var_buf);
-
-	return hash;
+	return estrndup(hash, PHONGO_CLIENT_HASH_LEN);
 }
 
 static bool php_phongo_extract_handshake_data(zval* driver, const char* key, char** value, size_t* value_len)
@@ -2731,7 +4493,9 @@ cleanup:
 	}
 }
 
-static mongoc_client_t* php_phongo_make_mongo_client(const mongoc_uri_t* uri, zval* driverOptions) /* {{{ */
+/* Logs library versions and appends handshake data before creating a client
+ * or client pool. An exception may be thrown for invalid handshake data. */
+static void php_phongo_prepare_mongo_client(zval* driverOptions) /* {{{ */
 {
 	const char *mongoc_version, *bson_version;
 
@@ -2757,11 +4521,91 @@ static mongoc_client_t* php_phongo_make_mongo_client(const mongoc_uri_t* uri, zv
 		bson_version,
 		PHP_VERSION);
 
-	php_phongo_set_handshake_data(driverOptions);
+	php_phongo_set_handshake_data(driverOptions);
+} /* }}} */
+
+static mongoc_client_t* php_phongo_make_mongo_client(const mongoc_uri_t* uri, zval* driverOptions) /* {{{ */
+{
+	php_phongo_prepare_mongo_client(driverOptions);
+
+	return mongoc_client_new_from_uri(uri);
+} /* }}} */
+
+#ifdef ZTS
+/* Pops a client for the Manager from the process-wide pool for its client hash,
+ * creating the pool if necessary. Pooled clients are tracked in the request
+ * registry and pushed back to their pool when the Manager is freed (see:
+ * php_phongo_pclient_destroy). This never blocks: if the pool's maxPoolSize
+ * has been reached, an exception is thrown instead of waiting for another
+ * thread to free a client. Returns true on success; otherwise, false is
+ * returned and an exception is thrown. */
+static bool php_phongo_pop_pooled_client(php_phongo_manager_t* manager, const mongoc_uri_t* uri, const mongoc_ssl_opt_t* ssl_opt, zval* driverOptions) /* {{{ */
+{
+	mongoc_client_pool_t* pool;
+
+	tsrm_mutex_lock(phongo_client_pools_mutex);
+
+	if (!(pool = zend_hash_str_find_ptr(&phongo_client_pools, manager->client_hash, manager->client_hash_len))) {
+		php_phongo_prepare_mongo_client(driverOptions);
+
+		if (EG(exception)) {
+			tsrm_mutex_unlock(phongo_client_pools_mutex);
+			return false;
+		}
+
+		if (!(pool = mongoc_client_pool_new(uri))) {
+			tsrm_mutex_unlock(phongo_client_pools_mutex);
+			phongo_throw_exception(PHONGO_ERROR_RUNTIME, "Failed to create client pool from URI: '%s'", mongoc_uri_get_string(uri));
+			return false;
+		}
+
+		mongoc_client_pool_set_error_api(pool, MONGOC_ERROR_API_VERSION_2);
+
+#ifdef MONGOC_ENABLE_SSL
+		if (ssl_opt) {
+			mongoc_client_pool_set_ssl_opts(pool, ssl_opt);
+		}
+#endif
+
+		if (!php_phongo_set_pool_monitoring_callbacks(pool)) {
+			/* Exception should already have been thrown */
+			mongoc_client_pool_destroy(pool);
+			tsrm_mutex_unlock(phongo_client_pools_mutex);
+			return false;
+		}
+
+		zend_hash_str_update_ptr(&phongo_client_pools, manager->client_hash, manager->client_hash_len, pool);
+
+		MONGOC_DEBUG("Created client pool with hash: %s", manager->client_hash);
+	}
+
+	tsrm_mutex_unlock(phongo_client_pools_mutex);
+
+	if (!(manager->client = mongoc_client_pool_try_pop(pool))) {
+		phongo_throw_exception(PHONGO_ERROR_RUNTIME, "Client pool for URI '%s' is exhausted: all %d clients are in use", mongoc_uri_get_string(uri), mongoc_uri_get_option_as_int32(uri, MONGOC_URI_MAXPOOLSIZE, 100));
+		return false;
+	}
 
-	return mongoc_client_new_from_uri(uri);
+	manager->use_persistent_client = false;
+
+	if (!php_phongo_client_register(manager)) {
+		mongoc_client_pool_push(pool, manager->client);
+		manager->client = NULL;
+		phongo_throw_exception(PHONGO_ERROR_UNEXPECTED_VALUE, "Failed to add Manager client to internal registry");
+		return false;
+	}
+
+	manager->pclient->pool = pool;
+
+	return true;
 } /* }}} */
 
+static void php_phongo_client_pool_destroy_ptr(zval* ptr)
+{
+	mongoc_client_pool_destroy(Z_PTR_P(ptr));
+}
+#endif
+
 /* Adds a client to the appropriate registry. Persistent and request-scoped
  * clients each have their own registries (i.e. HashTables), which use different
  * forms of memory allocation. Both registries are used for PID tracking.
@@ -2775,9 +4619,27 @@ bool php_phongo_client_register(php_phongo_manager_t* manager)
 	pclient->created_by_pid = (int) getpid();
 	pclient->is_persistent  = is_persistent;
 
+	manager->pclient = pclient;
+
 	if (is_persistent) {
+		php_phongo_pclient_acquire(pclient);
+
+		/* A client using this keyVaultClient holds a reference to it, so that
+		 * the keyVaultClient cannot be evicted before that client */
+		if (!Z_ISUNDEF(manager->key_vault_client_manager) && Z_MANAGER_OBJ_P(&manager->key_vault_client_manager)->pclient) {
+			pclient->key_vault_pclient = Z_MANAGER_OBJ_P(&manager->key_vault_client_manager)->pclient;
+			php_phongo_pclient_acquire(pclient->key_vault_pclient);
+		}
+
 		MONGOC_DEBUG("Stored persistent client with hash: %s", manager->client_hash);
-		return zend_hash_str_update_ptr(&MONGODB_G(persistent_clients), manager->client_hash, manager->client_hash_len, pclient) != NULL;
+
+		if (!zend_hash_str_update_ptr(&MONGODB_G(persistent_clients), manager->client_hash, manager->client_hash_len, pclient)) {
+			return false;
+		}
+
+		php_phongo_evict_persistent_clients();
+
+		return true;
 	} else {
 		MONGOC_DEBUG("Stored non-persistent client");
 		return zend_hash_next_index_insert_ptr(MONGODB_G(request_clients), pclient) != NULL;
@@ -2793,10 +4655,15 @@ bool php_phongo_client_unregister(php_phongo_manager_t* manager)
 	zend_ulong            index;
 	php_phongo_pclient_t* pclient;
 
-	/* Persistent clients do not get unregistered. */
+	/* Persistent clients do not get unregistered, but they may be evicted once
+	 * no Manager references them (see: php_phongo_evict_persistent_clients). */
 	if (manager->use_persistent_client) {
 		MONGOC_DEBUG("Not destroying persistent client for Manager");
 
+		if (manager->pclient) {
+			php_phongo_pclient_release(manager->pclient);
+		}
+
 		return false;
 	}
 
@@ -2820,17 +4687,312 @@ bool php_phongo_client_unregister(php_phongo_manager_t* manager)
 	return false;
 }
 
-static mongoc_client_t* php_phongo_find_persistent_client(const char* hash, size_t hash_len)
+static php_phongo_pclient_t* php_phongo_find_persistent_client(const char* hash, size_t hash_len)
 {
-	php_phongo_pclient_t* pclient = zend_hash_str_find_ptr(&MONGODB_G(persistent_clients), hash, hash_len);
+	return zend_hash_str_find_ptr(&MONGODB_G(persistent_clients), hash, hash_len);
+}
 
-	if (pclient) {
-		return pclient->client;
+/* Records a reference to a persistent client from a Manager or from another
+ * client using it as its keyVaultClient. Referenced clients are never evicted. */
+void php_phongo_pclient_acquire(php_phongo_pclient_t* pclient)
+{
+	pclient->references++;
+	pclient->last_used_at = bson_get_monotonic_time();
+}
+
+/* Releases a reference to a persistent client. The client's idle time is
+ * measured from when its last reference is released. */
+void php_phongo_pclient_release(php_phongo_pclient_t* pclient)
+{
+	if (pclient->references > 0) {
+		pclient->references--;
+	}
+
+	pclient->last_used_at = bson_get_monotonic_time();
+}
+
+/* Returns the key of the least recently used persistent client that is not
+ * referenced. If idle_before is non-zero, only clients unused since that time
+ * are considered. Returns NULL if there is no such client. */
+static zend_string* php_phongo_find_evictable_persistent_client(int64_t idle_before)
+{
+	zend_string*          key;
+	zend_string*          lru_key = NULL;
+	php_phongo_pclient_t* pclient;
+	php_phongo_pclient_t* lru     = NULL;
+
+	ZEND_HASH_FOREACH_STR_KEY_PTR(&MONGODB_G(persistent_clients), key, pclient)
+	{
+		if (!key || pclient->references > 0) {
+			continue;
+		}
+
+		if (idle_before && pclient->last_used_at >= idle_before) {
+			continue;
+		}
+
+		if (!lru || pclient->last_used_at < lru->last_used_at) {
+			lru     = pclient;
+			lru_key = key;
+		}
+	}
+	ZEND_HASH_FOREACH_END();
+
+	return lru_key;
+}
+
+/* Destroys persistent clients that are no longer referenced by a Manager or
+ * another client. Clients idle for longer than the
+ * "mongodb.persistent_client_idle_timeout" INI setting (in seconds) are
+ * destroyed first. The least recently used clients are then destroyed until
+ * the registry is within the "mongodb.max_persistent_clients" limit. Both
+ * settings default to zero, which disables eviction. */
+static void php_phongo_evict_persistent_clients(void)
+{
+	zend_string* key;
+	zend_long    max_clients  = MONGODB_G(max_persistent_clients);
+	zend_long    idle_timeout = MONGODB_G(persistent_client_idle_timeout);
+
+	if (idle_timeout > 0) {
+		int64_t idle_before = bson_get_monotonic_time() - (int64_t) idle_timeout * 1000 * 1000;
+
+		while ((key = php_phongo_find_evictable_persistent_client(idle_before))) {
+			MONGOC_DEBUG("Evicting idle persistent client with hash: %s", ZSTR_VAL(key));
+			zend_hash_del(&MONGODB_G(persistent_clients), key);
+		}
+	}
+
+	if (max_clients > 0) {
+		while ((zend_long) zend_hash_num_elements(&MONGODB_G(persistent_clients)) > max_clients && (key = php_phongo_find_evictable_persistent_client(0))) {
+			MONGOC_DEBUG("Evicting least recently used persistent client with hash: %s", ZSTR_VAL(key));
+			zend_hash_del(&MONGODB_G(persistent_clients), key);
+		}
+	}
+}
+
+/* Returns the registered pclient for a libmongoc client, or NULL if it is not
+ * found in either the persistent or request-scoped registry. */
+static php_phongo_pclient_t* php_phongo_find_pclient_for_client(mongoc_client_t* client)
+{
+	php_phongo_pclient_t* pclient;
+
+	ZEND_HASH_FOREACH_PTR(&MONGODB_G(persistent_clients), pclient)
+	{
+		if (pclient->client == client) {
+			return pclient;
+		}
+	}
+	ZEND_HASH_FOREACH_END();
+
+	if (MONGODB_G(request_clients) == NULL) {
+		return NULL;
+	}
+
+	ZEND_HASH_FOREACH_PTR(MONGODB_G(request_clients), pclient)
+	{
+		if (pclient->client == client) {
+			return pclient;
+		}
 	}
+	ZEND_HASH_FOREACH_END();
 
 	return NULL;
 }
 
+static void php_phongo_pclient_clear_selected_servers(php_phongo_pclient_t* pclient)
+{
+	if (pclient->selected_servers) {
+		zend_hash_clean(pclient->selected_servers);
+	}
+}
+
+/* Builds the key for a cached server selection result from the operation type
+ * and all read preference fields that may affect server selection. */
+static void php_phongo_selected_server_key(smart_str* key, bool for_writes, const mongoc_read_prefs_t* read_prefs)
+{
+	int32_t mode;
+	int64_t max_staleness_seconds;
+
+	smart_str_appendc(key, for_writes ? 'w' : 'r');
+
+	if (!read_prefs) {
+		return;
+	}
+
+	mode                  = (int32_t) mongoc_read_prefs_get_mode(read_prefs);
+	max_staleness_seconds = mongoc_read_prefs_get_max_staleness_seconds(read_prefs);
+
+	smart_str_appendl(key, (const char*) &mode, sizeof(mode));
+	smart_str_appendl(key, (const char*) &max_staleness_seconds, sizeof(max_staleness_seconds));
+	smart_str_appendl(key, (const char*) bson_get_data(mongoc_read_prefs_get_tags(read_prefs)), mongoc_read_prefs_get_tags(read_prefs)->len);
+	smart_str_appendl(key, (const char*) bson_get_data(mongoc_read_prefs_get_hedge(read_prefs)), mongoc_read_prefs_get_hedge(read_prefs)->len);
+}
+
+/* Looks up a cached server selection result. Returns false if there is no
+ * result or the cache has expired. */
+bool php_phongo_pclient_find_selected_server(php_phongo_pclient_t* pclient, bool for_writes, const mongoc_read_prefs_t* read_prefs, uint32_t* server_id)
+{
+	smart_str key = { 0 };
+	zval*     entry;
+
+	if (!pclient->selected_servers || zend_hash_num_elements(pclient->selected_servers) == 0) {
+		return false;
+	}
+
+	if (bson_get_monotonic_time() >= pclient->selected_servers_expire_at) {
+		php_phongo_pclient_clear_selected_servers(pclient);
+		return false;
+	}
+
+	php_phongo_selected_server_key(&key, for_writes, read_prefs);
+	entry = zend_hash_str_find(pclient->selected_servers, ZSTR_VAL(key.s), ZSTR_LEN(key.s));
+	smart_str_free(&key);
+
+	if (!entry) {
+		return false;
+	}
+
+	*server_id = (uint32_t) Z_LVAL_P(entry);
+
+	MONGOC_DEBUG("Reusing cached selection of server %" PRIu32 " for %s", *server_id, for_writes ? "writes" : "reads");
+
+	return true;
+}
+
+/* Returns whether the selected server is the only server eligible for the
+ * operation, in which case server selection is deterministic. This is true if
+ * the topology consists of a single server or if a replica set primary was
+ * selected for a write or a primary read. Otherwise, server selection chooses
+ * randomly among the servers within the latency window and its result must not
+ * be cached. */
+static bool php_phongo_selected_server_is_only_eligible(php_phongo_pclient_t* pclient, bool for_writes, const mongoc_read_prefs_t* read_prefs, const mongoc_server_description_t* selected_server)
+{
+	mongoc_server_description_t** sds;
+	size_t                        n = 0;
+
+	if (!strcmp(mongoc_server_description_type(selected_server), "RSPrimary") && (for_writes || !read_prefs || mongoc_read_prefs_get_mode(read_prefs) == MONGOC_READ_PRIMARY)) {
+		return true;
+	}
+
+	sds = mongoc_client_get_server_descriptions(pclient->client, &n);
+	mongoc_server_descriptions_destroy_all(sds, n);
+
+	return n == 1;
+}
+
+/* Caches a server selection result if no other server was eligible. Results
+ * expire together after the client's heartbeat interval, at which point a
+ * single-threaded client would rescan the topology during server selection. */
+void php_phongo_pclient_add_selected_server(php_phongo_pclient_t* pclient, bool for_writes, const mongoc_read_prefs_t* read_prefs, const mongoc_server_description_t* selected_server)
+{
+	smart_str key = { 0 };
+	zval      entry;
+
+	/* Topology changes for pooled clients are not observed (see:
+	 * php_phongo_set_pool_monitoring_callbacks), so results cannot be cached */
+	if (pclient->pool) {
+		return;
+	}
+
+	/* Caching a random choice among several servers would pin all subsequent
+	 * operations to that server, defeating load balancing */
+	if (!php_phongo_selected_server_is_only_eligible(pclient, for_writes, read_prefs, selected_server)) {
+		return;
+	}
+
+	if (!pclient->selected_servers) {
+		pclient->selected_servers = pemalloc(sizeof(HashTable), pclient->is_persistent);
+		zend_hash_init(pclient->selected_servers, 0, NULL, NULL, pclient->is_persistent);
+	}
+
+	if (zend_hash_num_elements(pclient->selected_servers) == 0) {
+		int32_t heartbeat_frequency_ms = mongoc_uri_get_option_as_int32(mongoc_client_get_uri(pclient->client), MONGOC_URI_HEARTBEATFREQUENCYMS, PHONGO_DEFAULT_HEARTBEAT_FREQUENCY_MS);
+
+		pclient->selected_servers_expire_at = bson_get_monotonic_time() + (int64_t) heartbeat_frequency_ms * 1000;
+	}
+
+	php_phongo_selected_server_key(&key, for_writes, read_prefs);
+	ZVAL_LONG(&entry, mongoc_server_description_id(selected_server));
+	zend_hash_str_update(pclient->selected_servers, ZSTR_VAL(key.s), ZSTR_LEN(key.s), &entry);
+	smart_str_free(&key);
+
+	MONGOC_DEBUG("Caching selection of server %" PRIu32 " for %s", mongoc_server_description_id(selected_server), for_writes ? "writes" : "reads");
+}
+
+/* Returns whether server selection should fail immediately because a previous
+ * selection for the same operation type and read preference failed within the
+ * client's "circuitBreakerCooldownMS" period. If so, error is set. Breakers are
+ * kept per selection key (see: php_phongo_selected_server_key) so that, for
+ * example, an unavailable primary does not fail secondary reads. Once the
+ * period elapses, the next selection is let through as a probe, which either
+ * closes the breaker or reopens it for another period (see:
+ * php_phongo_pclient_record_selection). */
+bool php_phongo_pclient_circuit_breaker_is_open(php_phongo_pclient_t* pclient, bool for_writes, const mongoc_read_prefs_t* read_prefs, bson_error_t* error)
+{
+	smart_str key = { 0 };
+	zval*     entry;
+	int64_t   now;
+
+	if (pclient->circuit_breaker_cooldown_ms <= 0 || !pclient->circuit_breakers || zend_hash_num_elements(pclient->circuit_breakers) == 0) {
+		return false;
+	}
+
+	php_phongo_selected_server_key(&key, for_writes, read_prefs);
+	entry = zend_hash_str_find(pclient->circuit_breakers, ZSTR_VAL(key.s), ZSTR_LEN(key.s));
+	smart_str_free(&key);
+
+	if (!entry) {
+		return false;
+	}
+
+	now = bson_get_monotonic_time();
+
+	if (now >= (int64_t) Z_LVAL_P(entry)) {
+		return false;
+	}
+
+	bson_set_error(
+		error,
+		MONGOC_ERROR_SERVER_SELECTION,
+		MONGOC_ERROR_SERVER_SELECTION_FAILURE,
+		"No suitable servers found: server selection failed recently, retrying in %" PRId64 "ms",
+		((int64_t) Z_LVAL_P(entry) - now + 999) / 1000);
+
+	return true;
+}
+
+/* Opens the circuit breaker for a selection key after a failed server
+ * selection, or closes it after a successful one. */
+void php_phongo_pclient_record_selection(php_phongo_pclient_t* pclient, bool for_writes, const mongoc_read_prefs_t* read_prefs, bool success)
+{
+	smart_str key = { 0 };
+	zval      entry;
+
+	if (pclient->circuit_breaker_cooldown_ms <= 0) {
+		return;
+	}
+
+	if (success && (!pclient->circuit_breakers || zend_hash_num_elements(pclient->circuit_breakers) == 0)) {
+		return;
+	}
+
+	if (!pclient->circuit_breakers) {
+		pclient->circuit_breakers = pemalloc(sizeof(HashTable), pclient->is_persistent);
+		zend_hash_init(pclient->circuit_breakers, 0, NULL, NULL, pclient->is_persistent);
+	}
+
+	php_phongo_selected_server_key(&key, for_writes, read_prefs);
+
+	if (success) {
+		zend_hash_str_del(pclient->circuit_breakers, ZSTR_VAL(key.s), ZSTR_LEN(key.s));
+	} else {
+		ZVAL_LONG(&entry, bson_get_monotonic_time() + (int64_t) pclient->circuit_breaker_cooldown_ms * 1000);
+		zend_hash_str_update(pclient->circuit_breakers, ZSTR_VAL(key.s), ZSTR_LEN(key.s), &entry);
+	}
+
+	smart_str_free(&key);
+}
+
 #ifdef MONGOC_ENABLE_CLIENT_SIDE_ENCRYPTION
 static bool phongo_manager_set_auto_encryption_opts(php_phongo_manager_t* manager, zval* driverOptions) /* {{{ */
 {
@@ -3361,18 +5523,59 @@ void phongo_clientencryption_decrypt(php_phongo_clientencryption_t* clientencryp
 /* }}} */
 #endif
 
+/* Moves the read preference, read concern, and write concern from the URI to
+ * the Manager. The URI is reset to libmongoc's defaults, so that its client can
+ * be shared by Managers that differ only in these options. */
+static void php_phongo_manager_apply_defaults(php_phongo_manager_t* manager, mongoc_uri_t* uri) /* {{{ */
+{
+	mongoc_read_prefs_t*    read_prefs    = mongoc_read_prefs_new(MONGOC_READ_PRIMARY);
+	mongoc_read_concern_t*  read_concern  = mongoc_read_concern_new();
+	mongoc_write_concern_t* write_concern = mongoc_write_concern_new();
+
+	manager->read_prefs    = mongoc_read_prefs_copy(mongoc_uri_get_read_prefs_t(uri));
+	manager->read_concern  = mongoc_read_concern_copy(mongoc_uri_get_read_concern(uri));
+	manager->write_concern = mongoc_write_concern_copy(mongoc_uri_get_write_concern(uri));
+
+	mongoc_uri_set_read_prefs_t(uri, read_prefs);
+	mongoc_uri_set_read_concern(uri, read_concern);
+	mongoc_uri_set_write_concern(uri, write_concern);
+
+	mongoc_read_prefs_destroy(read_prefs);
+	mongoc_read_concern_destroy(read_concern);
+	mongoc_write_concern_destroy(write_concern);
+} /* }}} */
+
+/* Returns the Manager's default read preference, which is only stored on the
+ * Manager if it was specified in its URI or options */
+const mongoc_read_prefs_t* phongo_manager_get_read_prefs(php_phongo_manager_t* manager) /* {{{ */
+{
+	return manager->read_prefs ? manager->read_prefs : mongoc_client_get_read_prefs(manager->client);
+} /* }}} */
+
+/* Returns the Manager's default read concern (see: phongo_manager_get_read_prefs) */
+const mongoc_read_concern_t* phongo_manager_get_read_concern(php_phongo_manager_t* manager) /* {{{ */
+{
+	return manager->read_concern ? manager->read_concern : mongoc_client_get_read_concern(manager->client);
+} /* }}} */
+
+/* Returns the Manager's default write concern (see: phongo_manager_get_read_prefs) */
+const mongoc_write_concern_t* phongo_manager_get_write_concern(php_phongo_manager_t* manager) /* {{{ */
+{
+	return manager->write_concern ? manager->write_concern : mongoc_client_get_write_concern(manager->client);
+} /* }}} */
+
 void phongo_manager_init(php_phongo_manager_t* manager, const char* uri_string, zval* options, zval* driverOptions) /* {{{ */
 {
-	bson_t        bson_options = BSON_INITIALIZER;
-	mongoc_uri_t* uri          = NULL;
+	bson_t        bson_options    = BSON_INITIALIZER;
+	mongoc_uri_t* uri             = NULL;
+	bool          use_client_pool = false;
+	bool          has_defaults    = false;
+	int32_t       cooldown_ms     = 0;
 #ifdef MONGOC_ENABLE_SSL
 	mongoc_ssl_opt_t* ssl_opt = NULL;
 #endif
 
-	if (!(manager->client_hash = php_phongo_manager_make_client_hash(uri_string, options, driverOptions, &manager->client_hash_len))) {
-		/* Exception should already have been thrown and there is nothing to free */
-		return;
-	}
+	manager->client_hash = php_phongo_manager_make_client_hash(uri_string, options, driverOptions, &manager->client_hash_len, &has_defaults);
 
 	if (driverOptions && php_array_existsc(driverOptions, "disableClientPersistence")) {
 		manager->use_persistent_client = !php_array_fetchc_bool(driverOptions, "disableClientPersistence");
@@ -3380,9 +5583,36 @@ void phongo_manager_init(php_phongo_manager_t* manager, const char* uri_string,
 		manager->use_persistent_client = true;
 	}
 
-	if (manager->use_persistent_client && (manager->client = php_phongo_find_persistent_client(manager->client_hash, manager->client_hash_len))) {
+	if (driverOptions && php_array_fetchc_bool(driverOptions, "coalesceReads")) {
+		phongo_read_cache_init(manager);
+	}
+
+	if (driverOptions && php_array_existsc(driverOptions, "circuitBreakerCooldownMS")) {
+		zval* zcooldown = php_array_fetchc(driverOptions, "circuitBreakerCooldownMS");
+
+		if (Z_TYPE_P(zcooldown) != IS_LONG || Z_LVAL_P(zcooldown) < 0 || Z_LVAL_P(zcooldown) > INT32_MAX) {
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected \"circuitBreakerCooldownMS\" driver option to be a non-negative 32-bit integer, %s given", PHONGO_ZVAL_CLASS_OR_TYPE_NAME_P(zcooldown));
+			goto cleanup;
+		}
+
+		cooldown_ms = (int32_t) Z_LVAL_P(zcooldown);
+	}
+
+#ifdef ZTS
+	/* Auto encryption cannot be enabled for individual pooled clients, so such
+	 * Managers continue to use a persistent client for each thread */
+	use_client_pool = MONGODB_G(client_pool) && manager->use_persistent_client && !(driverOptions && php_array_existsc(driverOptions, "autoEncryption"));
+#endif
+
+	if (manager->use_persistent_client && !use_client_pool && (manager->pclient = php_phongo_find_persistent_client(manager->client_hash, manager->client_hash_len))) {
 		MONGOC_DEBUG("Found client for hash: %s", manager->client_hash);
-		goto cleanup;
+		manager->client = manager->pclient->client;
+		php_phongo_pclient_acquire(manager->pclient);
+
+		/* Default read and write options must still be parsed for the Manager */
+		if (!has_defaults) {
+			goto cleanup;
+		}
 	}
 
 	if (options) {
@@ -3407,6 +5637,15 @@ void phongo_manager_init(php_phongo_manager_t* manager, const char* uri_string,
 		goto cleanup;
 	}
 
+	if (has_defaults) {
+		php_phongo_manager_apply_defaults(manager, uri);
+	}
+
+	/* A persistent client was already found for the Manager */
+	if (manager->client) {
+		goto cleanup;
+	}
+
 #ifdef MONGOC_ENABLE_SSL
 	if (!php_phongo_apply_driver_options_to_uri(uri, driverOptions)) {
 		/* Exception should already have been thrown */
@@ -3431,6 +5670,17 @@ void phongo_manager_init(php_phongo_manager_t* manager, const char* uri_string,
 	}
 #endif
 
+#ifdef ZTS
+	if (use_client_pool) {
+#ifdef MONGOC_ENABLE_SSL
+		php_phongo_pop_pooled_client(manager, uri, ssl_opt, driverOptions);
+#else
+		php_phongo_pop_pooled_client(manager, uri, NULL, driverOptions);
+#endif
+		goto cleanup;
+	}
+#endif
+
 	manager->client = php_phongo_make_mongo_client(uri, driverOptions);
 	mongoc_client_set_error_api(manager->client, MONGOC_ERROR_API_VERSION_2);
 
@@ -3462,6 +5712,12 @@ void phongo_manager_init(php_phongo_manager_t* manager, const char* uri_string,
 	}
 
 cleanup:
+	/* Managers sharing a client have identical driver options, so this only
+	 * changes the circuit breaker of a newly created client */
+	if (manager->pclient) {
+		manager->pclient->circuit_breaker_cooldown_ms = cooldown_ms;
+	}
+
 	bson_destroy(&bson_options);
 
 	if (uri) {
@@ -3584,9 +5840,87 @@ ZEND_INI_MH(OnUpdateDebug)
 /* {{{ INI entries */
 PHP_INI_BEGIN()
 	STD_PHP_INI_ENTRY(PHONGO_DEBUG_INI, PHONGO_DEBUG_INI_DEFAULT, PHP_INI_ALL, OnUpdateDebug, debug, zend_mongodb_globals, mongodb_globals)
+	STD_PHP_INI_ENTRY(PHONGO_PRECONNECT_INI, PHONGO_PRECONNECT_INI_DEFAULT, PHP_INI_SYSTEM, OnUpdateString, preconnect, zend_mongodb_globals, mongodb_globals)
+	STD_PHP_INI_BOOLEAN(PHONGO_PRECONNECT_PING_INI, PHONGO_PRECONNECT_PING_INI_DEFAULT, PHP_INI_SYSTEM, OnUpdateBool, preconnect_ping, zend_mongodb_globals, mongodb_globals)
+	STD_PHP_INI_ENTRY(PHONGO_MAX_PERSISTENT_CLIENTS_INI, PHONGO_MAX_PERSISTENT_CLIENTS_INI_DEFAULT, PHP_INI_SYSTEM, OnUpdateLong, max_persistent_clients, zend_mongodb_globals, mongodb_globals)
+	STD_PHP_INI_ENTRY(PHONGO_PERSISTENT_CLIENT_IDLE_TIMEOUT_INI, PHONGO_PERSISTENT_CLIENT_IDLE_TIMEOUT_INI_DEFAULT, PHP_INI_SYSTEM, OnUpdateLong, persistent_client_idle_timeout, zend_mongodb_globals, mongodb_globals)
+#ifdef ZTS
+	STD_PHP_INI_BOOLEAN(PHONGO_CLIENT_POOL_INI, PHONGO_CLIENT_POOL_INI_DEFAULT, PHP_INI_SYSTEM, OnUpdateBool, client_pool, zend_mongodb_globals, mongodb_globals)
+#endif
 PHP_INI_END()
 /* }}} */
 
+/* Creates persistent clients for the whitespace-separated URIs in the
+ * "mongodb.preconnect" INI setting. A Manager later constructed with an
+ * identical URI string and no options will find the existing client.
+ *
+ * If "mongodb.preconnect_ping" is enabled, each client also pings the
+ * deployment so that it has already discovered the topology and authenticated
+ * a connection. The ping is subject to the URI's own timeouts, so an
+ * unreachable deployment delays the first request of each worker by up to
+ * connectTimeoutMS (or serverSelectionTimeoutMS if serverSelectionTryOnce is
+ * disabled) per URI. The ping is therefore disabled by default.
+ *
+ * This is done once per process during its first request, since clients
+ * created before a fork (e.g. in MINIT of a PHP-FPM master) would need to be
+ * reset in each child anyway. Since RINIT should not throw, errors are only
+ * logged. */
+static void php_phongo_preconnect(void)
+{
+	char* uris;
+	char* uri_string;
+	char* last = NULL;
+	int   pid  = (int) getpid();
+
+	if (!MONGODB_G(preconnect) || !*MONGODB_G(preconnect) || MONGODB_G(preconnected_by_pid) == pid) {
+		return;
+	}
+
+	MONGODB_G(preconnected_by_pid) = pid;
+
+	uris = estrdup(MONGODB_G(preconnect));
+
+	for (uri_string = php_strtok_r(uris, " \t\r\n", &last); uri_string; uri_string = php_strtok_r(NULL, " \t\r\n", &last)) {
+		zval                  zmanager;
+		php_phongo_manager_t* manager;
+		bson_t                ping  = BSON_INITIALIZER;
+		bson_error_t          error = { 0 };
+
+		object_init_ex(&zmanager, php_phongo_manager_ce);
+		manager = Z_MANAGER_OBJ_P(&zmanager);
+
+		phongo_manager_init(manager, uri_string, NULL, NULL);
+
+		if (EG(exception)) {
+			MONGOC_WARNING("Could not create client for %s", PHONGO_PRECONNECT_INI);
+			zend_clear_exception();
+			goto next;
+		}
+
+		if (!MONGODB_G(preconnect_ping)) {
+			goto next;
+		}
+
+		BSON_APPEND_INT32(&ping, "ping", 1);
+
+		if (!mongoc_client_command_simple(manager->client, "admin", &ping, phongo_manager_get_read_prefs(manager), NULL, &error)) {
+			MONGOC_WARNING("Could not connect client for %s: %s", PHONGO_PRECONNECT_INI, error.message);
+		}
+
+	next:
+		bson_destroy(&ping);
+		zval_ptr_dtor(&zmanager);
+	}
+
+	efree(uris);
+}
+
+/* Resetting a client only discards its sessions and invalidates connections
+ * inherited from the parent process. The topology description is preserved, so
+ * cached server selection results also remain valid until they expire. This
+ * allows a forked child to select a server without rescanning the topology and
+ * only open new connections. If a selected server turns out to be unavailable,
+ * the resulting topology change clears the cache. */
 static void phongo_pclient_reset_once(php_phongo_pclient_t* pclient, int pid)
 {
 	if (pclient->last_reset_by_pid != pid) {
@@ -3638,7 +5972,10 @@ static void php_phongo_pclient_destroy(php_phongo_pclient_t* pclient)
 	 * clients. For a request-scoped client, we are either in the Manager's
 	 * free_object handler or RSHUTDOWN, but there the application is capable of
 	 * freeing its Manager and its client before forking. */
-	if (pclient->created_by_pid == getpid()) {
+	if (pclient->created_by_pid == getpid() && pclient->pool) {
+		/* APM callbacks are owned by the pool and cannot be changed */
+		mongoc_client_pool_push(pclient->pool, pclient->client);
+	} else if (pclient->created_by_pid == getpid()) {
 		/* Single-threaded clients may run commands (e.g. endSessions) from
 		 * mongoc_client_destroy, so disable APM to ensure an event is not
 		 * dispatched while destroying the Manager and its client. This means
@@ -3652,6 +5989,23 @@ static void php_phongo_pclient_destroy(php_phongo_pclient_t* pclient)
 		mongoc_client_destroy(pclient->client);
 	}
 
+	if (pclient->selected_servers) {
+		zend_hash_destroy(pclient->selected_servers);
+		pefree(pclient->selected_servers, pclient->is_persistent);
+	}
+
+	if (pclient->circuit_breakers) {
+		zend_hash_destroy(pclient->circuit_breakers);
+		pefree(pclient->circuit_breakers, pclient->is_persistent);
+	}
+
+	/* Allow the keyVaultClient to be evicted once no client depends on it. In
+	 * GSHUTDOWN, clients are destroyed in reverse order, so the keyVaultClient
+	 * has not yet been destroyed. */
+	if (pclient->key_vault_pclient) {
+		php_phongo_pclient_release(pclient->key_vault_pclient);
+	}
+
 	/* Persistent and request-scoped clients use different memory allocation */
 	pefree(pclient, pclient->is_persistent);
 }
@@ -3755,6 +6109,15 @@ PHP_RINIT_FUNCTION(mongodb)
 		zend_hash_init(MONGODB_G(managers), 0, NULL, NULL, 0);
 	}
 
+	/* Initialize HashTable for deferred writes, which is initialized to NULL in
+	 * GINIT and flushed, destroyed, and reset to NULL in RSHUTDOWN. */
+	if (MONGODB_G(deferred_writes) == NULL) {
+		ALLOC_HASHTABLE(MONGODB_G(deferred_writes));
+		zend_hash_init(MONGODB_G(deferred_writes), 0, NULL, php_phongo_deferred_write_destroy_ptr, 0);
+	}
+
+	php_phongo_preconnect();
+
 	return SUCCESS;
 }
 /* }}} */
@@ -3820,6 +6183,13 @@ PHP_MINIT_FUNCTION(mongodb)
 	bson_mem_set_vtable(&bson_mem_vtable);
 	mongoc_init();
 
+#ifdef ZTS
+	/* Initialize the process-wide registry of client pools, which is destroyed
+	 * in MSHUTDOWN. Pools are only created if "mongodb.client_pool" is enabled. */
+	zend_hash_init(&phongo_client_pools, 0, NULL, php_phongo_client_pool_destroy_ptr, 1);
+	phongo_client_pools_mutex = tsrm_mutex_alloc();
+#endif
+
 	/* Prep default object handlers to be used when we register the classes */
 	memcpy(&phongo_std_object_handlers, zend_get_std_object_handlers(), sizeof(zend_object_handlers));
 	/* Disable cloning by default. Individual classes can opt in if they need to
@@ -3881,14 +6251,18 @@ PHP_MINIT_FUNCTION(mongodb)
 	php_phongo_cursor_interface_init_ce(INIT_FUNC_ARGS_PASSTHRU);
 
 	php_phongo_bulkwrite_init_ce(INIT_FUNC_ARGS_PASSTHRU);
+	php_phongo_clientbulkwrite_init_ce(INIT_FUNC_ARGS_PASSTHRU);
 	php_phongo_clientencryption_init_ce(INIT_FUNC_ARGS_PASSTHRU);
 	php_phongo_command_init_ce(INIT_FUNC_ARGS_PASSTHRU);
 	php_phongo_cursor_init_ce(INIT_FUNC_ARGS_PASSTHRU);
 	php_phongo_cursorid_init_ce(INIT_FUNC_ARGS_PASSTHRU);
 	php_phongo_manager_init_ce(INIT_FUNC_ARGS_PASSTHRU);
+	php_phongo_mergedcursor_init_ce(INIT_FUNC_ARGS_PASSTHRU);
+	php_phongo_preparedoperation_init_ce(INIT_FUNC_ARGS_PASSTHRU);
 	php_phongo_query_init_ce(INIT_FUNC_ARGS_PASSTHRU);
 	php_phongo_readconcern_init_ce(INIT_FUNC_ARGS_PASSTHRU);
 	php_phongo_readpreference_init_ce(INIT_FUNC_ARGS_PASSTHRU);
+	php_phongo_resultset_init_ce(INIT_FUNC_ARGS_PASSTHRU);
 	php_phongo_server_init_ce(INIT_FUNC_ARGS_PASSTHRU);
 	php_phongo_session_init_ce(INIT_FUNC_ARGS_PASSTHRU);
 	php_phongo_writeconcern_init_ce(INIT_FUNC_ARGS_PASSTHRU);
@@ -3931,6 +6305,13 @@ PHP_MINIT_FUNCTION(mongodb)
 /* {{{ PHP_MSHUTDOWN_FUNCTION */
 PHP_MSHUTDOWN_FUNCTION(mongodb)
 {
+#ifdef ZTS
+	/* All pooled clients have been pushed back to their pools by now, since
+	 * they are tracked in the request registry destroyed in RSHUTDOWN. */
+	zend_hash_destroy(&phongo_client_pools);
+	tsrm_mutex_free(phongo_client_pools_mutex);
+#endif
+
 	UNREGISTER_INI_ENTRIES();
 
 	return SUCCESS;
@@ -3947,6 +6328,18 @@ PHP_RSHUTDOWN_FUNCTION(mongodb)
 		MONGODB_G(subscribers) = NULL;
 	}
 
+	/* Execute any deferred writes before destroying their HashTable, which was
+	 * initialized in RINIT. This is done after the APM subscribers have been
+	 * freed so that no userland code is invoked, but before non-persistent
+	 * clients are destroyed, since deferred writes hold a reference to their
+	 * Manager. */
+	if (MONGODB_G(deferred_writes)) {
+		phongo_flush_deferred_writes(NULL);
+		zend_hash_destroy(MONGODB_G(deferred_writes));
+		FREE_HASHTABLE(MONGODB_G(deferred_writes));
+		MONGODB_G(deferred_writes) = NULL;
+	}
+
 	/* Destroy HashTable for non-persistent clients, which was initialized in
 	 * RINIT. This is intentionally done after the APM subscribers to allow any
 	 * non-persistent clients still referenced by a subscriber (not freed prior
@@ -3960,6 +6353,14 @@ PHP_RSHUTDOWN_FUNCTION(mongodb)
 		MONGODB_G(request_clients) = NULL;
 	}
 
+	/* Reap idle persistent clients at the end of each request, since a worker
+	 * may otherwise accumulate clients for URIs it no longer uses. */
+	php_phongo_evict_persistent_clients();
+
+	/* Drop coalesced results while Managers can still be found through their
+	 * registry, since any Managers still referenced are freed later. */
+	phongo_read_cache_clear_all();
+
 	/* Destroy HashTable for Managers, which was initialized in RINIT. */
 	if (MONGODB_G(managers)) {
 		zend_hash_destroy(MONGODB_G(managers));
@@ -3979,6 +6380,11 @@ PHP_GSHUTDOWN_FUNCTION(mongodb)
 	 * encryption settings. */
 	zend_hash_graceful_reverse_destroy(&mongodb_globals->persistent_clients);
 
+	if (mongodb_globals->last_client_hash_uri) {
+		pefree(mongodb_globals->last_client_hash_uri, 1);
+		mongodb_globals->last_client_hash_uri = NULL;
+	}
+
 	mongodb_globals->debug = NULL;
 	if (mongodb_globals->debug_fd) {
 		fclose(mongodb_globals->debug_fd);
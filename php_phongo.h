@@ -31,21 +31,59 @@ extern zend_module_entry mongodb_module_entry;
 /* Structure for tracking libmongoc clients (both persisted and non-persisted).
  * The PID is included to ensure that processes do not destroy clients created
  * by other processes (relevant for forking). We avoid using pid_t for Windows
- * compatibility. */
-typedef struct {
-	mongoc_client_t* client;
-	int              created_by_pid;
-	int              last_reset_by_pid;
-	bool             is_persistent;
+ * compatibility.
+ *
+ * Server selection results are cached per client until the topology changes or
+ * the heartbeat interval elapses (see: php_phongo_manager_select_server). Only
+ * deterministic results, where a single server was eligible, are cached. The
+ * cache is retained when a forked child resets the client.
+ *
+ * Clients popped from a process-wide pool (see: mongodb.client_pool) reference
+ * their pool so that they can be pushed back when their Manager is freed.
+ *
+ * Persistent clients count references from Managers and from clients using
+ * them as a keyVaultClient, and only unreferenced clients may be evicted (see:
+ * mongodb.max_persistent_clients and mongodb.persistent_client_idle_timeout).
+ *
+ * If the "circuitBreakerCooldownMS" driver option is set, a failed server
+ * selection causes further selections with the same operation type and read
+ * preference to fail immediately until the cool-down period elapses, including
+ * in subsequent requests using the same client. */
+typedef struct _php_phongo_pclient_t {
+	mongoc_client_t*              client;
+	int                           created_by_pid;
+	int                           last_reset_by_pid;
+	bool                          is_persistent;
+	HashTable*                    selected_servers;
+	int64_t                       selected_servers_expire_at;
+	mongoc_client_pool_t*         pool;
+	uint32_t                      references;
+	int64_t                       last_used_at;
+	struct _php_phongo_pclient_t* key_vault_pclient;
+	int32_t                       circuit_breaker_cooldown_ms;
+	HashTable*                    circuit_breakers;
 } php_phongo_pclient_t;
 
+/* Length of the hexadecimal MD5 digest used to identify persistent clients */
+#define PHONGO_CLIENT_HASH_LEN 32
+
 ZEND_BEGIN_MODULE_GLOBALS(mongodb)
 	char*             debug;
 	FILE*             debug_fd;
+	char*             preconnect;
+	zend_bool         preconnect_ping;
+	zend_bool         client_pool;
+	zend_long         max_persistent_clients;
+	zend_long         persistent_client_idle_timeout;
+	int               preconnected_by_pid;
 	HashTable         persistent_clients;
 	HashTable*        request_clients;
 	HashTable*        subscribers;
 	HashTable*        managers;
+	HashTable*        deferred_writes;
+	char*             last_client_hash_uri;
+	zend_long         last_client_hash_pid;
+	char              last_client_hash[PHONGO_CLIENT_HASH_LEN + 1];
 ZEND_END_MODULE_GLOBALS(mongodb)
 
 #define MONGODB_G(v) ZEND_MODULE_GLOBALS_ACCESSOR(mongodb, v)
@@ -119,18 +157,48 @@ void phongo_session_init(zval* return_value, zval* manager, mongoc_client_sessio
 void phongo_readconcern_init(zval* return_value, const mongoc_read_concern_t* read_concern);
 void phongo_readpreference_init(zval* return_value, const mongoc_read_prefs_t* read_prefs);
 void phongo_writeconcern_init(zval* return_value, const mongoc_write_concern_t* write_concern);
+bool phongo_bulk_write_flush(php_phongo_bulkwrite_t* bulk_write);
+void phongo_bulk_write_result_init(phongo_bulk_write_result_t* result);
+void phongo_bulk_write_result_destroy(phongo_bulk_write_result_t* result);
+bool phongo_defer_bulk_write(zval* manager, const char* namespace, zval* zbulk);
+void phongo_flush_deferred_writes(zval* manager);
 bool phongo_execute_bulk_write(zval* manager, const char* namespace, php_phongo_bulkwrite_t* bulk_write, zval* zwriteConcern, uint32_t server_id, zval* return_value);
+bool phongo_execute_client_bulk_write(zval* manager, php_phongo_clientbulkwrite_t* bulk_write, zval* options, uint32_t server_id, zval* return_value);
 bool phongo_execute_command(zval* manager, php_phongo_command_type_t type, const char* db, zval* zcommand, zval* zreadPreference, uint32_t server_id, zval* return_value);
 bool phongo_execute_query(zval* manager, const char* namespace, zval* zquery, zval* zreadPreference, uint32_t server_id, zval* return_value);
 
+bool phongo_command_prepare(zval* manager, php_phongo_command_type_t type, zval* options, bson_t* opts, zval** zreadPreference, bool* is_unacknowledged_write_concern);
+bool phongo_execute_command_with_opts(zval* manager, php_phongo_command_type_t type, const char* db, zval* zcommand, bson_t* opts, zval* zreadPreference, zval* zsession, bool is_unacknowledged_write_concern, uint32_t server_id, zval* return_value);
+bool phongo_query_prepare(zval* manager, const char* namespace, zval* zquery, mongoc_collection_t** collection, bson_t* opts);
+bool phongo_execute_query_with_opts(zval* manager, const char* namespace, zval* zquery, mongoc_collection_t* collection, bson_t* opts, zval* zreadPreference, zval* zsession, uint32_t server_id, zval* return_value);
+
+/* Number of _id values sampled per partition when computing split points for
+ * Manager::executeParallelScan() */
+#define PHONGO_PARALLEL_SCAN_SAMPLES_PER_PARTITION 16
+#define PHONGO_PARALLEL_SCAN_MAX_PARTITIONS 1024
+
+void phongo_query_init_with_filter(zval* return_value, zval* zquery, const bson_t* filter);
+bool phongo_query_get_split_points(zval* manager, const char* namespace, zval* zquery, zval* zreadPreference, zval* zsession, uint32_t server_id, zend_long partitions, bson_t* split_points);
+
 bool phongo_cursor_advance_and_check_for_error(mongoc_cursor_t* cursor);
 
+typedef bool (*php_phongo_cursor_raw_visitor_t)(const bson_t* doc, void* data);
+bool php_phongo_cursor_raw_start(php_phongo_cursor_t* intern, const bson_t** doc);
+bool php_phongo_cursor_raw_next(php_phongo_cursor_t* intern, const bson_t** doc);
+bool php_phongo_cursor_visit_raw(php_phongo_cursor_t* intern, php_phongo_cursor_raw_visitor_t visitor, void* data);
+
+bool phongo_resultset_init(zval* return_value, php_phongo_cursor_t* cursor);
+
+bool phongo_preparedoperation_init_for_command(zval* return_value, zval* manager, const char* db, zval* zcommand, zval* options);
+bool phongo_preparedoperation_init_for_query(zval* return_value, zval* manager, const char* namespace, zval* zquery, zval* options);
+
 const mongoc_read_concern_t*  phongo_read_concern_from_zval(zval* zread_concern);
 const mongoc_read_prefs_t*    phongo_read_preference_from_zval(zval* zread_preference);
 const mongoc_write_concern_t* phongo_write_concern_from_zval(zval* zwrite_concern);
 
 php_phongo_server_description_type_t php_phongo_server_description_type(mongoc_server_description_t* sd);
 
+bool phongo_split_namespace(const char* namespace, char** dbname, char** cname);
 bool phongo_parse_read_preference(zval* options, zval** zreadPreference);
 bool phongo_parse_session(zval* options, mongoc_client_t* client, bson_t* mongoc_opts, zval** zsession);
 
@@ -146,6 +214,10 @@ void php_phongo_write_concern_to_zval(zval* retval, const mongoc_write_concern_t
 void php_phongo_cursor_to_zval(zval* retval, const mongoc_cursor_t* cursor);
 
 void phongo_manager_init(php_phongo_manager_t* manager, const char* uri_string, zval* options, zval* driverOptions);
+const mongoc_read_prefs_t* phongo_manager_get_read_prefs(php_phongo_manager_t* manager);
+const mongoc_read_concern_t* phongo_manager_get_read_concern(php_phongo_manager_t* manager);
+const mongoc_write_concern_t* phongo_manager_get_write_concern(php_phongo_manager_t* manager);
+bool php_phongo_manager_select_server(bool for_writes, bool inherit_read_preference, zval* zreadPreference, zval* zsession, php_phongo_manager_t* manager, uint32_t* server_id);
 bool php_phongo_set_monitoring_callbacks(mongoc_client_t* client);
 
 bool php_phongo_parse_int64(int64_t* retval, const char* data, size_t data_len);
@@ -160,8 +232,15 @@ zend_bool phongo_writeconcernerror_init(zval* return_value, bson_t* bson);
 void php_phongo_client_reset_once(php_phongo_manager_t* manager, int pid);
 
 bool php_phongo_client_register(php_phongo_manager_t* manager);
+void php_phongo_pclient_acquire(php_phongo_pclient_t* pclient);
+void php_phongo_pclient_release(php_phongo_pclient_t* pclient);
 bool php_phongo_client_unregister(php_phongo_manager_t* manager);
 
+bool php_phongo_pclient_find_selected_server(php_phongo_pclient_t* pclient, bool for_writes, const mongoc_read_prefs_t* read_prefs, uint32_t* server_id);
+bool php_phongo_pclient_circuit_breaker_is_open(php_phongo_pclient_t* pclient, bool for_writes, const mongoc_read_prefs_t* read_prefs, bson_error_t* error);
+void php_phongo_pclient_record_selection(php_phongo_pclient_t* pclient, bool for_writes, const mongoc_read_prefs_t* read_prefs, bool success);
+void php_phongo_pclient_add_selected_server(php_phongo_pclient_t* pclient, bool for_writes, const mongoc_read_prefs_t* read_prefs, const mongoc_server_description_t* selected_server);
+
 bool php_phongo_manager_register(php_phongo_manager_t* manager);
 bool php_phongo_manager_unregister(php_phongo_manager_t* manager);
 
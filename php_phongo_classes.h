@@ -27,6 +27,10 @@ static inline php_phongo_bulkwrite_t* php_bulkwrite_fetch_object(zend_object* ob
 {
 	return (php_phongo_bulkwrite_t*) ((char*) obj - XtOffsetOf(php_phongo_bulkwrite_t, std));
 }
+static inline php_phongo_clientbulkwrite_t* php_clientbulkwrite_fetch_object(zend_object* obj)
+{
+	return (php_phongo_clientbulkwrite_t*) ((char*) obj - XtOffsetOf(php_phongo_clientbulkwrite_t, std));
+}
 static inline php_phongo_clientencryption_t* php_clientencryption_fetch_object(zend_object* obj)
 {
 	return (php_phongo_clientencryption_t*) ((char*) obj - XtOffsetOf(php_phongo_clientencryption_t, std));
@@ -47,6 +51,14 @@ static inline php_phongo_manager_t* php_manager_fetch_object(zend_object* obj)
 {
 	return (php_phongo_manager_t*) ((char*) obj - XtOffsetOf(php_phongo_manager_t, std));
 }
+static inline php_phongo_mergedcursor_t* php_mergedcursor_fetch_object(zend_object* obj)
+{
+	return (php_phongo_mergedcursor_t*) ((char*) obj - XtOffsetOf(php_phongo_mergedcursor_t, std));
+}
+static inline php_phongo_preparedoperation_t* php_preparedoperation_fetch_object(zend_object* obj)
+{
+	return (php_phongo_preparedoperation_t*) ((char*) obj - XtOffsetOf(php_phongo_preparedoperation_t, std));
+}
 static inline php_phongo_query_t* php_query_fetch_object(zend_object* obj)
 {
 	return (php_phongo_query_t*) ((char*) obj - XtOffsetOf(php_phongo_query_t, std));
@@ -59,6 +71,10 @@ static inline php_phongo_readpreference_t* php_readpreference_fetch_object(zend_
 {
 	return (php_phongo_readpreference_t*) ((char*) obj - XtOffsetOf(php_phongo_readpreference_t, std));
 }
+static inline php_phongo_resultset_t* php_resultset_fetch_object(zend_object* obj)
+{
+	return (php_phongo_resultset_t*) ((char*) obj - XtOffsetOf(php_phongo_resultset_t, std));
+}
 static inline php_phongo_server_t* php_server_fetch_object(zend_object* obj)
 {
 	return (php_phongo_server_t*) ((char*) obj - XtOffsetOf(php_phongo_server_t, std));
@@ -148,14 +164,18 @@ static inline php_phongo_commandsucceededevent_t* php_commandsucceededevent_fetc
 	return (php_phongo_commandsucceededevent_t*) ((char*) obj - XtOffsetOf(php_phongo_commandsucceededevent_t, std));
 }
 
+#define Z_CLIENTBULKWRITE_OBJ_P(zv) (php_clientbulkwrite_fetch_object(Z_OBJ_P(zv)))
 #define Z_CLIENTENCRYPTION_OBJ_P(zv) (php_clientencryption_fetch_object(Z_OBJ_P(zv)))
 #define Z_COMMAND_OBJ_P(zv) (php_command_fetch_object(Z_OBJ_P(zv)))
 #define Z_CURSOR_OBJ_P(zv) (php_cursor_fetch_object(Z_OBJ_P(zv)))
 #define Z_CURSORID_OBJ_P(zv) (php_cursorid_fetch_object(Z_OBJ_P(zv)))
 #define Z_MANAGER_OBJ_P(zv) (php_manager_fetch_object(Z_OBJ_P(zv)))
+#define Z_MERGEDCURSOR_OBJ_P(zv) (php_mergedcursor_fetch_object(Z_OBJ_P(zv)))
+#define Z_PREPAREDOPERATION_OBJ_P(zv) (php_preparedoperation_fetch_object(Z_OBJ_P(zv)))
 #define Z_QUERY_OBJ_P(zv) (php_query_fetch_object(Z_OBJ_P(zv)))
 #define Z_READCONCERN_OBJ_P(zv) (php_readconcern_fetch_object(Z_OBJ_P(zv)))
 #define Z_READPREFERENCE_OBJ_P(zv) (php_readpreference_fetch_object(Z_OBJ_P(zv)))
+#define Z_RESULTSET_OBJ_P(zv) (php_resultset_fetch_object(Z_OBJ_P(zv)))
 #define Z_SERVER_OBJ_P(zv) (php_server_fetch_object(Z_OBJ_P(zv)))
 #define Z_SESSION_OBJ_P(zv) (php_session_fetch_object(Z_OBJ_P(zv)))
 #define Z_BULKWRITE_OBJ_P(zv) (php_bulkwrite_fetch_object(Z_OBJ_P(zv)))
@@ -180,14 +200,18 @@ static inline php_phongo_commandsucceededevent_t* php_commandsucceededevent_fetc
 #define Z_COMMANDSTARTEDEVENT_OBJ_P(zv) (php_commandstartedevent_fetch_object(Z_OBJ_P(zv)))
 #define Z_COMMANDSUCCEEDEDEVENT_OBJ_P(zv) (php_commandsucceededevent_fetch_object(Z_OBJ_P(zv)))
 
+#define Z_OBJ_CLIENTBULKWRITE(zo) (php_clientbulkwrite_fetch_object(zo))
 #define Z_OBJ_CLIENTENCRYPTION(zo) (php_clientencryption_fetch_object(zo))
 #define Z_OBJ_COMMAND(zo) (php_command_fetch_object(zo))
 #define Z_OBJ_CURSOR(zo) (php_cursor_fetch_object(zo))
 #define Z_OBJ_CURSORID(zo) (php_cursorid_fetch_object(zo))
 #define Z_OBJ_MANAGER(zo) (php_manager_fetch_object(zo))
+#define Z_OBJ_MERGEDCURSOR(zo) (php_mergedcursor_fetch_object(zo))
+#define Z_OBJ_PREPAREDOPERATION(zo) (php_preparedoperation_fetch_object(zo))
 #define Z_OBJ_QUERY(zo) (php_query_fetch_object(zo))
 #define Z_OBJ_READCONCERN(zo) (php_readconcern_fetch_object(zo))
 #define Z_OBJ_READPREFERENCE(zo) (php_readpreference_fetch_object(zo))
+#define Z_OBJ_RESULTSET(zo) (php_resultset_fetch_object(zo))
 #define Z_OBJ_SERVER(zo) (php_server_fetch_object(zo))
 #define Z_OBJ_SESSION(zo) (php_session_fetch_object(zo))
 #define Z_OBJ_BULKWRITE(zo) (php_bulkwrite_fetch_object(zo))
@@ -212,14 +236,18 @@ static inline php_phongo_commandsucceededevent_t* php_commandsucceededevent_fetc
 #define Z_OBJ_COMMANDSTARTEDEVENT(zo) (php_commandstartedevent_fetch_object(zo))
 #define Z_OBJ_COMMANDSUCCEEDEDEVENT(zo) (php_commandsucceededevent_fetch_object(zo))
 
+extern zend_class_entry* php_phongo_clientbulkwrite_ce;
 extern zend_class_entry* php_phongo_clientencryption_ce;
 extern zend_class_entry* php_phongo_command_ce;
 extern zend_class_entry* php_phongo_cursor_ce;
 extern zend_class_entry* php_phongo_cursorid_ce;
 extern zend_class_entry* php_phongo_manager_ce;
+extern zend_class_entry* php_phongo_mergedcursor_ce;
+extern zend_class_entry* php_phongo_preparedoperation_ce;
 extern zend_class_entry* php_phongo_query_ce;
 extern zend_class_entry* php_phongo_readconcern_ce;
 extern zend_class_entry* php_phongo_readpreference_ce;
+extern zend_class_entry* php_phongo_resultset_ce;
 extern zend_class_entry* php_phongo_server_ce;
 extern zend_class_entry* php_phongo_session_ce;
 extern zend_class_entry* php_phongo_bulkwrite_ce;
@@ -309,14 +337,18 @@ extern void php_phongo_timestamp_interface_init_ce(INIT_FUNC_ARGS);
 extern void php_phongo_utcdatetime_interface_init_ce(INIT_FUNC_ARGS);
 
 extern void php_phongo_bulkwrite_init_ce(INIT_FUNC_ARGS);
+extern void php_phongo_clientbulkwrite_init_ce(INIT_FUNC_ARGS);
 extern void php_phongo_clientencryption_init_ce(INIT_FUNC_ARGS);
 extern void php_phongo_command_init_ce(INIT_FUNC_ARGS);
 extern void php_phongo_cursor_init_ce(INIT_FUNC_ARGS);
 extern void php_phongo_cursorid_init_ce(INIT_FUNC_ARGS);
 extern void php_phongo_manager_init_ce(INIT_FUNC_ARGS);
+extern void php_phongo_mergedcursor_init_ce(INIT_FUNC_ARGS);
+extern void php_phongo_preparedoperation_init_ce(INIT_FUNC_ARGS);
 extern void php_phongo_query_init_ce(INIT_FUNC_ARGS);
 extern void php_phongo_readconcern_init_ce(INIT_FUNC_ARGS);
 extern void php_phongo_readpreference_init_ce(INIT_FUNC_ARGS);
+extern void php_phongo_resultset_init_ce(INIT_FUNC_ARGS);
 extern void php_phongo_server_init_ce(INIT_FUNC_ARGS);
 extern void php_phongo_session_init_ce(INIT_FUNC_ARGS);
 extern void php_phongo_writeconcern_init_ce(INIT_FUNC_ARGS);
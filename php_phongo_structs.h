@@ -21,18 +21,74 @@
 
 #include "php_bson.h"
 
+/* Accumulates the results of one or more bulk writes in the reply format of
+ * mongoc_bulk_operation_execute(), so that they can be reported through a
+ * single WriteResult. */
 typedef struct {
-	mongoc_bulk_operation_t* bulk;
-	size_t                   num_ops;
-	bool                     ordered;
-	int                      bypass;
-	char*                    database;
-	char*                    collection;
-	bool                     executed;
-	zval                     session;
-	zend_object              std;
+	int32_t  n_inserted;
+	int32_t  n_matched;
+	int32_t  n_modified;
+	int32_t  n_removed;
+	int32_t  n_upserted;
+	bson_t   upserted;
+	uint32_t upserted_len;
+	bson_t   write_errors;
+	uint32_t write_errors_len;
+	bson_t   write_concern_errors;
+	uint32_t write_concern_errors_len;
+} phongo_bulk_write_result_t;
+
+typedef struct {
+	mongoc_bulk_operation_t*    bulk;
+	size_t                      num_ops;
+	bool                        ordered;
+	int                         bypass;
+	char*                       database;
+	char*                       collection;
+	bool                        executed;
+	zval                        session;
+	zval                        manager;
+	zval                        write_concern;
+	size_t                      flush_bytes;
+	size_t                      flush_ops;
+	size_t                      buffered_bytes;
+	size_t                      buffered_ops;
+	phongo_bulk_write_result_t* flushed;
+	bson_t*                     flush_error_reply;
+	zend_object                 std;
 } php_phongo_bulkwrite_t;
 
+typedef enum {
+	PHONGO_CLIENTBULKWRITE_INSERT,
+	PHONGO_CLIENTBULKWRITE_UPDATE_ONE,
+	PHONGO_CLIENTBULKWRITE_UPDATE_MANY,
+	PHONGO_CLIENTBULKWRITE_REPLACE_ONE,
+	PHONGO_CLIENTBULKWRITE_DELETE_ONE,
+	PHONGO_CLIENTBULKWRITE_DELETE_MANY,
+} php_phongo_clientbulkwrite_op_type_t;
+
+/* For insert operations, document is the document to insert and update is
+ * NULL. For all other operations, document is the query filter. The options
+ * are in the format accepted by mongoc_bulk_operation_t. */
+typedef struct {
+	php_phongo_clientbulkwrite_op_type_t type;
+	char*                                namespace;
+	bson_t*                              document;
+	bson_t*                              update;
+	bson_t*                              opts;
+} php_phongo_clientbulkwrite_op_t;
+
+typedef struct {
+	php_phongo_clientbulkwrite_op_t* ops;
+	size_t                           num_ops;
+	size_t                           ops_size;
+	bool                             ordered;
+	int                              bypass;
+	bool                             executed;
+	zval                             session;
+	zend_object                      std;
+} php_phongo_clientbulkwrite_t;
+
 typedef struct {
 	mongoc_client_encryption_t* client_encryption;
 	zval                        key_vault_client_manager;
@@ -69,15 +125,38 @@ typedef struct {
 } php_phongo_cursorid_t;
 
 typedef struct {
-	mongoc_client_t* client;
-	int              created_by_pid;
-	char*            client_hash;
-	size_t           client_hash_len;
-	bool             use_persistent_client;
-	zval             key_vault_client_manager;
-	zend_object      std;
+	mongoc_client_t*              client;
+	struct _php_phongo_pclient_t* pclient;
+	int                           created_by_pid;
+	char*                         client_hash;
+	size_t                        client_hash_len;
+	bool                          use_persistent_client;
+	zval                          key_vault_client_manager;
+	HashTable*                    read_cache;
+	size_t                        read_cache_size;
+	mongoc_read_prefs_t*          read_prefs;
+	mongoc_read_concern_t*        read_concern;
+	mongoc_write_concern_t*       write_concern;
+	zend_object                   std;
 } php_phongo_manager_t;
 
+typedef struct {
+	zval*                 cursors;
+	uint32_t              cursors_count;
+	bson_t**              heads;
+	bson_value_t*         keys;
+	uint32_t*             heap;
+	uint32_t              heap_size;
+	char**                sort_fields;
+	int*                  sort_directions;
+	uint32_t              sort_count;
+	zval                  sort;
+	bool                  started;
+	zend_long             current;
+	php_phongo_bson_state visitor_data;
+	zend_object           std;
+} php_phongo_mergedcursor_t;
+
 typedef struct {
 	bson_t*                filter;
 	bson_t*                opts;
@@ -92,12 +171,37 @@ typedef struct {
 	zend_object            std;
 } php_phongo_readconcern_t;
 
+typedef struct {
+	zval                 manager;
+	bool                 is_query;
+	char*                namespace;
+	mongoc_collection_t* collection;
+	bson_t*              opts;
+	zval                 operation;
+	zval                 read_preference;
+	bool                 is_unacknowledged_write_concern;
+	zend_object          std;
+} php_phongo_preparedoperation_t;
+
 typedef struct {
 	mongoc_read_prefs_t* read_preference;
 	HashTable*           properties;
 	zend_object          std;
 } php_phongo_readpreference_t;
 
+typedef struct {
+	int                   fd;
+	zend_string*          path;
+	char*                 map;
+	size_t                size;
+	size_t*               offsets;
+	zend_long             offsets_size;
+	zend_long             count;
+	zend_long             current;
+	php_phongo_bson_state visitor_data;
+	zend_object           std;
+} php_phongo_resultset_t;
+
 typedef struct {
 	zval        manager;
 	int         created_by_pid;
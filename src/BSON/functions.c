@@ -24,11 +24,26 @@
 #include "php_phongo.h"
 #include "php_bson.h"
 
-typedef enum {
-	PHONGO_JSON_MODE_LEGACY,
-	PHONGO_JSON_MODE_CANONICAL,
-	PHONGO_JSON_MODE_RELAXED,
-} php_phongo_json_mode_t;
+#include "functions.h"
+
+/* Converts a BSON document to a JSON string in the given mode. Returns NULL on
+ * failure; otherwise, the caller is responsible for freeing the result with
+ * bson_free(). */
+char* php_phongo_bson_to_json(const bson_t* bson, php_phongo_json_mode_t mode, size_t* json_len) /* {{{ */
+{
+	switch (mode) {
+		case PHONGO_JSON_MODE_LEGACY:
+			return bson_as_json(bson, json_len);
+
+		case PHONGO_JSON_MODE_CANONICAL:
+			return bson_as_canonical_extended_json(bson, json_len);
+
+		case PHONGO_JSON_MODE_RELAXED:
+			return bson_as_relaxed_extended_json(bson, json_len);
+	}
+
+	return NULL;
+} /* }}} */
 
 /* {{{ proto string MongoDB\BSON\fromPHP(array|object $value)
    Returns the BSON representation of a PHP value */
@@ -138,13 +153,7 @@ static void phongo_bson_to_json(INTERNAL_FUNCTION_PARAMETERS, php_phongo_json_mo
 		return;
 	}
 
-	if (mode == PHONGO_JSON_MODE_LEGACY) {
-		json = bson_as_json(bson, &json_len);
-	} else if (mode == PHONGO_JSON_MODE_CANONICAL) {
-		json = bson_as_canonical_extended_json(bson, &json_len);
-	} else if (mode == PHONGO_JSON_MODE_RELAXED) {
-		json = bson_as_relaxed_extended_json(bson, &json_len);
-	}
+	json = php_phongo_bson_to_json(bson, mode, &json_len);
 
 	if (!json) {
 		phongo_throw_exception(PHONGO_ERROR_UNEXPECTED_VALUE, "Could not convert BSON document to a JSON string");
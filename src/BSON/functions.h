@@ -17,8 +17,18 @@
 #ifndef PHONGO_BSON_FUNCTIONS_H
 #define PHONGO_BSON_FUNCTIONS_H
 
+#include <bson/bson.h>
+
 #include <php.h>
 
+typedef enum {
+	PHONGO_JSON_MODE_LEGACY,
+	PHONGO_JSON_MODE_CANONICAL,
+	PHONGO_JSON_MODE_RELAXED,
+} php_phongo_json_mode_t;
+
+char* php_phongo_bson_to_json(const bson_t* bson, php_phongo_json_mode_t mode, size_t* json_len);
+
 PHP_FUNCTION(MongoDB_BSON_fromPHP);
 PHP_FUNCTION(MongoDB_BSON_toPHP);
 
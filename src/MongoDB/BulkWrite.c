@@ -26,36 +26,29 @@
 #include "phongo_compat.h"
 #include "php_phongo.h"
 #include "php_bson.h"
+#include "BulkWrite.h"
 
-#define PHONGO_BULKWRITE_BYPASS_UNSET -1
+/* Default thresholds for auto-flushing BulkWrite objects. The operation limit
+ * corresponds to the server's default maxWriteBatchSize. */
+#define PHONGO_BULKWRITE_DEFAULT_FLUSH_BYTES (16 * 1024 * 1024)
+#define PHONGO_BULKWRITE_DEFAULT_FLUSH_OPERATIONS 100000
 
 zend_class_entry* php_phongo_bulkwrite_ce;
 
-/* Extracts the "_id" field of a BSON document into a return value. */
-static void php_phongo_bulkwrite_extract_id(bson_t* doc, zval** return_value) /* {{{ */
+/* Extracts the "_id" field of a BSON document into a return value. The field
+ * is converted directly, since decoding the entire document would be wasted
+ * work when only its identifier is needed. */
+void php_phongo_bulkwrite_extract_id(bson_t* doc, zval** return_value) /* {{{ */
 {
-	zval*                 id = NULL;
-	php_phongo_bson_state state;
-
-	PHONGO_BSON_INIT_STATE(state);
-	state.map.root_type = PHONGO_TYPEMAP_NATIVE_ARRAY;
-
-	if (!php_phongo_bson_to_zval_ex(bson_get_data(doc), doc->len, &state)) {
-		goto cleanup;
-	}
-
-	id = php_array_fetchc(&state.zchild, "_id");
+	bson_iter_t iter;
 
-	if (id) {
-		ZVAL_ZVAL(*return_value, id, 1, 0);
+	if (bson_iter_init_find(&iter, doc, "_id")) {
+		php_phongo_bson_value_to_zval(bson_iter_value(&iter), *return_value);
 	}
-
-cleanup:
-	zval_ptr_dtor(&state.zchild);
 } /* }}} */
 
 /* Returns whether any top-level field names in the document contain a "$". */
-static inline bool php_phongo_bulkwrite_update_has_operators(bson_t* bupdate) /* {{{ */
+bool php_phongo_bulkwrite_update_has_operators(bson_t* bupdate) /* {{{ */
 {
 	bson_iter_t iter;
 
@@ -71,7 +64,7 @@ static inline bool php_phongo_bulkwrite_update_has_operators(bson_t* bupdate) /*
 } /* }}} */
 
 /* Returns whether the update document is considered an aggregation pipeline */
-static inline bool php_phongo_bulkwrite_update_is_pipeline(bson_t* bupdate) /* {{{ */
+bool php_phongo_bulkwrite_update_is_pipeline(bson_t* bupdate) /* {{{ */
 {
 	bson_iter_t iter;
 	bson_iter_t child;
@@ -264,7 +257,7 @@ static bool php_phongo_bulkwrite_opt_hint(bson_t* boptions, zval* zoptions) /* {
 } /* }}} */
 
 /* Applies options (including defaults) for an update operation. */
-static bool php_phongo_bulkwrite_update_apply_options(bson_t* boptions, zval* zoptions) /* {{{ */
+bool php_phongo_bulkwrite_update_apply_options(bson_t* boptions, zval* zoptions) /* {{{ */
 {
 	bool multi = false, upsert = false;
 
@@ -286,7 +279,7 @@ static bool php_phongo_bulkwrite_update_apply_options(bson_t* boptions, zval* zo
 } /* }}} */
 
 /* Applies options (including defaults) for an delete operation. */
-static bool php_phongo_bulkwrite_delete_apply_options(bson_t* boptions, zval* zoptions) /* {{{ */
+bool php_phongo_bulkwrite_delete_apply_options(bson_t* boptions, zval* zoptions) /* {{{ */
 {
 	int32_t limit = 0;
 
@@ -308,6 +301,118 @@ static bool php_phongo_bulkwrite_delete_apply_options(bson_t* boptions, zval* zo
 #undef PHONGO_BULKWRITE_APPEND_INT32
 #undef PHONGO_BULKWRITE_OPT_DOCUMENT
 
+/* Reads a positive threshold option for an auto-flushing BulkWrite. Returns
+ * true on success; otherwise, false is returned and an exception is thrown. */
+static bool php_phongo_bulkwrite_parse_flush_threshold(zval* options, const char* key, size_t* threshold) /* {{{ */
+{
+	int64_t value;
+
+	if (!php_array_exists(options, key)) {
+		return true;
+	}
+
+	value = php_array_fetch_long(options, key);
+
+	if (value < 1) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected \"%s\" option to be >= 1, %" PRId64 " given", key, value);
+		return false;
+	}
+
+	*threshold = (size_t) value;
+
+	return true;
+} /* }}} */
+
+/* Binds the BulkWrite to a Manager and namespace, so that buffered operations
+ * are executed whenever the "flushBytes" or "flushOperations" threshold is
+ * reached. Returns true on success; otherwise, false is returned and an
+ * exception is thrown. */
+static bool php_phongo_bulkwrite_init_auto_flush(php_phongo_bulkwrite_t* intern, zval* options) /* {{{ */
+{
+	zval* zmanager      = php_array_fetchc(options, "manager");
+	zval* znamespace    = php_array_fetchc(options, "namespace");
+	zval* zwriteConcern = php_array_fetchc(options, "writeConcern");
+
+	if (!zmanager || !znamespace) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "The \"manager\" and \"namespace\" options must be specified together");
+		return false;
+	}
+
+	if (Z_TYPE_P(zmanager) != IS_OBJECT || !instanceof_function(Z_OBJCE_P(zmanager), php_phongo_manager_ce)) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected \"manager\" option to be %s, %s given", ZSTR_VAL(php_phongo_manager_ce->name), PHONGO_ZVAL_CLASS_OR_TYPE_NAME_P(zmanager));
+		return false;
+	}
+
+	if (Z_TYPE_P(znamespace) != IS_STRING) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected \"namespace\" option to be string, %s given", PHONGO_ZVAL_CLASS_OR_TYPE_NAME_P(znamespace));
+		return false;
+	}
+
+	if (zwriteConcern && (Z_TYPE_P(zwriteConcern) != IS_OBJECT || !instanceof_function(Z_OBJCE_P(zwriteConcern), php_phongo_writeconcern_ce))) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected \"writeConcern\" option to be %s, %s given", ZSTR_VAL(php_phongo_writeconcern_ce->name), PHONGO_ZVAL_CLASS_OR_TYPE_NAME_P(zwriteConcern));
+		return false;
+	}
+
+	intern->flush_bytes = PHONGO_BULKWRITE_DEFAULT_FLUSH_BYTES;
+	intern->flush_ops   = PHONGO_BULKWRITE_DEFAULT_FLUSH_OPERATIONS;
+
+	if (!php_phongo_bulkwrite_parse_flush_threshold(options, "flushBytes", &intern->flush_bytes) || !php_phongo_bulkwrite_parse_flush_threshold(options, "flushOperations", &intern->flush_ops)) {
+		return false;
+	}
+
+	if (!phongo_split_namespace(Z_STRVAL_P(znamespace), &intern->database, &intern->collection) || !intern->database[0] || !intern->collection[0]) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "%s: %s", "Invalid namespace provided", Z_STRVAL_P(znamespace));
+		return false;
+	}
+
+	ZVAL_ZVAL(&intern->manager, zmanager, 1, 0);
+
+	if (zwriteConcern) {
+		ZVAL_ZVAL(&intern->write_concern, zwriteConcern, 1, 0);
+	}
+
+	intern->flushed = emalloc(sizeof(phongo_bulk_write_result_t));
+	phongo_bulk_write_result_init(intern->flushed);
+
+	return true;
+} /* }}} */
+
+/* Returns whether operations may be added to the BulkWrite. Operations cannot
+ * be added once the BulkWrite has been executed or deferred, or once a flush of
+ * an auto-flushing BulkWrite has failed. On error, false is returned and an
+ * exception is thrown. */
+static bool php_phongo_bulkwrite_check_writable(php_phongo_bulkwrite_t* intern) /* {{{ */
+{
+	if (intern->executed) {
+		phongo_throw_exception(PHONGO_ERROR_LOGIC, "Cannot add operations to a BulkWrite that has already been executed");
+		return false;
+	}
+
+	return true;
+} /* }}} */
+
+/* Counts an operation that was added to the BulkWrite. For auto-flushing
+ * BulkWrite objects, buffered operations are executed once a threshold has been
+ * reached. Returns false if a flush failed, in which case an exception will
+ * have been thrown. */
+static bool php_phongo_bulkwrite_count_op(php_phongo_bulkwrite_t* intern, size_t op_size) /* {{{ */
+{
+	intern->num_ops++;
+
+	if (!intern->flushed) {
+		return true;
+	}
+
+	intern->buffered_ops++;
+	intern->buffered_bytes += op_size;
+
+	if (intern->buffered_ops < intern->flush_ops && intern->buffered_bytes < intern->flush_bytes) {
+		return true;
+	}
+
+	return phongo_bulk_write_flush(intern);
+} /* }}} */
+
 /* {{{ proto void MongoDB\Driver\BulkWrite::__construct([array $options = array()])
    Constructs a new BulkWrite */
 static PHP_METHOD(BulkWrite, __construct)
@@ -341,6 +446,93 @@ static PHP_METHOD(BulkWrite, __construct)
 		mongoc_bulk_operation_set_bypass_document_validation(intern->bulk, bypass);
 		intern->bypass = bypass;
 	}
+
+	if (options && (php_array_existsc(options, "manager") || php_array_existsc(options, "namespace"))) {
+		php_phongo_bulkwrite_init_auto_flush(intern, options);
+	}
+} /* }}} */
+
+/* Encodes a document, generating an "_id" if necessary, and adds an insert
+ * operation for it. On success, the document's identifier is assigned to zid
+ * and true is returned; otherwise, false is returned and an exception is
+ * thrown. */
+static bool php_phongo_bulkwrite_insert_document(php_phongo_bulkwrite_t* intern, zval* zdocument, zval* zid) /* {{{ */
+{
+	bson_t       bdocument = BSON_INITIALIZER;
+	bson_error_t error     = { 0 };
+	bool         retval    = false;
+
+	if (!php_phongo_bulkwrite_check_writable(intern)) {
+		return false;
+	}
+
+	php_phongo_zval_to_bson(zdocument, PHONGO_BSON_ADD_ID, &bdocument, NULL);
+
+	if (EG(exception)) {
+		goto cleanup;
+	}
+
+	if (!mongoc_bulk_operation_insert_with_opts(intern->bulk, &bdocument, NULL, &error)) {
+		phongo_throw_exception_from_bson_error_t(&error);
+		goto cleanup;
+	}
+
+	php_phongo_bulkwrite_extract_id(&bdocument, &zid);
+
+	if (EG(exception)) {
+		goto cleanup;
+	}
+
+	retval = php_phongo_bulkwrite_count_op(intern, bdocument.len);
+
+cleanup:
+	bson_destroy(&bdocument);
+
+	return retval;
+} /* }}} */
+
+typedef struct {
+	php_phongo_bulkwrite_t* intern;
+	zval*                   ids;
+} php_phongo_bulkwrite_insert_many_state;
+
+/* Inserts a single document for insertMany() and appends its identifier */
+static bool php_phongo_bulkwrite_insert_many_document(php_phongo_bulkwrite_insert_many_state* state, zval* zdocument) /* {{{ */
+{
+	zval zid;
+
+	ZVAL_DEREF(zdocument);
+
+	if (Z_TYPE_P(zdocument) != IS_ARRAY && Z_TYPE_P(zdocument) != IS_OBJECT) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected document to be array or object, %s given", PHONGO_ZVAL_CLASS_OR_TYPE_NAME_P(zdocument));
+		return false;
+	}
+
+	ZVAL_NULL(&zid);
+
+	if (!php_phongo_bulkwrite_insert_document(state->intern, zdocument, &zid)) {
+		zval_ptr_dtor(&zid);
+		return false;
+	}
+
+	add_next_index_zval(state->ids, &zid);
+
+	return true;
+} /* }}} */
+
+static int php_phongo_bulkwrite_insert_many_apply(zend_object_iterator* iter, void* puser) /* {{{ */
+{
+	zval* zdocument = iter->funcs->get_current_data(iter);
+
+	if (EG(exception) || Z_ISUNDEF_P(zdocument)) {
+		return ZEND_HASH_APPLY_STOP;
+	}
+
+	if (!php_phongo_bulkwrite_insert_many_document((php_phongo_bulkwrite_insert_many_state*) puser, zdocument)) {
+		return ZEND_HASH_APPLY_STOP;
+	}
+
+	return ZEND_HASH_APPLY_KEEP;
 } /* }}} */
 
 /* {{{ proto mixed MongoDB\Driver\BulkWrite::insert(array|object $document)
@@ -350,10 +542,6 @@ static PHP_METHOD(BulkWrite, insert)
 	zend_error_handling     error_handling;
 	php_phongo_bulkwrite_t* intern;
 	zval*                   zdocument;
-	bson_t                  bdocument = BSON_INITIALIZER, boptions = BSON_INITIALIZER;
-	bson_t*                 bson_out   = NULL;
-	int                     bson_flags = PHONGO_BSON_ADD_ID;
-	bson_error_t            error      = { 0 };
 
 	intern = Z_BULKWRITE_OBJ_P(getThis());
 
@@ -364,32 +552,53 @@ static PHP_METHOD(BulkWrite, insert)
 	}
 	zend_restore_error_handling(&error_handling);
 
-	bson_flags |= PHONGO_BSON_RETURN_ID;
+	php_phongo_bulkwrite_insert_document(intern, zdocument, return_value);
+} /* }}} */
+
+/* {{{ proto array MongoDB\Driver\BulkWrite::insertMany(array|Traversable $documents)
+   Adds an insert operation to the BulkWrite for each document and returns
+   their identifiers. If a document cannot be added, an exception is thrown and
+   any preceding documents remain in the BulkWrite. */
+static PHP_METHOD(BulkWrite, insertMany)
+{
+	zend_error_handling                    error_handling;
+	php_phongo_bulkwrite_insert_many_state state;
+	zval*                                  zdocuments;
 
-	php_phongo_zval_to_bson(zdocument, bson_flags, &bdocument, &bson_out);
+	state.intern = Z_BULKWRITE_OBJ_P(getThis());
+	state.ids    = return_value;
 
-	if (EG(exception)) {
-		goto cleanup;
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "z", &zdocuments) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
 	}
+	zend_restore_error_handling(&error_handling);
 
-	if (!mongoc_bulk_operation_insert_with_opts(intern->bulk, &bdocument, &boptions, &error)) {
-		phongo_throw_exception_from_bson_error_t(&error);
-		goto cleanup;
-	}
+	if (Z_TYPE_P(zdocuments) == IS_ARRAY) {
+		zval* zdocument;
 
-	intern->num_ops++;
+		array_init_size(return_value, zend_hash_num_elements(Z_ARRVAL_P(zdocuments)));
 
-	if (!bson_out) {
-		phongo_throw_exception(PHONGO_ERROR_LOGIC, "Did not receive result from bulk write. Please file a bug report.");
-		goto cleanup;
+		ZEND_HASH_FOREACH_VAL_IND(Z_ARRVAL_P(zdocuments), zdocument)
+		{
+			if (!php_phongo_bulkwrite_insert_many_document(&state, zdocument)) {
+				break;
+			}
+		}
+		ZEND_HASH_FOREACH_END();
+	} else if (Z_TYPE_P(zdocuments) == IS_OBJECT && instanceof_function(Z_OBJCE_P(zdocuments), zend_ce_traversable)) {
+		array_init(return_value);
+		spl_iterator_apply(zdocuments, php_phongo_bulkwrite_insert_many_apply, (void*) &state);
+	} else {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected documents to be array or Traversable, %s given", PHONGO_ZVAL_CLASS_OR_TYPE_NAME_P(zdocuments));
+		return;
 	}
 
-	php_phongo_bulkwrite_extract_id(bson_out, &return_value);
-
-cleanup:
-	bson_destroy(&bdocument);
-	bson_destroy(&boptions);
-	bson_clear(&bson_out);
+	if (EG(exception)) {
+		zval_ptr_dtor(return_value);
+		ZVAL_NULL(return_value);
+	}
 } /* }}} */
 
 /* {{{ proto void MongoDB\Driver\BulkWrite::update(array|object $query, array|object $newObj[, array $updateOptions = array()])
@@ -411,6 +620,10 @@ static PHP_METHOD(BulkWrite, update)
 	}
 	zend_restore_error_handling(&error_handling);
 
+	if (!php_phongo_bulkwrite_check_writable(intern)) {
+		return;
+	}
+
 	php_phongo_zval_to_bson(zquery, PHONGO_BSON_NONE, &bquery, NULL);
 
 	if (EG(exception)) {
@@ -451,7 +664,7 @@ static PHP_METHOD(BulkWrite, update)
 		}
 	}
 
-	intern->num_ops++;
+	php_phongo_bulkwrite_count_op(intern, bquery.len + bupdate.len + boptions.len);
 
 cleanup:
 	bson_destroy(&bquery);
@@ -478,6 +691,10 @@ static PHP_METHOD(BulkWrite, delete)
 	}
 	zend_restore_error_handling(&error_handling);
 
+	if (!php_phongo_bulkwrite_check_writable(intern)) {
+		return;
+	}
+
 	php_phongo_zval_to_bson(zquery, PHONGO_BSON_NONE, &bquery, NULL);
 
 	if (EG(exception)) {
@@ -500,7 +717,7 @@ static PHP_METHOD(BulkWrite, delete)
 		}
 	}
 
-	intern->num_ops++;
+	php_phongo_bulkwrite_count_op(intern, bquery.len + boptions.len);
 
 cleanup:
 	bson_destroy(&bquery);
@@ -535,6 +752,10 @@ ZEND_BEGIN_ARG_INFO_EX(ai_BulkWrite_insert, 0, 0, 1)
 	ZEND_ARG_INFO(0, document)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(ai_BulkWrite_insertMany, 0, 0, 1)
+	ZEND_ARG_INFO(0, documents)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(ai_BulkWrite_update, 0, 0, 2)
 	ZEND_ARG_INFO(0, query)
 	ZEND_ARG_INFO(0, newObj)
@@ -553,6 +774,7 @@ static zend_function_entry php_phongo_bulkwrite_me[] = {
 	/* clang-format off */
 	PHP_ME(BulkWrite, __construct, ai_BulkWrite___construct, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(BulkWrite, insert, ai_BulkWrite_insert, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(BulkWrite, insertMany, ai_BulkWrite_insertMany, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(BulkWrite, update, ai_BulkWrite_update, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(BulkWrite, delete, ai_BulkWrite_delete, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(BulkWrite, count, ai_BulkWrite_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
@@ -586,6 +808,23 @@ static void php_phongo_bulkwrite_free_object(zend_object* object) /* {{{ */
 	if (!Z_ISUNDEF(intern->session)) {
 		zval_ptr_dtor(&intern->session);
 	}
+
+	if (intern->flushed) {
+		phongo_bulk_write_result_destroy(intern->flushed);
+		efree(intern->flushed);
+	}
+
+	if (intern->flush_error_reply) {
+		bson_destroy(intern->flush_error_reply);
+	}
+
+	if (!Z_ISUNDEF(intern->write_concern)) {
+		zval_ptr_dtor(&intern->write_concern);
+	}
+
+	if (!Z_ISUNDEF(intern->manager)) {
+		zval_ptr_dtor(&intern->manager);
+	}
 } /* }}} */
 
 static zend_object* php_phongo_bulkwrite_create_object(zend_class_entry* class_type) /* {{{ */
@@ -0,0 +1,28 @@
+/*
+ * Copyright 2021 MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PHP_MONGODB_DRIVER_BULKWRITE_H
+#define PHP_MONGODB_DRIVER_BULKWRITE_H
+
+#define PHONGO_BULKWRITE_BYPASS_UNSET -1
+
+void php_phongo_bulkwrite_extract_id(bson_t* doc, zval** return_value);
+bool php_phongo_bulkwrite_update_has_operators(bson_t* bupdate);
+bool php_phongo_bulkwrite_update_is_pipeline(bson_t* bupdate);
+bool php_phongo_bulkwrite_update_apply_options(bson_t* boptions, zval* zoptions);
+bool php_phongo_bulkwrite_delete_apply_options(bson_t* boptions, zval* zoptions);
+
+#endif /* PHP_MONGODB_DRIVER_BULKWRITE_H */
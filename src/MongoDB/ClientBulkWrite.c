@@ -0,0 +1,429 @@
+/*
+ * Copyright 2021 MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <php.h>
+#include <ext/spl/spl_iterators.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php_array_api.h"
+#include "phongo_compat.h"
+#include "php_phongo.h"
+#include "php_bson.h"
+#include "BulkWrite.h"
+
+#define PHONGO_CLIENTBULKWRITE_BYPASS_UNSET -1
+
+zend_class_entry* php_phongo_clientbulkwrite_ce;
+
+/* Appends an operation to the ClientBulkWrite. Ownership of the BSON
+ * documents is transferred to the ClientBulkWrite. Returns false and throws an
+ * exception if the namespace is invalid. */
+static bool php_phongo_clientbulkwrite_add(php_phongo_clientbulkwrite_t* intern, php_phongo_clientbulkwrite_op_type_t type, const char* namespace, bson_t* document, bson_t* update, bson_t* opts) /* {{{ */
+{
+	php_phongo_clientbulkwrite_op_t* op;
+	const char*                      dot = strchr(namespace, '.');
+
+	if (!dot || dot == namespace || *(dot + 1) == '\0') {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "%s: %s", "Invalid namespace provided", namespace);
+
+		bson_destroy(document);
+		if (update) {
+			bson_destroy(update);
+		}
+		bson_destroy(opts);
+
+		return false;
+	}
+
+	if (intern->num_ops == intern->ops_size) {
+		intern->ops_size = intern->ops_size ? intern->ops_size * 2 : 8;
+		intern->ops      = erealloc(intern->ops, intern->ops_size * sizeof(php_phongo_clientbulkwrite_op_t));
+	}
+
+	op            = &intern->ops[intern->num_ops++];
+	op->type      = type;
+	op->namespace = estrdup(namespace);
+	op->document  = document;
+	op->update    = update;
+	op->opts      = opts;
+
+	return true;
+} /* }}} */
+
+/* {{{ proto void MongoDB\Driver\ClientBulkWrite::__construct([array $options = array()])
+   Constructs a new ClientBulkWrite */
+static PHP_METHOD(ClientBulkWrite, __construct)
+{
+	zend_error_handling           error_handling;
+	php_phongo_clientbulkwrite_t* intern;
+	zval*                         options = NULL;
+
+	intern = Z_CLIENTBULKWRITE_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "|a!", &options) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	intern->ordered  = true;
+	intern->bypass   = PHONGO_CLIENTBULKWRITE_BYPASS_UNSET;
+	intern->executed = false;
+
+	if (options && php_array_existsc(options, "ordered")) {
+		intern->ordered = php_array_fetchc_bool(options, "ordered");
+	}
+
+	if (options && php_array_existsc(options, "bypassDocumentValidation")) {
+		intern->bypass = php_array_fetchc_bool(options, "bypassDocumentValidation");
+	}
+} /* }}} */
+
+/* {{{ proto mixed MongoDB\Driver\ClientBulkWrite::insert(string $namespace, array|object $document)
+   Adds an insert operation to the ClientBulkWrite */
+static PHP_METHOD(ClientBulkWrite, insert)
+{
+	zend_error_handling           error_handling;
+	php_phongo_clientbulkwrite_t* intern;
+	char*                         namespace;
+	size_t                        namespace_len;
+	zval*                         zdocument;
+	bson_t*                       bdocument;
+	bson_t*                       bson_out = NULL;
+
+	intern = Z_CLIENTBULKWRITE_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "sA", &namespace, &namespace_len, &zdocument) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	bdocument = bson_new();
+	php_phongo_zval_to_bson(zdocument, PHONGO_BSON_ADD_ID | PHONGO_BSON_RETURN_ID, bdocument, &bson_out);
+
+	if (EG(exception)) {
+		bson_destroy(bdocument);
+		goto cleanup;
+	}
+
+	if (!php_phongo_clientbulkwrite_add(intern, PHONGO_CLIENTBULKWRITE_INSERT, namespace, bdocument, NULL, bson_new())) {
+		/* Exception should already have been thrown */
+		goto cleanup;
+	}
+
+	if (!bson_out) {
+		phongo_throw_exception(PHONGO_ERROR_LOGIC, "Did not receive result from bulk write. Please file a bug report.");
+		goto cleanup;
+	}
+
+	php_phongo_bulkwrite_extract_id(bson_out, &return_value);
+
+cleanup:
+	bson_clear(&bson_out);
+} /* }}} */
+
+/* {{{ proto void MongoDB\Driver\ClientBulkWrite::update(string $namespace, array|object $query, array|object $newObj[, array $updateOptions = array()])
+   Adds an update operation to the ClientBulkWrite */
+static PHP_METHOD(ClientBulkWrite, update)
+{
+	zend_error_handling                  error_handling;
+	php_phongo_clientbulkwrite_t*        intern;
+	php_phongo_clientbulkwrite_op_type_t type;
+	char*                                namespace;
+	size_t                               namespace_len;
+	zval *                               zquery, *zupdate, *zoptions = NULL;
+	bson_t *                             bquery, *bupdate, *boptions;
+
+	intern = Z_CLIENTBULKWRITE_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "sAA|a!", &namespace, &namespace_len, &zquery, &zupdate, &zoptions) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	bquery   = bson_new();
+	bupdate  = bson_new();
+	boptions = bson_new();
+
+	php_phongo_zval_to_bson(zquery, PHONGO_BSON_NONE, bquery, NULL);
+
+	if (EG(exception)) {
+		goto failure;
+	}
+
+	php_phongo_zval_to_bson(zupdate, PHONGO_BSON_NONE, bupdate, NULL);
+
+	if (EG(exception)) {
+		goto failure;
+	}
+
+	if (!php_phongo_bulkwrite_update_apply_options(boptions, zoptions)) {
+		goto failure;
+	}
+
+	if (php_phongo_bulkwrite_update_has_operators(bupdate) || php_phongo_bulkwrite_update_is_pipeline(bupdate)) {
+		type = (zoptions && php_array_fetchc_bool(zoptions, "multi")) ? PHONGO_CLIENTBULKWRITE_UPDATE_MANY : PHONGO_CLIENTBULKWRITE_UPDATE_ONE;
+	} else {
+		if (zoptions && php_array_fetchc_bool(zoptions, "multi")) {
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Replacement document conflicts with true \"multi\" option");
+			goto failure;
+		}
+
+		type = PHONGO_CLIENTBULKWRITE_REPLACE_ONE;
+	}
+
+	/* Ownership of the documents is transferred even on failure */
+	php_phongo_clientbulkwrite_add(intern, type, namespace, bquery, bupdate, boptions);
+	return;
+
+failure:
+	bson_destroy(bquery);
+	bson_destroy(bupdate);
+	bson_destroy(boptions);
+} /* }}} */
+
+/* {{{ proto void MongoDB\Driver\ClientBulkWrite::delete(string $namespace, array|object $query[, array $deleteOptions = array()])
+   Adds a delete operation to the ClientBulkWrite */
+static PHP_METHOD(ClientBulkWrite, delete)
+{
+	zend_error_handling           error_handling;
+	php_phongo_clientbulkwrite_t* intern;
+	char*                         namespace;
+	size_t                        namespace_len;
+	zval *                        zquery, *zoptions = NULL;
+	bson_t *                      bquery, *boptions;
+
+	intern = Z_CLIENTBULKWRITE_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "sA|a!", &namespace, &namespace_len, &zquery, &zoptions) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	bquery   = bson_new();
+	boptions = bson_new();
+
+	php_phongo_zval_to_bson(zquery, PHONGO_BSON_NONE, bquery, NULL);
+
+	if (EG(exception)) {
+		goto failure;
+	}
+
+	if (!php_phongo_bulkwrite_delete_apply_options(boptions, zoptions)) {
+		goto failure;
+	}
+
+	/* Ownership of the documents is transferred even on failure */
+	php_phongo_clientbulkwrite_add(
+		intern,
+		(zoptions && php_array_fetchc_bool(zoptions, "limit")) ? PHONGO_CLIENTBULKWRITE_DELETE_ONE : PHONGO_CLIENTBULKWRITE_DELETE_MANY,
+		namespace,
+		bquery,
+		NULL,
+		boptions);
+	return;
+
+failure:
+	bson_destroy(bquery);
+	bson_destroy(boptions);
+} /* }}} */
+
+/* {{{ proto integer MongoDB\Driver\ClientBulkWrite::count()
+   Returns the number of operations that have been added to the ClientBulkWrite */
+static PHP_METHOD(ClientBulkWrite, count)
+{
+	zend_error_handling           error_handling;
+	php_phongo_clientbulkwrite_t* intern;
+
+	intern = Z_CLIENTBULKWRITE_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	RETURN_LONG(intern->num_ops);
+} /* }}} */
+
+/* {{{ MongoDB\Driver\ClientBulkWrite function entries */
+ZEND_BEGIN_ARG_INFO_EX(ai_ClientBulkWrite___construct, 0, 0, 0)
+	ZEND_ARG_ARRAY_INFO(0, options, 1)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(ai_ClientBulkWrite_insert, 0, 0, 2)
+	ZEND_ARG_INFO(0, namespace)
+	ZEND_ARG_INFO(0, document)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(ai_ClientBulkWrite_update, 0, 0, 3)
+	ZEND_ARG_INFO(0, namespace)
+	ZEND_ARG_INFO(0, query)
+	ZEND_ARG_INFO(0, newObj)
+	ZEND_ARG_ARRAY_INFO(0, updateOptions, 1)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(ai_ClientBulkWrite_delete, 0, 0, 2)
+	ZEND_ARG_INFO(0, namespace)
+	ZEND_ARG_INFO(0, query)
+	ZEND_ARG_ARRAY_INFO(0, deleteOptions, 1)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(ai_ClientBulkWrite_void, 0, 0, 0)
+ZEND_END_ARG_INFO()
+
+static zend_function_entry php_phongo_clientbulkwrite_me[] = {
+	/* clang-format off */
+	PHP_ME(ClientBulkWrite, __construct, ai_ClientBulkWrite___construct, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(ClientBulkWrite, insert, ai_ClientBulkWrite_insert, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(ClientBulkWrite, update, ai_ClientBulkWrite_update, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(ClientBulkWrite, delete, ai_ClientBulkWrite_delete, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(ClientBulkWrite, count, ai_ClientBulkWrite_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	ZEND_NAMED_ME(__wakeup, PHP_FN(MongoDB_disabled___wakeup), ai_ClientBulkWrite_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_FE_END
+	/* clang-format on */
+};
+/* }}} */
+
+/* {{{ MongoDB\Driver\ClientBulkWrite object handlers */
+static zend_object_handlers php_phongo_handler_clientbulkwrite;
+
+static void php_phongo_clientbulkwrite_free_object(zend_object* object) /* {{{ */
+{
+	php_phongo_clientbulkwrite_t* intern = Z_OBJ_CLIENTBULKWRITE(object);
+	size_t                        i;
+
+	zend_object_std_dtor(&intern->std);
+
+	for (i = 0; i < intern->num_ops; i++) {
+		php_phongo_clientbulkwrite_op_t* op = &intern->ops[i];
+
+		efree(op->namespace);
+		bson_destroy(op->document);
+		bson_destroy(op->opts);
+
+		if (op->update) {
+			bson_destroy(op->update);
+		}
+	}
+
+	if (intern->ops) {
+		efree(intern->ops);
+	}
+
+	if (!Z_ISUNDEF(intern->session)) {
+		zval_ptr_dtor(&intern->session);
+	}
+} /* }}} */
+
+static zend_object* php_phongo_clientbulkwrite_create_object(zend_class_entry* class_type) /* {{{ */
+{
+	php_phongo_clientbulkwrite_t* intern = NULL;
+
+	intern = PHONGO_ALLOC_OBJECT_T(php_phongo_clientbulkwrite_t, class_type);
+
+	zend_object_std_init(&intern->std, class_type);
+	object_properties_init(&intern->std, class_type);
+
+	intern->std.handlers = &php_phongo_handler_clientbulkwrite;
+
+	return &intern->std;
+} /* }}} */
+
+static HashTable* php_phongo_clientbulkwrite_get_debug_info(phongo_compat_object_handler_type* object, int* is_temp) /* {{{ */
+{
+	zval                          retval = ZVAL_STATIC_INIT;
+	zval                          namespaces;
+	php_phongo_clientbulkwrite_t* intern = NULL;
+	size_t                        i;
+
+	*is_temp = 1;
+	intern   = Z_OBJ_CLIENTBULKWRITE(PHONGO_COMPAT_GET_OBJ(object));
+	array_init(&retval);
+
+	/* Report the number of operations for each namespace, in the order that
+	 * each namespace was first used */
+	array_init(&namespaces);
+
+	for (i = 0; i < intern->num_ops; i++) {
+		zval* count = zend_hash_str_find(Z_ARRVAL(namespaces), intern->ops[i].namespace, strlen(intern->ops[i].namespace));
+
+		if (count) {
+			Z_LVAL_P(count)++;
+		} else {
+			add_assoc_long(&namespaces, intern->ops[i].namespace, 1);
+		}
+	}
+
+	ADD_ASSOC_ZVAL_EX(&retval, "namespaces", &namespaces);
+	ADD_ASSOC_BOOL_EX(&retval, "ordered", intern->ordered);
+
+	if (intern->bypass != PHONGO_CLIENTBULKWRITE_BYPASS_UNSET) {
+		ADD_ASSOC_BOOL_EX(&retval, "bypassDocumentValidation", intern->bypass);
+	} else {
+		ADD_ASSOC_NULL_EX(&retval, "bypassDocumentValidation");
+	}
+
+	ADD_ASSOC_BOOL_EX(&retval, "executed", intern->executed);
+
+	if (!Z_ISUNDEF(intern->session)) {
+		ADD_ASSOC_ZVAL_EX(&retval, "session", &intern->session);
+		Z_ADDREF(intern->session);
+	} else {
+		ADD_ASSOC_NULL_EX(&retval, "session");
+	}
+
+	return Z_ARRVAL(retval);
+} /* }}} */
+/* }}} */
+
+void php_phongo_clientbulkwrite_init_ce(INIT_FUNC_ARGS) /* {{{ */
+{
+	zend_class_entry ce;
+
+	INIT_NS_CLASS_ENTRY(ce, "MongoDB\\Driver", "ClientBulkWrite", php_phongo_clientbulkwrite_me);
+	php_phongo_clientbulkwrite_ce                = zend_register_internal_class(&ce);
+	php_phongo_clientbulkwrite_ce->create_object = php_phongo_clientbulkwrite_create_object;
+	PHONGO_CE_FINAL(php_phongo_clientbulkwrite_ce);
+	PHONGO_CE_DISABLE_SERIALIZATION(php_phongo_clientbulkwrite_ce);
+
+	memcpy(&php_phongo_handler_clientbulkwrite, phongo_get_std_object_handlers(), sizeof(zend_object_handlers));
+	php_phongo_handler_clientbulkwrite.get_debug_info = php_phongo_clientbulkwrite_get_debug_info;
+	php_phongo_handler_clientbulkwrite.free_obj       = php_phongo_clientbulkwrite_free_object;
+	php_phongo_handler_clientbulkwrite.offset         = XtOffsetOf(php_phongo_clientbulkwrite_t, std);
+
+	zend_class_implements(php_phongo_clientbulkwrite_ce, 1, spl_ce_Countable);
+} /* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -15,16 +15,108 @@
  */
 
 #include <php.h>
+#include <main/php_streams.h>
 #include <Zend/zend_interfaces.h>
+#include <Zend/zend_smart_str.h>
 #include <ext/spl/spl_iterators.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#include "php_array_api.h"
 #include "phongo_compat.h"
 #include "php_phongo.h"
 #include "php_bson.h"
+#include "src/BSON/functions.h"
+
+/* Output formats for Cursor::writeTo() */
+typedef enum {
+	PHONGO_CURSOR_FORMAT_BSON                    = 1,
+	PHONGO_CURSOR_FORMAT_RELAXED_EXTENDED_JSON   = 2,
+	PHONGO_CURSOR_FORMAT_CANONICAL_EXTENDED_JSON = 3,
+	PHONGO_CURSOR_FORMAT_JSON_ARRAY              = 4,
+} php_phongo_cursor_format_t;
+
+/* Size at which Cursor::writeTo() flushes its output buffer to the stream */
+#define PHONGO_CURSOR_WRITE_BUFFER_SIZE 65536
+
+typedef struct {
+	php_stream*                stream;
+	php_phongo_cursor_format_t format;
+	smart_str                  buffer;
+	zend_long                  count;
+} php_phongo_cursor_write_state;
+
+typedef struct {
+	uint32_t      num_fields;
+	uint32_t      num_top_level_fields;
+	zend_string** fields;
+	bool*         is_path;
+	bool*         found;
+	zval*         columns;
+	zval*         missing_value;
+	HashTable     top_level_fields;
+} php_phongo_cursor_columns_state;
+
+typedef enum {
+	PHONGO_REDUCE_SUM,
+	PHONGO_REDUCE_AVG,
+	PHONGO_REDUCE_MIN,
+	PHONGO_REDUCE_MAX,
+} php_phongo_reduce_op_type;
+
+typedef struct {
+	php_phongo_reduce_op_type type;
+	zend_string*              field;
+} php_phongo_reduce_op;
+
+typedef enum {
+	PHONGO_REDUCE_DECIMAL_FINITE,
+	PHONGO_REDUCE_DECIMAL_NAN,
+	PHONGO_REDUCE_DECIMAL_POS_INF,
+	PHONGO_REDUCE_DECIMAL_NEG_INF,
+} php_phongo_reduce_decimal_kind;
+
+/* Exact decimal number, which is used to sum values once a Decimal128 has been
+ * encountered. The coefficient's digits are stored least significant first and
+ * the result is only rounded to Decimal128 precision when it is returned. */
+typedef struct {
+	php_phongo_reduce_decimal_kind kind;
+	bool                           negative;
+	int32_t                        exponent;
+	uint8_t*                       digits;
+	size_t                         len;
+} php_phongo_reduce_decimal;
+
+typedef struct {
+	bool                      is_double;
+	bool                      is_decimal;
+	int64_t                   isum;
+	double                    dsum;
+	php_phongo_reduce_decimal decsum;
+	int64_t                   num_values;
+	bool                      has_value;
+	bson_value_t              value;
+} php_phongo_reduce_acc;
+
+typedef struct {
+	bson_value_t           id;
+	int64_t                count;
+	php_phongo_reduce_acc* accs;
+} php_phongo_reduce_group;
+
+typedef struct {
+	php_phongo_reduce_op*    ops;
+	uint32_t                 num_ops;
+	zend_string*             group_by;
+	HashTable                groups;
+	php_phongo_reduce_group* single;
+	smart_str                key;
+} php_phongo_reduce_state;
+
+/* Number of significant digits in a Decimal128 */
+#define PHONGO_REDUCE_DECIMAL128_DIGITS 34
 
 zend_class_entry* php_phongo_cursor_ce;
 
@@ -52,6 +144,957 @@ static void php_phongo_cursor_free_current(php_phongo_cursor_t* cursor) /* {{{ *
 	}
 } /* }}} */
 
+/* Prepares the cursor for raw iteration and sets doc to its first remaining
+ * document, or NULL if there are none. As with toArray(), this is not
+ * permitted once iteration has started. Returns false if the cursor failed, in
+ * which case an exception will have been thrown. */
+bool php_phongo_cursor_raw_start(php_phongo_cursor_t* intern, const bson_t** doc) /* {{{ */
+{
+	/* If the cursor was never advanced (e.g. command cursor), do so now */
+	if (!intern->advanced) {
+		intern->advanced = true;
+
+		if (!phongo_cursor_advance_and_check_for_error(intern->cursor)) {
+			/* Exception should already have been thrown */
+			return false;
+		}
+	}
+
+	if (intern->current > 0) {
+		phongo_throw_exception(PHONGO_ERROR_LOGIC, "Cursors cannot rewind after starting iteration");
+		return false;
+	}
+
+	php_phongo_cursor_free_current(intern);
+
+	*doc = mongoc_cursor_current(intern->cursor);
+
+	return true;
+} /* }}} */
+
+/* Advances the cursor past its current document during raw iteration and sets
+ * doc to the next document, or NULL if the cursor is exhausted. Returns false
+ * if the cursor failed, in which case an exception will have been thrown. */
+bool php_phongo_cursor_raw_next(php_phongo_cursor_t* intern, const bson_t** doc) /* {{{ */
+{
+	bson_error_t  error = { 0 };
+	const bson_t* reply = NULL;
+
+	intern->current++;
+
+	if (mongoc_cursor_next(intern->cursor, doc)) {
+		return true;
+	}
+
+	*doc = NULL;
+
+	/* Check for connection related exceptions */
+	if (EG(exception)) {
+		return false;
+	}
+
+	if (mongoc_cursor_error_document(intern->cursor, &error, &reply)) {
+		phongo_throw_exception_from_bson_error_t_and_reply(&error, reply);
+		return false;
+	}
+
+	php_phongo_cursor_free_session_if_exhausted(intern);
+
+	return true;
+} /* }}} */
+
+/* Visits each remaining document in the cursor without converting it to a PHP
+ * value. The cursor's position is advanced past each visited document. Returns
+ * false if the visitor or cursor failed, in which case an exception will have
+ * been thrown. */
+bool php_phongo_cursor_visit_raw(php_phongo_cursor_t* intern, php_phongo_cursor_raw_visitor_t visitor, void* data) /* {{{ */
+{
+	const bson_t* doc;
+	bool          retval = false;
+
+	if (!php_phongo_cursor_raw_start(intern, &doc)) {
+		/* Exception should already have been thrown */
+		return false;
+	}
+
+	while (doc) {
+		if (!visitor(doc, data)) {
+			/* Exception should already have been thrown */
+			goto cleanup;
+		}
+
+		if (!php_phongo_cursor_raw_next(intern, &doc)) {
+			/* Exception should already have been thrown */
+			goto cleanup;
+		}
+	}
+
+	retval = true;
+
+cleanup:
+	php_phongo_cursor_free_session_if_exhausted(intern);
+
+	return retval;
+} /* }}} */
+
+static bool php_phongo_cursor_write_flush(php_phongo_cursor_write_state* state) /* {{{ */
+{
+	size_t len;
+
+	if (!state->buffer.s || ZSTR_LEN(state->buffer.s) == 0) {
+		return true;
+	}
+
+	len = ZSTR_LEN(state->buffer.s);
+
+	if ((size_t) php_stream_write(state->stream, ZSTR_VAL(state->buffer.s), len) != len) {
+		phongo_throw_exception(PHONGO_ERROR_RUNTIME, "Failed to write %zu bytes to stream", len);
+		return false;
+	}
+
+	ZSTR_LEN(state->buffer.s) = 0;
+
+	return true;
+} /* }}} */
+
+static bool php_phongo_cursor_write_visitor(const bson_t* doc, void* data) /* {{{ */
+{
+	php_phongo_cursor_write_state* state = (php_phongo_cursor_write_state*) data;
+	char*                          json;
+	size_t                         json_len;
+
+	if (state->format == PHONGO_CURSOR_FORMAT_BSON) {
+		smart_str_appendl(&state->buffer, (const char*) bson_get_data(doc), doc->len);
+	} else {
+		json = php_phongo_bson_to_json(doc, state->format == PHONGO_CURSOR_FORMAT_CANONICAL_EXTENDED_JSON ? PHONGO_JSON_MODE_CANONICAL : PHONGO_JSON_MODE_RELAXED, &json_len);
+
+		if (!json) {
+			phongo_throw_exception(PHONGO_ERROR_UNEXPECTED_VALUE, "Could not convert BSON document to a JSON string");
+			return false;
+		}
+
+		if (state->format == PHONGO_CURSOR_FORMAT_JSON_ARRAY) {
+			if (state->count > 0) {
+				smart_str_appendc(&state->buffer, ',');
+			}
+			smart_str_appendl(&state->buffer, json, json_len);
+		} else {
+			smart_str_appendl(&state->buffer, json, json_len);
+			smart_str_appendc(&state->buffer, '\n');
+		}
+
+		bson_free(json);
+	}
+
+	state->count++;
+
+	if (ZSTR_LEN(state->buffer.s) >= PHONGO_CURSOR_WRITE_BUFFER_SIZE) {
+		return php_phongo_cursor_write_flush(state);
+	}
+
+	return true;
+} /* }}} */
+
+static bool php_phongo_cursor_append_column_value(zval* column, bson_iter_t* iter) /* {{{ */
+{
+	zval value;
+
+	if (!php_phongo_bson_value_to_zval(bson_iter_value(iter), &value)) {
+		/* Exception should already have been thrown */
+		return false;
+	}
+
+	add_next_index_zval(column, &value);
+
+	return true;
+} /* }}} */
+
+static bool php_phongo_cursor_columns_visitor(const bson_t* doc, void* data) /* {{{ */
+{
+	php_phongo_cursor_columns_state* state = (php_phongo_cursor_columns_state*) data;
+	bson_iter_t                      iter;
+	bson_iter_t                      child;
+	uint32_t                         remaining = state->num_top_level_fields;
+	uint32_t                         i;
+
+	memset(state->found, 0, state->num_fields * sizeof(bool));
+
+	/* Top-level fields are all located in a single pass over the document */
+	if (remaining > 0 && bson_iter_init(&iter, doc)) {
+		while (remaining > 0 && bson_iter_next(&iter)) {
+			const char* key = bson_iter_key(&iter);
+			zval*       index;
+
+			if (!(index = zend_hash_str_find(&state->top_level_fields, key, strlen(key)))) {
+				continue;
+			}
+
+			/* Only the first occurrence of a duplicate key is considered */
+			if (state->found[Z_LVAL_P(index)]) {
+				continue;
+			}
+
+			if (!php_phongo_cursor_append_column_value(&state->columns[Z_LVAL_P(index)], &iter)) {
+				return false;
+			}
+
+			state->found[Z_LVAL_P(index)] = true;
+			remaining--;
+		}
+	}
+
+	for (i = 0; i < state->num_fields; i++) {
+		if (state->found[i]) {
+			continue;
+		}
+
+		if (state->is_path[i] && bson_iter_init(&iter, doc) && bson_iter_find_descendant(&iter, ZSTR_VAL(state->fields[i]), &child)) {
+			if (!php_phongo_cursor_append_column_value(&state->columns[i], &child)) {
+				return false;
+			}
+
+			continue;
+		}
+
+		Z_TRY_ADDREF_P(state->missing_value);
+		add_next_index_zval(&state->columns[i], state->missing_value);
+	}
+
+	return true;
+} /* }}} */
+
+static void php_phongo_reduce_decimal_dtor(php_phongo_reduce_decimal* dec) /* {{{ */
+{
+	if (dec->digits) {
+		efree(dec->digits);
+	}
+
+	memset(dec, 0, sizeof(php_phongo_reduce_decimal));
+} /* }}} */
+
+/* Removes leading zeros from the coefficient. Zero is never negative. */
+static void php_phongo_reduce_decimal_trim(php_phongo_reduce_decimal* dec) /* {{{ */
+{
+	while (dec->len > 0 && dec->digits[dec->len - 1] == 0) {
+		dec->len--;
+	}
+
+	if (dec->len == 0) {
+		dec->negative = false;
+	}
+} /* }}} */
+
+/* Parses a finite number in the format produced by printf() or
+ * bson_decimal128_to_string() (e.g. "-1.25E+3"), or one of the special values
+ * produced by the latter. */
+static void php_phongo_reduce_decimal_parse(const char* str, php_phongo_reduce_decimal* dec) /* {{{ */
+{
+	const char* start;
+	const char* end;
+	int32_t     fraction_digits = 0;
+	bool        in_fraction     = false;
+
+	memset(dec, 0, sizeof(php_phongo_reduce_decimal));
+
+	if (*str == '-' || *str == '+') {
+		dec->negative = *str == '-';
+		str++;
+	}
+
+	if (!strcmp(str, "NaN")) {
+		dec->kind     = PHONGO_REDUCE_DECIMAL_NAN;
+		dec->negative = false;
+		return;
+	}
+
+	if (!strcmp(str, "Infinity")) {
+		dec->kind     = dec->negative ? PHONGO_REDUCE_DECIMAL_NEG_INF : PHONGO_REDUCE_DECIMAL_POS_INF;
+		dec->negative = false;
+		return;
+	}
+
+	for (start = end = str; (*end >= '0' && *end <= '9') || *end == '.'; end++) {
+		if (*end == '.') {
+			in_fraction = true;
+		} else if (in_fraction) {
+			fraction_digits++;
+		}
+	}
+
+	dec->digits = emalloc((size_t) (end - start) + 1);
+
+	while (end > start) {
+		end--;
+
+		if (*end != '.') {
+			dec->digits[dec->len++] = (uint8_t) (*end - '0');
+		}
+	}
+
+	dec->exponent = -fraction_digits;
+
+	for (end = start; (*end >= '0' && *end <= '9') || *end == '.'; end++)
+		;
+
+	if (*end == 'e' || *end == 'E') {
+		dec->exponent += (int32_t) strtol(end + 1, NULL, 10);
+	}
+
+	php_phongo_reduce_decimal_trim(dec);
+} /* }}} */
+
+static void php_phongo_reduce_decimal_from_int64(int64_t value, php_phongo_reduce_decimal* dec) /* {{{ */
+{
+	char str[24];
+
+	snprintf(str, sizeof(str), "%" PRId64, value);
+	php_phongo_reduce_decimal_parse(str, dec);
+} /* }}} */
+
+/* As with the server, doubles are converted to Decimal128 with 15 significant
+ * digits. */
+static void php_phongo_reduce_decimal_from_double(double value, php_phongo_reduce_decimal* dec) /* {{{ */
+{
+	char str[32];
+
+	if (zend_isnan(value)) {
+		php_phongo_reduce_decimal_parse("NaN", dec);
+		return;
+	}
+
+	if (zend_isinf(value)) {
+		php_phongo_reduce_decimal_parse(value > 0 ? "Infinity" : "-Infinity", dec);
+		return;
+	}
+
+	snprintf(str, sizeof(str), "%.14e", value);
+	php_phongo_reduce_decimal_parse(str, dec);
+} /* }}} */
+
+static void php_phongo_reduce_decimal_from_decimal128(const bson_decimal128_t* value, php_phongo_reduce_decimal* dec) /* {{{ */
+{
+	char str[BSON_DECIMAL128_STRING];
+
+	bson_decimal128_to_string(value, str);
+	php_phongo_reduce_decimal_parse(str, dec);
+} /* }}} */
+
+/* Multiplies the coefficient by 10^shift and decreases the exponent
+ * accordingly, which leaves the value unchanged. */
+static void php_phongo_reduce_decimal_shift(php_phongo_reduce_decimal* dec, size_t shift) /* {{{ */
+{
+	dec->exponent -= (int32_t) shift;
+
+	if (dec->len == 0) {
+		return;
+	}
+
+	dec->digits = erealloc(dec->digits, dec->len + shift);
+	memmove(dec->digits + shift, dec->digits, dec->len);
+	memset(dec->digits, 0, shift);
+	dec->len += shift;
+} /* }}} */
+
+static int php_phongo_reduce_decimal_compare_magnitude(const php_phongo_reduce_decimal* a, const php_phongo_reduce_decimal* b) /* {{{ */
+{
+	size_t i;
+
+	if (a->len != b->len) {
+		return a->len < b->len ? -1 : 1;
+	}
+
+	for (i = a->len; i > 0; i--) {
+		if (a->digits[i - 1] != b->digits[i - 1]) {
+			return a->digits[i - 1] < b->digits[i - 1] ? -1 : 1;
+		}
+	}
+
+	return 0;
+} /* }}} */
+
+/* Adds value to acc. The value's coefficient may be modified. */
+static void php_phongo_reduce_decimal_add(php_phongo_reduce_decimal* acc, php_phongo_reduce_decimal* value) /* {{{ */
+{
+	size_t  len, i;
+	int     carry = 0;
+	uint8_t a, b;
+
+	if (acc->kind == PHONGO_REDUCE_DECIMAL_NAN || value->kind == PHONGO_REDUCE_DECIMAL_NAN) {
+		acc->kind = PHONGO_REDUCE_DECIMAL_NAN;
+		return;
+	}
+
+	/* Infinities of opposite signs cancel out to NaN */
+	if (value->kind != PHONGO_REDUCE_DECIMAL_FINITE) {
+		acc->kind = (acc->kind != PHONGO_REDUCE_DECIMAL_FINITE && acc->kind != value->kind) ? PHONGO_REDUCE_DECIMAL_NAN : value->kind;
+		return;
+	}
+
+	if (acc->kind != PHONGO_REDUCE_DECIMAL_FINITE) {
+		return;
+	}
+
+	if (value->exponent < acc->exponent) {
+		php_phongo_reduce_decimal_shift(acc, (size_t) (acc->exponent - value->exponent));
+	} else if (value->exponent > acc->exponent) {
+		php_phongo_reduce_decimal_shift(value, (size_t) (value->exponent - acc->exponent));
+	}
+
+	len         = MAX(acc->len, value->len) + 1;
+	acc->digits = erealloc(acc->digits, len);
+	memset(acc->digits + acc->len, 0, len - acc->len);
+
+	if (acc->negative == value->negative || acc->len == 0) {
+		acc->negative = value->negative;
+
+		for (i = 0; i < len; i++) {
+			b              = i < value->len ? value->digits[i] : 0;
+			carry         += acc->digits[i] + b;
+			acc->digits[i] = (uint8_t) (carry % 10);
+			carry         /= 10;
+		}
+	} else if (php_phongo_reduce_decimal_compare_magnitude(acc, value) >= 0) {
+		for (i = 0; i < len; i++) {
+			b = i < value->len ? value->digits[i] : 0;
+
+			if (acc->digits[i] < b + carry) {
+				acc->digits[i] = (uint8_t) (acc->digits[i] + 10 - b - carry);
+				carry          = 1;
+			} else {
+				acc->digits[i] = (uint8_t) (acc->digits[i] - b - carry);
+				carry          = 0;
+			}
+		}
+	} else {
+		acc->negative = value->negative;
+
+		for (i = 0; i < len; i++) {
+			a = acc->digits[i];
+			b = i < value->len ? value->digits[i] : 0;
+
+			if (b < a + carry) {
+				acc->digits[i] = (uint8_t) (b + 10 - a - carry);
+				carry          = 1;
+			} else {
+				acc->digits[i] = (uint8_t) (b - a - carry);
+				carry          = 0;
+			}
+		}
+	}
+
+	acc->len = len;
+	php_phongo_reduce_decimal_trim(acc);
+} /* }}} */
+
+/* Divides the value by a document count. The quotient is computed to more
+ * digits than Decimal128 can hold, and a non-zero remainder is recorded in an
+ * additional digit so that rounding is correct. An exact quotient keeps the
+ * dividend's exponent where possible, as with IEEE 754 decimal division.
+ * Counts are far below 10^18, so the intermediate values cannot overflow. */
+static void php_phongo_reduce_decimal_divide(php_phongo_reduce_decimal* dec, uint64_t divisor) /* {{{ */
+{
+	uint64_t remainder = 0;
+	int32_t  exponent  = dec->exponent;
+	size_t   zeros     = 0;
+	size_t   i;
+
+	if (dec->kind != PHONGO_REDUCE_DECIMAL_FINITE || dec->len == 0) {
+		return;
+	}
+
+	if (dec->len < BSON_DECIMAL128_STRING) {
+		php_phongo_reduce_decimal_shift(dec, BSON_DECIMAL128_STRING - dec->len);
+	}
+
+	for (i = dec->len; i > 0; i--) {
+		uint64_t current = remainder * 10 + dec->digits[i - 1];
+
+		dec->digits[i - 1] = (uint8_t) (current / divisor);
+		remainder          = current % divisor;
+	}
+
+	php_phongo_reduce_decimal_trim(dec);
+
+	if (remainder) {
+		php_phongo_reduce_decimal_shift(dec, 1);
+		dec->digits[0] = 1;
+		return;
+	}
+
+	while (zeros < dec->len && dec->digits[zeros] == 0 && dec->exponent + (int32_t) zeros < exponent) {
+		zeros++;
+	}
+
+	memmove(dec->digits, dec->digits + zeros, dec->len - zeros);
+	dec->len -= zeros;
+	dec->exponent += (int32_t) zeros;
+} /* }}} */
+
+/* Rounds the coefficient to the 34 digits of a Decimal128, using the
+ * round-half-to-even mode of the server's Decimal128 arithmetic. */
+static void php_phongo_reduce_decimal_round(php_phongo_reduce_decimal* dec) /* {{{ */
+{
+	size_t  drop, i;
+	uint8_t half;
+	bool    rest = false;
+
+	if (dec->len <= PHONGO_REDUCE_DECIMAL128_DIGITS) {
+		return;
+	}
+
+	drop = dec->len - PHONGO_REDUCE_DECIMAL128_DIGITS;
+	half = dec->digits[drop - 1];
+
+	for (i = 0; i + 1 < drop; i++) {
+		if (dec->digits[i]) {
+			rest = true;
+			break;
+		}
+	}
+
+	memmove(dec->digits, dec->digits + drop, PHONGO_REDUCE_DECIMAL128_DIGITS);
+	dec->len = PHONGO_REDUCE_DECIMAL128_DIGITS;
+	dec->exponent += (int32_t) drop;
+
+	if (half < 5 || (half == 5 && !rest && !(dec->digits[0] & 1))) {
+		return;
+	}
+
+	for (i = 0; i < dec->len; i++) {
+		if (++dec->digits[i] < 10) {
+			return;
+		}
+
+		dec->digits[i] = 0;
+	}
+
+	/* All digits carried over, so the coefficient is now 10^34 */
+	dec->digits[dec->len - 1] = 1;
+	dec->exponent++;
+} /* }}} */
+
+/* Converts the value to a BSON Decimal128. Returns false and throws an
+ * exception if the value cannot be represented. */
+static bool php_phongo_reduce_decimal_to_zval(php_phongo_reduce_decimal* dec, zval* zv) /* {{{ */
+{
+	smart_str    str = { 0 };
+	bson_value_t value;
+	size_t       i;
+	char         exponent[16];
+	bool         valid;
+
+	switch (dec->kind) {
+		case PHONGO_REDUCE_DECIMAL_NAN:
+			smart_str_appends(&str, "NaN");
+			break;
+
+		case PHONGO_REDUCE_DECIMAL_POS_INF:
+			smart_str_appends(&str, "Infinity");
+			break;
+
+		case PHONGO_REDUCE_DECIMAL_NEG_INF:
+			smart_str_appends(&str, "-Infinity");
+			break;
+
+		case PHONGO_REDUCE_DECIMAL_FINITE:
+			php_phongo_reduce_decimal_round(dec);
+
+			if (dec->negative) {
+				smart_str_appendc(&str, '-');
+			}
+
+			if (dec->len == 0) {
+				smart_str_appendc(&str, '0');
+			}
+
+			for (i = dec->len; i > 0; i--) {
+				smart_str_appendc(&str, (char) ('0' + dec->digits[i - 1]));
+			}
+
+			snprintf(exponent, sizeof(exponent), "E%d", (int) dec->exponent);
+			smart_str_appends(&str, exponent);
+			break;
+	}
+
+	smart_str_0(&str);
+
+	value.value_type = BSON_TYPE_DECIMAL128;
+	valid            = bson_decimal128_from_string(ZSTR_VAL(str.s), &value.value.v_decimal128);
+
+	if (!valid) {
+		phongo_throw_exception(PHONGO_ERROR_UNEXPECTED_VALUE, "Cannot represent %s as Decimal128", ZSTR_VAL(str.s));
+	}
+
+	smart_str_free(&str);
+
+	return valid && php_phongo_bson_value_to_zval(&value, zv);
+} /* }}} */
+
+/* Switches a sum to exact decimal arithmetic once a Decimal128 is encountered.
+ * As with the server's $sum, the result will then be a Decimal128. */
+static void php_phongo_reduce_acc_promote_to_decimal(php_phongo_reduce_acc* acc) /* {{{ */
+{
+	if (acc->is_double) {
+		php_phongo_reduce_decimal_from_double(acc->dsum, &acc->decsum);
+	} else {
+		php_phongo_reduce_decimal_from_int64(acc->isum, &acc->decsum);
+	}
+
+	acc->is_decimal = true;
+} /* }}} */
+
+static php_phongo_reduce_group* php_phongo_reduce_group_new(uint32_t num_ops, const bson_value_t* id) /* {{{ */
+{
+	php_phongo_reduce_group* group = ecalloc(1, sizeof(php_phongo_reduce_group));
+
+	group->accs = ecalloc(num_ops, sizeof(php_phongo_reduce_acc));
+
+	if (id) {
+		bson_value_copy(id, &group->id);
+	} else {
+		group->id.value_type = BSON_TYPE_NULL;
+	}
+
+	return group;
+} /* }}} */
+
+static void php_phongo_reduce_group_free(php_phongo_reduce_group* group, uint32_t num_ops) /* {{{ */
+{
+	uint32_t i;
+
+	for (i = 0; i < num_ops; i++) {
+		if (group->accs[i].has_value) {
+			bson_value_destroy(&group->accs[i].value);
+		}
+
+		php_phongo_reduce_decimal_dtor(&group->accs[i].decsum);
+	}
+
+	bson_value_destroy(&group->id);
+	efree(group->accs);
+	efree(group);
+} /* }}} */
+
+/* Appends a key for the grouped value, such that values the server would
+ * consider equal for grouping (e.g. 1 and 1.0, or null and a missing field)
+ * produce the same key. */
+static void php_phongo_reduce_append_group_key(smart_str* key, const bson_value_t* value) /* {{{ */
+{
+	int64_t i64;
+	bson_t  tmp;
+
+	if (!value || value->value_type == BSON_TYPE_NULL || value->value_type == BSON_TYPE_UNDEFINED) {
+		smart_str_appendc(key, 'Z');
+		return;
+	}
+
+	switch (value->value_type) {
+		case BSON_TYPE_INT32:
+		case BSON_TYPE_INT64:
+			i64 = value->value_type == BSON_TYPE_INT32 ? value->value.v_int32 : value->value.v_int64;
+			smart_str_appendc(key, 'N');
+			smart_str_appendl(key, (const char*) &i64, sizeof(i64));
+			return;
+
+		case BSON_TYPE_DOUBLE:
+			if (value->value.v_double >= -9223372036854775808.0 && value->value.v_double < 9223372036854775808.0 && value->value.v_double == (double) (int64_t) value->value.v_double) {
+				i64 = (int64_t) value->value.v_double;
+				smart_str_appendc(key, 'N');
+				smart_str_appendl(key, (const char*) &i64, sizeof(i64));
+				return;
+			}
+
+			smart_str_appendc(key, 'D');
+			smart_str_appendl(key, (const char*) &value->value.v_double, sizeof(double));
+			return;
+
+		default:
+			bson_init(&tmp);
+			bson_append_value(&tmp, "", 0, value);
+			smart_str_appendc(key, 'V');
+			smart_str_appendl(key, (const char*) bson_get_data(&tmp), tmp.len);
+			bson_destroy(&tmp);
+	}
+} /* }}} */
+
+static bool php_phongo_reduce_accumulate(php_phongo_reduce_acc* acc, php_phongo_reduce_op_type type, const bson_value_t* value) /* {{{ */
+{
+	php_phongo_reduce_decimal addend;
+
+	switch (type) {
+		case PHONGO_REDUCE_SUM:
+		case PHONGO_REDUCE_AVG:
+			/* As with the server's $sum and $avg, non-numeric values are ignored */
+			switch (value->value_type) {
+				case BSON_TYPE_INT32:
+				case BSON_TYPE_INT64: {
+					int64_t v = value->value_type == BSON_TYPE_INT32 ? value->value.v_int32 : value->value.v_int64;
+
+					if (acc->is_decimal) {
+						php_phongo_reduce_decimal_from_int64(v, &addend);
+						php_phongo_reduce_decimal_add(&acc->decsum, &addend);
+						php_phongo_reduce_decimal_dtor(&addend);
+						break;
+					}
+
+					if (!acc->is_double && ((v > 0 && acc->isum > INT64_MAX - v) || (v < 0 && acc->isum < INT64_MIN - v))) {
+						acc->is_double = true;
+						acc->dsum      = (double) acc->isum;
+					}
+
+					if (acc->is_double) {
+						acc->dsum += (double) v;
+					} else {
+						acc->isum += v;
+					}
+
+					break;
+				}
+
+				case BSON_TYPE_DOUBLE:
+					if (acc->is_decimal) {
+						php_phongo_reduce_decimal_from_double(value->value.v_double, &addend);
+						php_phongo_reduce_decimal_add(&acc->decsum, &addend);
+						php_phongo_reduce_decimal_dtor(&addend);
+						break;
+					}
+
+					if (!acc->is_double) {
+						acc->is_double = true;
+						acc->dsum      = (double) acc->isum;
+					}
+
+					acc->dsum += value->value.v_double;
+					break;
+
+				case BSON_TYPE_DECIMAL128:
+					if (!acc->is_decimal) {
+						php_phongo_reduce_acc_promote_to_decimal(acc);
+					}
+
+					php_phongo_reduce_decimal_from_decimal128(&value->value.v_decimal128, &addend);
+					php_phongo_reduce_decimal_add(&acc->decsum, &addend);
+					php_phongo_reduce_decimal_dtor(&addend);
+					break;
+
+				default:
+					return true;
+			}
+
+			acc->num_values++;
+			return true;
+
+		case PHONGO_REDUCE_MIN:
+		case PHONGO_REDUCE_MAX:
+			/* As with the server's $min and $max, null values are ignored */
+			if (value->value_type == BSON_TYPE_NULL || value->value_type == BSON_TYPE_UNDEFINED) {
+				return true;
+			}
+
+			if (acc->has_value) {
+				int cmp = php_phongo_bson_value_compare(value, &acc->value);
+
+				if ((type == PHONGO_REDUCE_MIN && cmp >= 0) || (type == PHONGO_REDUCE_MAX && cmp <= 0)) {
+					return true;
+				}
+
+				bson_value_destroy(&acc->value);
+			}
+
+			bson_value_copy(value, &acc->value);
+			acc->has_value = true;
+			return true;
+	}
+
+	return true;
+} /* }}} */
+
+static bool php_phongo_reduce_visitor(const bson_t* doc, void* data) /* {{{ */
+{
+	php_phongo_reduce_state* state = (php_phongo_reduce_state*) data;
+	php_phongo_reduce_group* group = state->single;
+	bson_iter_t              iter;
+	bson_iter_t              child;
+	uint32_t                 i;
+
+	if (state->group_by) {
+		const bson_value_t* id = NULL;
+
+		if (bson_iter_init(&iter, doc) && bson_iter_find_descendant(&iter, ZSTR_VAL(state->group_by), &child)) {
+			id = bson_iter_value(&child);
+		}
+
+		/* The key buffer is reused for each document, so the string variants
+		 * of the hash functions are used to avoid caching its hash value or
+		 * sharing it with the groups table. */
+		if (state->key.s) {
+			ZSTR_LEN(state->key.s) = 0;
+		}
+
+		php_phongo_reduce_append_group_key(&state->key, id);
+
+		if (!(group = zend_hash_str_find_ptr(&state->groups, ZSTR_VAL(state->key.s), ZSTR_LEN(state->key.s)))) {
+			group = php_phongo_reduce_group_new(state->num_ops, id);
+			zend_hash_str_add_new_ptr(&state->groups, ZSTR_VAL(state->key.s), ZSTR_LEN(state->key.s), group);
+		}
+	}
+
+	group->count++;
+
+	for (i = 0; i < state->num_ops; i++) {
+		if (!bson_iter_init(&iter, doc) || !bson_iter_find_descendant(&iter, ZSTR_VAL(state->ops[i].field), &child)) {
+			continue;
+		}
+
+		if (!php_phongo_reduce_accumulate(&group->accs[i], state->ops[i].type, bson_iter_value(&child))) {
+			/* Exception should already have been thrown */
+			return false;
+		}
+	}
+
+	return true;
+} /* }}} */
+
+static void php_phongo_reduce_int64_to_zval(int64_t value, zval* zv) /* {{{ */
+{
+	bson_value_t bvalue;
+
+	bvalue.value_type    = BSON_TYPE_INT64;
+	bvalue.value.v_int64 = value;
+
+	php_phongo_bson_value_to_zval(&bvalue, zv);
+} /* }}} */
+
+static bool php_phongo_reduce_acc_to_zval(php_phongo_reduce_acc* acc, php_phongo_reduce_op_type type, zval* zv) /* {{{ */
+{
+	switch (type) {
+		case PHONGO_REDUCE_SUM:
+			if (acc->is_decimal) {
+				return php_phongo_reduce_decimal_to_zval(&acc->decsum, zv);
+			}
+
+			if (acc->is_double) {
+				ZVAL_DOUBLE(zv, acc->dsum);
+			} else {
+				php_phongo_reduce_int64_to_zval(acc->isum, zv);
+			}
+			return true;
+
+		case PHONGO_REDUCE_AVG:
+			if (acc->num_values == 0) {
+				ZVAL_NULL(zv);
+			} else if (acc->is_decimal) {
+				php_phongo_reduce_decimal_divide(&acc->decsum, (uint64_t) acc->num_values);
+				return php_phongo_reduce_decimal_to_zval(&acc->decsum, zv);
+			} else {
+				ZVAL_DOUBLE(zv, (acc->is_double ? acc->dsum : (double) acc->isum) / (double) acc->num_values);
+			}
+			return true;
+
+		case PHONGO_REDUCE_MIN:
+		case PHONGO_REDUCE_MAX:
+			if (!acc->has_value) {
+				ZVAL_NULL(zv);
+				return true;
+			}
+
+			return php_phongo_bson_value_to_zval(&acc->value, zv);
+	}
+
+	ZVAL_NULL(zv);
+	return true;
+} /* }}} */
+
+/* Populates the results for a single group. The spec is walked in the same
+ * order used to create the operations, so that each string value yields a
+ * single result and each array value yields results keyed by field. */
+static bool php_phongo_reduce_group_to_zval(php_phongo_reduce_state* state, zval* spec, php_phongo_reduce_group* group, zval* retval) /* {{{ */
+{
+	zend_string* reducer;
+	zval*        value;
+	uint32_t     i = 0;
+
+	if (state->group_by) {
+		zval id;
+
+		if (!php_phongo_bson_value_to_zval(&group->id, &id)) {
+			/* Exception should already have been thrown */
+			return false;
+		}
+
+		ADD_ASSOC_ZVAL_EX(retval, "_id", &id);
+	}
+
+	{
+		zval count;
+
+		php_phongo_reduce_int64_to_zval(group->count, &count);
+		ADD_ASSOC_ZVAL_EX(retval, "count", &count);
+	}
+
+	ZEND_HASH_FOREACH_STR_KEY_VAL(Z_ARRVAL_P(spec), reducer, value)
+	{
+		zval result;
+
+		if (zend_string_equals_literal(reducer, "groupBy") || zend_string_equals_literal(reducer, "count")) {
+			continue;
+		}
+
+		if (Z_TYPE_P(value) == IS_STRING) {
+			if (!php_phongo_reduce_acc_to_zval(&group->accs[i], state->ops[i].type, &result)) {
+				return false;
+			}
+
+			i++;
+		} else {
+			zval* field;
+
+			array_init(&result);
+
+			ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(value), field)
+			{
+				zval field_result;
+
+				if (!php_phongo_reduce_acc_to_zval(&group->accs[i], state->ops[i].type, &field_result)) {
+					zval_ptr_dtor(&result);
+					return false;
+				}
+
+				zend_symtable_update(Z_ARRVAL(result), Z_STR_P(field), &field_result);
+				i++;
+			}
+			ZEND_HASH_FOREACH_END();
+		}
+
+		zend_hash_update(Z_ARRVAL_P(retval), reducer, &result);
+	}
+	ZEND_HASH_FOREACH_END();
+
+	return true;
+} /* }}} */
+
+static bool php_phongo_reduce_parse_op_type(zend_string* reducer, php_phongo_reduce_op_type* type) /* {{{ */
+{
+	if (zend_string_equals_literal(reducer, "sum")) {
+		*type = PHONGO_REDUCE_SUM;
+	} else if (zend_string_equals_literal(reducer, "avg")) {
+		*type = PHONGO_REDUCE_AVG;
+	} else if (zend_string_equals_literal(reducer, "min")) {
+		*type = PHONGO_REDUCE_MIN;
+	} else if (zend_string_equals_literal(reducer, "max")) {
+		*type = PHONGO_REDUCE_MAX;
+	} else {
+		return false;
+	}
+
+	return true;
+} /* }}} */
+
+static bool php_phongo_reduce_is_valid_field(zval* field) /* {{{ */
+{
+	return Z_TYPE_P(field) == IS_STRING && Z_STRLEN_P(field) > 0 && strlen(Z_STRVAL_P(field)) == Z_STRLEN_P(field);
+} /* }}} */
+
 /* {{{ proto void MongoDB\Driver\Cursor::setTypeMap(array $typemap)
    Sets a type map to use for BSON unserialization */
 static PHP_METHOD(Cursor, setTypeMap)
@@ -149,6 +1192,382 @@ static PHP_METHOD(Cursor, toArray)
 	}
 } /* }}} */
 
+/* {{{ proto MongoDB\Driver\ResultSet MongoDB\Driver\Cursor::toResultSet()
+   Drains all remaining result documents into a temporary file and returns a
+   ResultSet, which may be counted, accessed by index, and iterated repeatedly
+   without holding every document in memory */
+static PHP_METHOD(Cursor, toResultSet)
+{
+	zend_error_handling  error_handling;
+	php_phongo_cursor_t* intern;
+
+	intern = Z_CURSOR_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	if (!phongo_resultset_init(return_value, intern)) {
+		/* Exception should already have been thrown */
+		return;
+	}
+} /* }}} */
+
+/* {{{ proto integer MongoDB\Driver\Cursor::writeTo(resource $stream [, integer $format = MongoDB\Driver\Cursor::FORMAT_BSON])
+   Writes all remaining result documents to a stream without converting them to
+   PHP values and returns the number of documents written */
+static PHP_METHOD(Cursor, writeTo)
+{
+	zend_error_handling           error_handling;
+	php_phongo_cursor_t*          intern;
+	zval*                         zstream;
+	zend_long                     format = PHONGO_CURSOR_FORMAT_BSON;
+	php_stream*                   stream;
+	php_phongo_cursor_write_state state;
+
+	intern = Z_CURSOR_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "r|l", &zstream, &format) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	/* Fetching the stream may raise an error for other resource types, which
+	 * should also be reported as an InvalidArgumentException. */
+	php_stream_from_zval_no_verify(stream, zstream);
+	zend_restore_error_handling(&error_handling);
+
+	if (!stream) {
+		if (!EG(exception)) {
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected a stream resource");
+		}
+		return;
+	}
+
+	switch (format) {
+		case PHONGO_CURSOR_FORMAT_BSON:
+		case PHONGO_CURSOR_FORMAT_RELAXED_EXTENDED_JSON:
+		case PHONGO_CURSOR_FORMAT_CANONICAL_EXTENDED_JSON:
+		case PHONGO_CURSOR_FORMAT_JSON_ARRAY:
+			break;
+
+		default:
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Invalid format: %" PHONGO_LONG_FORMAT, format);
+			return;
+	}
+
+	memset(&state, 0, sizeof(state));
+	state.stream = stream;
+	state.format = (php_phongo_cursor_format_t) format;
+
+	if (state.format == PHONGO_CURSOR_FORMAT_JSON_ARRAY) {
+		smart_str_appendc(&state.buffer, '[');
+	}
+
+	if (!php_phongo_cursor_visit_raw(intern, php_phongo_cursor_write_visitor, &state)) {
+		/* Exception should already have been thrown */
+		goto cleanup;
+	}
+
+	if (state.format == PHONGO_CURSOR_FORMAT_JSON_ARRAY) {
+		smart_str_appendc(&state.buffer, ']');
+	}
+
+	if (!php_phongo_cursor_write_flush(&state)) {
+		/* Exception should already have been thrown */
+		goto cleanup;
+	}
+
+	RETVAL_LONG(state.count);
+
+cleanup:
+	smart_str_free(&state.buffer);
+} /* }}} */
+
+/* {{{ proto array MongoDB\Driver\Cursor::toColumns(array $fields [, array $options = array()])
+   Returns an array of per-field value lists for all result documents. Fields
+   may use dot notation to address embedded values. Documents are never fully
+   converted to PHP values; extracted documents and arrays use the default type
+   map. */
+static PHP_METHOD(Cursor, toColumns)
+{
+	zend_error_handling             error_handling;
+	php_phongo_cursor_t*            intern;
+	zval*                           zfields;
+	zval*                           options = NULL;
+	zval*                           zfield;
+	zval                            missing_value;
+	php_phongo_cursor_columns_state state;
+	uint32_t                        num_fields;
+	uint32_t                        i;
+
+	intern = Z_CURSOR_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "a|a!", &zfields, &options) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	num_fields = zend_hash_num_elements(Z_ARRVAL_P(zfields));
+
+	if (num_fields == 0) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected at least one field");
+		return;
+	}
+
+	ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(zfields), zfield)
+	{
+		if (Z_TYPE_P(zfield) != IS_STRING) {
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected fields to contain only strings, %s given", PHONGO_ZVAL_CLASS_OR_TYPE_NAME_P(zfield));
+			return;
+		}
+
+		if (Z_STRLEN_P(zfield) == 0 || strlen(Z_STRVAL_P(zfield)) != Z_STRLEN_P(zfield)) {
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected field names to be non-empty and not contain null bytes");
+			return;
+		}
+	}
+	ZEND_HASH_FOREACH_END();
+
+	if (options && php_array_existsc(options, "missingValue")) {
+		ZVAL_COPY(&missing_value, php_array_fetchc(options, "missingValue"));
+	} else {
+		ZVAL_NULL(&missing_value);
+	}
+
+	memset(&state, 0, sizeof(state));
+	state.fields        = ecalloc(num_fields, sizeof(zend_string*));
+	state.is_path       = ecalloc(num_fields, sizeof(bool));
+	state.found         = ecalloc(num_fields, sizeof(bool));
+	state.columns       = ecalloc(num_fields, sizeof(zval));
+	state.missing_value = &missing_value;
+	zend_hash_init(&state.top_level_fields, num_fields, NULL, NULL, 0);
+
+	ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(zfields), zfield)
+	{
+		bool duplicate = false;
+
+		/* Duplicate field names would share a key in the returned array */
+		for (i = 0; i < state.num_fields; i++) {
+			if (zend_string_equals(state.fields[i], Z_STR_P(zfield))) {
+				duplicate = true;
+				break;
+			}
+		}
+
+		if (duplicate) {
+			continue;
+		}
+
+		i = state.num_fields++;
+
+		state.fields[i]  = Z_STR_P(zfield);
+		state.is_path[i] = memchr(Z_STRVAL_P(zfield), '.', Z_STRLEN_P(zfield)) != NULL;
+
+		array_init(&state.columns[i]);
+		zend_hash_real_init(Z_ARRVAL(state.columns[i]), 1);
+
+		if (!state.is_path[i]) {
+			zval index;
+
+			ZVAL_LONG(&index, i);
+			zend_hash_update(&state.top_level_fields, state.fields[i], &index);
+			state.num_top_level_fields++;
+		}
+	}
+	ZEND_HASH_FOREACH_END();
+
+	if (!php_phongo_cursor_visit_raw(intern, php_phongo_cursor_columns_visitor, &state)) {
+		/* Exception should already have been thrown */
+		for (i = 0; i < state.num_fields; i++) {
+			zval_ptr_dtor(&state.columns[i]);
+		}
+
+		goto cleanup;
+	}
+
+	array_init_size(return_value, state.num_fields);
+
+	for (i = 0; i < state.num_fields; i++) {
+		zend_symtable_update(Z_ARRVAL_P(return_value), state.fields[i], &state.columns[i]);
+	}
+
+cleanup:
+	zend_hash_destroy(&state.top_level_fields);
+	efree(state.fields);
+	efree(state.is_path);
+	efree(state.found);
+	efree(state.columns);
+	zval_ptr_dtor(&missing_value);
+} /* }}} */
+
+/* {{{ proto array MongoDB\Driver\Cursor::reduce(array $spec)
+   Drains the cursor and returns the count and any sum, avg, min, or max
+   reductions over the given fields, optionally grouped by another field.
+   Documents are never converted to PHP values. As with the server, a sum or
+   avg that includes a Decimal128 value is returned as a Decimal128. */
+static PHP_METHOD(Cursor, reduce)
+{
+	zend_error_handling     error_handling;
+	php_phongo_cursor_t*    intern;
+	zval*                   spec;
+	zend_string*            reducer;
+	zval*                   value;
+	php_phongo_reduce_state state;
+	uint32_t                num_ops = 0;
+
+	intern = Z_CURSOR_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "a", &spec) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	memset(&state, 0, sizeof(state));
+
+	ZEND_HASH_FOREACH_STR_KEY_VAL(Z_ARRVAL_P(spec), reducer, value)
+	{
+		php_phongo_reduce_op_type type;
+
+		if (!reducer) {
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected reducer names to be strings");
+			return;
+		}
+
+		if (zend_string_equals_literal(reducer, "count")) {
+			/* The count is always returned */
+			continue;
+		}
+
+		if (zend_string_equals_literal(reducer, "groupBy")) {
+			if (!php_phongo_reduce_is_valid_field(value)) {
+				phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected \"groupBy\" to be a non-empty field name");
+				return;
+			}
+
+			state.group_by = Z_STR_P(value);
+			continue;
+		}
+
+		if (!php_phongo_reduce_parse_op_type(reducer, &type)) {
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Unsupported reducer: \"%s\"", ZSTR_VAL(reducer));
+			return;
+		}
+
+		if (Z_TYPE_P(value) == IS_ARRAY && zend_hash_num_elements(Z_ARRVAL_P(value)) > 0) {
+			zval* field;
+
+			ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(value), field)
+			{
+				if (!php_phongo_reduce_is_valid_field(field)) {
+					phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected \"%s\" reducer to contain only non-empty field names", ZSTR_VAL(reducer));
+					return;
+				}
+
+				num_ops++;
+			}
+			ZEND_HASH_FOREACH_END();
+		} else if (php_phongo_reduce_is_valid_field(value)) {
+			num_ops++;
+		} else {
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected \"%s\" reducer to be a field name or a non-empty array of field names, %s given", ZSTR_VAL(reducer), PHONGO_ZVAL_CLASS_OR_TYPE_NAME_P(value));
+			return;
+		}
+	}
+	ZEND_HASH_FOREACH_END();
+
+	state.ops = ecalloc(num_ops ? num_ops : 1, sizeof(php_phongo_reduce_op));
+
+	ZEND_HASH_FOREACH_STR_KEY_VAL(Z_ARRVAL_P(spec), reducer, value)
+	{
+		php_phongo_reduce_op_type type;
+
+		if (!php_phongo_reduce_parse_op_type(reducer, &type)) {
+			continue;
+		}
+
+		if (Z_TYPE_P(value) == IS_STRING) {
+			state.ops[state.num_ops].type  = type;
+			state.ops[state.num_ops].field = Z_STR_P(value);
+			state.num_ops++;
+		} else {
+			zval* field;
+
+			ZEND_HASH_FOREACH_VAL(Z_ARRVAL_P(value), field)
+			{
+				state.ops[state.num_ops].type  = type;
+				state.ops[state.num_ops].field = Z_STR_P(field);
+				state.num_ops++;
+			}
+			ZEND_HASH_FOREACH_END();
+		}
+	}
+	ZEND_HASH_FOREACH_END();
+
+	zend_hash_init(&state.groups, 8, NULL, NULL, 0);
+
+	if (!state.group_by) {
+		state.single = php_phongo_reduce_group_new(state.num_ops, NULL);
+	}
+
+	if (!php_phongo_cursor_visit_raw(intern, php_phongo_reduce_visitor, &state)) {
+		/* Exception should already have been thrown */
+		goto cleanup;
+	}
+
+	array_init(return_value);
+
+	if (state.single) {
+		if (!php_phongo_reduce_group_to_zval(&state, spec, state.single, return_value)) {
+			zval_ptr_dtor(return_value);
+			ZVAL_UNDEF(return_value);
+		}
+	} else {
+		php_phongo_reduce_group* group;
+
+		ZEND_HASH_FOREACH_PTR(&state.groups, group)
+		{
+			zval zgroup;
+
+			array_init(&zgroup);
+
+			if (!php_phongo_reduce_group_to_zval(&state, spec, group, &zgroup)) {
+				zval_ptr_dtor(&zgroup);
+				zval_ptr_dtor(return_value);
+				ZVAL_UNDEF(return_value);
+				break;
+			}
+
+			add_next_index_zval(return_value, &zgroup);
+		}
+		ZEND_HASH_FOREACH_END();
+	}
+
+cleanup:
+	if (state.single) {
+		php_phongo_reduce_group_free(state.single, state.num_ops);
+	} else {
+		php_phongo_reduce_group* group;
+
+		ZEND_HASH_FOREACH_PTR(&state.groups, group)
+		{
+			php_phongo_reduce_group_free(group, state.num_ops);
+		}
+		ZEND_HASH_FOREACH_END();
+	}
+
+	zend_hash_destroy(&state.groups);
+	smart_str_free(&state.key);
+	efree(state.ops);
+} /* }}} */
+
 /* {{{ proto MongoDB\Driver\CursorId MongoDB\Driver\Cursor::getId()
    Returns the CursorId for this cursor */
 static PHP_METHOD(Cursor, getId)
@@ -354,6 +1773,20 @@ ZEND_BEGIN_ARG_INFO_EX(ai_Cursor_setTypeMap, 0, 0, 1)
 	ZEND_ARG_ARRAY_INFO(0, typemap, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(ai_Cursor_reduce, 0, 0, 1)
+	ZEND_ARG_ARRAY_INFO(0, spec, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(ai_Cursor_toColumns, 0, 0, 1)
+	ZEND_ARG_ARRAY_INFO(0, fields, 0)
+	ZEND_ARG_ARRAY_INFO(0, options, 1)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(ai_Cursor_writeTo, 0, 0, 1)
+	ZEND_ARG_INFO(0, stream)
+	ZEND_ARG_INFO(0, format)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(ai_Cursor_void, 0, 0, 0)
 ZEND_END_ARG_INFO()
 
@@ -361,6 +1794,10 @@ static zend_function_entry php_phongo_cursor_me[] = {
 	/* clang-format off */
 	PHP_ME(Cursor, setTypeMap, ai_Cursor_setTypeMap, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Cursor, toArray, ai_Cursor_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(Cursor, toColumns, ai_Cursor_toColumns, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(Cursor, reduce, ai_Cursor_reduce, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(Cursor, toResultSet, ai_Cursor_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(Cursor, writeTo, ai_Cursor_writeTo, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Cursor, getId, ai_Cursor_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Cursor, getServer, ai_Cursor_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Cursor, isDead, ai_Cursor_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
@@ -531,6 +1968,11 @@ void php_phongo_cursor_init_ce(INIT_FUNC_ARGS) /* {{{ */
 	zend_class_implements(php_phongo_cursor_ce, 1, zend_ce_iterator);
 	zend_class_implements(php_phongo_cursor_ce, 1, php_phongo_cursor_interface_ce);
 
+	zend_declare_class_constant_long(php_phongo_cursor_ce, ZEND_STRL("FORMAT_BSON"), PHONGO_CURSOR_FORMAT_BSON);
+	zend_declare_class_constant_long(php_phongo_cursor_ce, ZEND_STRL("FORMAT_RELAXED_EXTENDED_JSON"), PHONGO_CURSOR_FORMAT_RELAXED_EXTENDED_JSON);
+	zend_declare_class_constant_long(php_phongo_cursor_ce, ZEND_STRL("FORMAT_CANONICAL_EXTENDED_JSON"), PHONGO_CURSOR_FORMAT_CANONICAL_EXTENDED_JSON);
+	zend_declare_class_constant_long(php_phongo_cursor_ce, ZEND_STRL("FORMAT_JSON_ARRAY"), PHONGO_CURSOR_FORMAT_JSON_ARRAY);
+
 	memcpy(&php_phongo_handler_cursor, phongo_get_std_object_handlers(), sizeof(zend_object_handlers));
 	php_phongo_handler_cursor.get_debug_info = php_phongo_cursor_get_debug_info;
 	php_phongo_handler_cursor.free_obj       = php_phongo_cursor_free_object;
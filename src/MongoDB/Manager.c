@@ -193,9 +193,13 @@ static void php_phongo_manager_prep_uri_options(zval* options) /* {{{ */
  * will be checked whether it is pinned to a server. If so, that server will be
  * selected. Otherwise, server selection
  *
+ * If use_cache is true and only one server was eligible, the selected server is
+ * cached on the client until its topology changes or its heartbeat interval
+ * elapses, whichever comes first.
+ *
  * On success, server_id will be set and the function will return true;
  * otherwise, false is returned and an exception is thrown. */
-static bool php_phongo_manager_select_server(bool for_writes, bool inherit_read_preference, zval* zreadPreference, zval* zsession, mongoc_client_t* client, uint32_t* server_id) /* {{{ */
+static bool php_phongo_manager_select_server_with_cache(bool for_writes, bool inherit_read_preference, zval* zreadPreference, zval* zsession, php_phongo_manager_t* manager, bool use_cache, uint32_t* server_id) /* {{{ */
 {
 	mongoc_server_description_t* selected_server;
 	const mongoc_read_prefs_t*   read_preference = NULL;
@@ -216,14 +220,36 @@ static bool php_phongo_manager_select_server(bool for_writes, bool inherit_read_
 		if (zreadPreference) {
 			read_preference = phongo_read_preference_from_zval(zreadPreference);
 		} else if (inherit_read_preference) {
-			read_preference = mongoc_client_get_read_prefs(client);
+			read_preference = phongo_manager_get_read_prefs(manager);
 		}
 	}
 
-	selected_server = mongoc_client_select_server(client, for_writes, read_preference, &error);
+	/* Reuse a previous result if the topology has not changed since */
+	if (use_cache && manager->pclient && php_phongo_pclient_find_selected_server(manager->pclient, for_writes, read_preference, server_id)) {
+		return true;
+	}
+
+	/* Fail immediately while a recent selection failure has opened the
+	 * circuit breaker for this operation type and read preference, rather
+	 * than blocking for the full timeout */
+	if (manager->pclient && php_phongo_pclient_circuit_breaker_is_open(manager->pclient, for_writes, read_preference, &error)) {
+		phongo_throw_exception_from_bson_error_t(&error);
+		return false;
+	}
+
+	selected_server = mongoc_client_select_server(manager->client, for_writes, read_preference, &error);
+
+	if (manager->pclient) {
+		php_phongo_pclient_record_selection(manager->pclient, for_writes, read_preference, selected_server != NULL);
+	}
 
 	if (selected_server) {
 		*server_id = mongoc_server_description_id(selected_server);
+
+		if (use_cache && manager->pclient) {
+			php_phongo_pclient_add_selected_server(manager->pclient, for_writes, read_preference, selected_server);
+		}
+
 		mongoc_server_description_destroy(selected_server);
 
 		return true;
@@ -237,6 +263,11 @@ static bool php_phongo_manager_select_server(bool for_writes, bool inherit_read_
 	return false;
 } /* }}} */
 
+bool php_phongo_manager_select_server(bool for_writes, bool inherit_read_preference, zval* zreadPreference, zval* zsession, php_phongo_manager_t* manager, uint32_t* server_id) /* {{{ */
+{
+	return php_phongo_manager_select_server_with_cache(for_writes, inherit_read_preference, zreadPreference, zsession, manager, true, server_id);
+} /* }}} */
+
 /* {{{ proto void MongoDB\Driver\Manager::__construct([string $uri = "mongodb://127.0.0.1/"[, array $options = array()[, array $driverOptions = array()]]])
    Constructs a new Manager */
 static PHP_METHOD(Manager, __construct)
@@ -306,6 +337,26 @@ static PHP_METHOD(Manager, createClientEncryption)
 	phongo_clientencryption_init(clientencryption, getThis(), options);
 } /* }}} */
 
+/* {{{ proto void MongoDB\Driver\Manager::deferBulkWrite(string $namespace, MongoDB\Driver\BulkWrite $zbulk)
+   Queues a BulkWrite to be executed with an unacknowledged write concern at
+   the end of the request or when flushDeferredWrites() is called */
+static PHP_METHOD(Manager, deferBulkWrite)
+{
+	zend_error_handling error_handling;
+	char*               namespace;
+	size_t              namespace_len;
+	zval*               zbulk;
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "sO", &namespace, &namespace_len, &zbulk, php_phongo_bulkwrite_ce) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	phongo_defer_bulk_write(getThis(), namespace, zbulk);
+} /* }}} */
+
 /* {{{ proto MongoDB\Driver\Cursor MongoDB\Driver\Manager::executeCommand(string $db, MongoDB\Driver\Command $command[, array $options = null])
    Execute a Command */
 static PHP_METHOD(Manager, executeCommand)
@@ -342,7 +393,7 @@ static PHP_METHOD(Manager, executeCommand)
 		goto cleanup;
 	}
 
-	if (!php_phongo_manager_select_server(false, false, zreadPreference, zsession, intern->client, &server_id)) {
+	if (!php_phongo_manager_select_server(false, false, zreadPreference, zsession, intern, &server_id)) {
 		/* Exception should already have been thrown */
 		goto cleanup;
 	}
@@ -393,7 +444,7 @@ static PHP_METHOD(Manager, executeReadCommand)
 		return;
 	}
 
-	if (!php_phongo_manager_select_server(false, true, zreadPreference, zsession, intern->client, &server_id)) {
+	if (!php_phongo_manager_select_server(false, true, zreadPreference, zsession, intern, &server_id)) {
 		/* Exception should already have been thrown */
 		return;
 	}
@@ -433,7 +484,7 @@ static PHP_METHOD(Manager, executeWriteCommand)
 		return;
 	}
 
-	if (!php_phongo_manager_select_server(true, false, NULL, zsession, intern->client, &server_id)) {
+	if (!php_phongo_manager_select_server(true, false, NULL, zsession, intern, &server_id)) {
 		/* Exception should already have been thrown */
 		return;
 	}
@@ -473,7 +524,7 @@ static PHP_METHOD(Manager, executeReadWriteCommand)
 		return;
 	}
 
-	if (!php_phongo_manager_select_server(true, false, NULL, zsession, intern->client, &server_id)) {
+	if (!php_phongo_manager_select_server(true, false, NULL, zsession, intern, &server_id)) {
 		/* Exception should already have been thrown */
 		return;
 	}
@@ -522,7 +573,7 @@ static PHP_METHOD(Manager, executeQuery)
 		goto cleanup;
 	}
 
-	if (!php_phongo_manager_select_server(false, true, zreadPreference, zsession, intern->client, &server_id)) {
+	if (!php_phongo_manager_select_server(false, true, zreadPreference, zsession, intern, &server_id)) {
 		/* Exception should already have been thrown */
 		goto cleanup;
 	}
@@ -540,6 +591,197 @@ cleanup:
 	}
 } /* }}} */
 
+/* Appends a range filter on _id for a partition of a parallel scan to the
+ * given document. Using $not for the upper bound ensures that documents with an
+ * _id of a different type than the split points are still matched by the first
+ * partition, since range operators only match values of the same type. */
+static void php_phongo_manager_append_partition_range(bson_t* filter, const bson_value_t* lower, const bson_value_t* upper) /* {{{ */
+{
+	bson_t id, not;
+
+	bson_append_document_begin(filter, "_id", 3, &id);
+
+	if (lower) {
+		bson_append_value(&id, "$gte", 4, lower);
+	}
+
+	if (upper) {
+		bson_append_document_begin(&id, "$not", 4, &not);
+		bson_append_value(&not, "$gte", 4, upper);
+		bson_append_document_end(&id, &not);
+	}
+
+	bson_append_document_end(filter, &id);
+} /* }}} */
+
+/* Checks that a query may be partitioned. Limits and skips would be applied to
+ * each partition rather than the overall result, and each partition's results
+ * would only be sorted within that partition. Returns true if the query is
+ * valid; otherwise, false is returned and an exception is thrown. */
+static bool php_phongo_manager_check_partitionable_query(zval* zquery) /* {{{ */
+{
+	const php_phongo_query_t* query = Z_QUERY_OBJ_P(zquery);
+	bson_iter_t               iter;
+
+	if (bson_iter_init_find(&iter, query->opts, "sort")) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Parallel scans do not support the \"sort\" query option");
+		return false;
+	}
+
+	if (bson_iter_init_find(&iter, query->opts, "limit") && bson_iter_as_int64(&iter) != 0) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Parallel scans do not support the \"limit\" query option");
+		return false;
+	}
+
+	if (bson_iter_init_find(&iter, query->opts, "skip") && bson_iter_as_int64(&iter) != 0) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Parallel scans do not support the \"skip\" query option");
+		return false;
+	}
+
+	return true;
+} /* }}} */
+
+/* Executes one partition of a parallel scan and appends its cursor to the
+ * return value array. */
+static bool php_phongo_manager_execute_partition(zval* manager, const char* namespace, zval* zquery, zval* options, zval* zreadPreference, zval* zsession, const bson_value_t* lower, const bson_value_t* upper, zval* return_value) /* {{{ */
+{
+	const php_phongo_query_t* query = Z_QUERY_OBJ_P(zquery);
+	bson_t                    filter = BSON_INITIALIZER;
+	zval                      zpartition;
+	zval                      zcursor;
+	uint32_t                  server_id = 0;
+	bool                      retval    = false;
+
+	if (bson_empty(query->filter)) {
+		php_phongo_manager_append_partition_range(&filter, lower, upper);
+	} else {
+		bson_t and, range;
+
+		bson_append_array_begin(&filter, "$and", 4, &and);
+		bson_append_document(&and, "0", 1, query->filter);
+		bson_append_document_begin(&and, "1", 1, &range);
+		php_phongo_manager_append_partition_range(&range, lower, upper);
+		bson_append_document_end(&and, &range);
+		bson_append_array_end(&filter, &and);
+	}
+
+	phongo_query_init_with_filter(&zpartition, zquery, &filter);
+	bson_destroy(&filter);
+
+	/* Selecting a server for each partition allows partitions to be spread
+	 * across all servers suitable for the read preference. The selection cache
+	 * is bypassed so that each partition is selected independently. */
+	if (!php_phongo_manager_select_server_with_cache(false, true, zreadPreference, zsession, Z_MANAGER_OBJ_P(manager), false, &server_id)) {
+		/* Exception should already have been thrown */
+		goto cleanup;
+	}
+
+	if (!phongo_execute_query(manager, namespace, &zpartition, options, server_id, &zcursor)) {
+		/* Exception should already have been thrown */
+		goto cleanup;
+	}
+
+	add_next_index_zval(return_value, &zcursor);
+	retval = true;
+
+cleanup:
+	zval_ptr_dtor(&zpartition);
+
+	return retval;
+} /* }}} */
+
+/* {{{ proto MongoDB\Driver\Cursor[] MongoDB\Driver\Manager::executeParallelScan(string $namespace, MongoDB\Driver\Query $query, integer $partitions[, array $options = array()])
+   Splits a query into partitions over disjoint _id ranges and executes each
+   partition on a separately selected server, returning a list of cursors */
+static PHP_METHOD(Manager, executeParallelScan)
+{
+	zend_error_handling   error_handling;
+	php_phongo_manager_t* intern;
+	char*                 namespace;
+	size_t                namespace_len;
+	zval*                 query;
+	zend_long             partitions;
+	zval*                 options         = NULL;
+	zval*                 zreadPreference = NULL;
+	zval*                 zsession        = NULL;
+	uint32_t              server_id       = 0;
+	bson_t                split_points    = BSON_INITIALIZER;
+	bson_iter_t           iter;
+	bson_value_t          lower;
+	bool                  has_lower = false;
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "sOl|a!", &namespace, &namespace_len, &query, php_phongo_query_ce, &partitions, &options) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	intern = Z_MANAGER_OBJ_P(getThis());
+
+	if (partitions < 1 || partitions > PHONGO_PARALLEL_SCAN_MAX_PARTITIONS) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected partitions to be between 1 and %d, %" PHONGO_LONG_FORMAT " given", PHONGO_PARALLEL_SCAN_MAX_PARTITIONS, partitions);
+		return;
+	}
+
+	if (!php_phongo_manager_check_partitionable_query(query)) {
+		/* Exception should already have been thrown */
+		return;
+	}
+
+	if (!phongo_parse_session(options, intern->client, NULL, &zsession)) {
+		/* Exception should already have been thrown */
+		return;
+	}
+
+	if (!phongo_parse_read_preference(options, &zreadPreference)) {
+		/* Exception should already have been thrown */
+		return;
+	}
+
+	PHONGO_RESET_CLIENT_IF_PID_DIFFERS(intern, intern);
+
+	if (partitions > 1) {
+		if (!php_phongo_manager_select_server(false, true, zreadPreference, zsession, intern, &server_id)) {
+			/* Exception should already have been thrown */
+			goto cleanup;
+		}
+
+		if (!phongo_query_get_split_points(getThis(), namespace, query, zreadPreference, zsession, server_id, partitions, &split_points)) {
+			/* Exception should already have been thrown */
+			goto cleanup;
+		}
+	}
+
+	array_init(return_value);
+
+	bson_iter_init(&iter, &split_points);
+
+	while (bson_iter_next(&iter)) {
+		if (!php_phongo_manager_execute_partition(getThis(), namespace, query, options, zreadPreference, zsession, has_lower ? &lower : NULL, bson_iter_value(&iter), return_value)) {
+			/* Exception should already have been thrown */
+			goto failure;
+		}
+
+		lower     = *bson_iter_value(&iter);
+		has_lower = true;
+	}
+
+	if (!php_phongo_manager_execute_partition(getThis(), namespace, query, options, zreadPreference, zsession, has_lower ? &lower : NULL, NULL, return_value)) {
+		/* Exception should already have been thrown */
+		goto failure;
+	}
+
+	goto cleanup;
+
+failure:
+	zval_ptr_dtor(return_value);
+	ZVAL_NULL(return_value);
+
+cleanup:
+	bson_destroy(&split_points);
+} /* }}} */
+
 /* {{{ proto MongoDB\Driver\WriteResult MongoDB\Driver\Manager::executeBulkWrite(string $namespace, MongoDB\Driver\BulkWrite $zbulk[, array $options = null])
    Executes a BulkWrite (i.e. any number of insert, update, and delete ops) */
 static PHP_METHOD(Manager, executeBulkWrite)
@@ -572,7 +814,7 @@ static PHP_METHOD(Manager, executeBulkWrite)
 		return;
 	}
 
-	if (!php_phongo_manager_select_server(true, false, NULL, zsession, intern->client, &server_id)) {
+	if (!php_phongo_manager_select_server(true, false, NULL, zsession, intern, &server_id)) {
 		/* Exception should already have been thrown */
 		goto cleanup;
 	}
@@ -589,6 +831,62 @@ cleanup:
 	}
 } /* }}} */
 
+/* {{{ proto MongoDB\Driver\WriteResult MongoDB\Driver\Manager::executeClientBulkWrite(MongoDB\Driver\ClientBulkWrite $zbulk[, array $options = array()])
+   Executes a ClientBulkWrite, whose operations may span multiple namespaces */
+static PHP_METHOD(Manager, executeClientBulkWrite)
+{
+	zend_error_handling           error_handling;
+	php_phongo_manager_t*         intern;
+	zval*                         zbulk;
+	php_phongo_clientbulkwrite_t* bulk;
+	zval*                         options   = NULL;
+	uint32_t                      server_id = 0;
+	zval*                         zsession  = NULL;
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "O|a!", &zbulk, php_phongo_clientbulkwrite_ce, &options) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	intern = Z_MANAGER_OBJ_P(getThis());
+	bulk   = Z_CLIENTBULKWRITE_OBJ_P(zbulk);
+
+	if (!phongo_parse_session(options, intern->client, NULL, &zsession)) {
+		/* Exception should already have been thrown */
+		return;
+	}
+
+	if (!php_phongo_manager_select_server(true, false, NULL, zsession, intern, &server_id)) {
+		/* Exception should already have been thrown */
+		return;
+	}
+
+	/* If the Server was created in a different process, reset the client so
+	 * that its session pool is cleared. */
+	PHONGO_RESET_CLIENT_IF_PID_DIFFERS(intern, intern);
+
+	phongo_execute_client_bulk_write(getThis(), bulk, options, server_id, return_value);
+} /* }}} */
+
+/* {{{ proto void MongoDB\Driver\Manager::flushDeferredWrites()
+   Executes any BulkWrites deferred by this Manager. Errors are not reported, as
+   deferred writes are unacknowledged. */
+static PHP_METHOD(Manager, flushDeferredWrites)
+{
+	zend_error_handling error_handling;
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	phongo_flush_deferred_writes(getThis());
+} /* }}} */
+
 /* {{{ proto MongoDB\Driver\ReadConcern MongoDB\Driver\Manager::getReadConcern()
    Returns the ReadConcern associated with this Manager */
 static PHP_METHOD(Manager, getReadConcern)
@@ -605,7 +903,7 @@ static PHP_METHOD(Manager, getReadConcern)
 	}
 	zend_restore_error_handling(&error_handling);
 
-	phongo_readconcern_init(return_value, mongoc_client_get_read_concern(intern->client));
+	phongo_readconcern_init(return_value, phongo_manager_get_read_concern(intern));
 } /* }}} */
 
 /* {{{ proto MongoDB\Driver\ReadPreference MongoDB\Driver\Manager::getReadPreference()
@@ -624,7 +922,7 @@ static PHP_METHOD(Manager, getReadPreference)
 	}
 	zend_restore_error_handling(&error_handling);
 
-	phongo_readpreference_init(return_value, mongoc_client_get_read_prefs(intern->client));
+	phongo_readpreference_init(return_value, phongo_manager_get_read_prefs(intern));
 } /* }}} */
 
 /* {{{ proto MongoDB\Driver\Server[] MongoDB\Driver\Manager::getServers()
@@ -674,7 +972,47 @@ static PHP_METHOD(Manager, getWriteConcern)
 	}
 	zend_restore_error_handling(&error_handling);
 
-	phongo_writeconcern_init(return_value, mongoc_client_get_write_concern(intern->client));
+	phongo_writeconcern_init(return_value, phongo_manager_get_write_concern(intern));
+} /* }}} */
+
+/* {{{ proto MongoDB\Driver\PreparedOperation MongoDB\Driver\Manager::prepareCommand(string $db, MongoDB\Driver\Command $command[, array $options = null])
+   Prepares a command for repeated execution */
+static PHP_METHOD(Manager, prepareCommand)
+{
+	zend_error_handling error_handling;
+	char*               db;
+	size_t              db_len;
+	zval*               command;
+	zval*               options = NULL;
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "sO|a!", &db, &db_len, &command, php_phongo_command_ce, &options) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	phongo_preparedoperation_init_for_command(return_value, getThis(), db, command, options);
+} /* }}} */
+
+/* {{{ proto MongoDB\Driver\PreparedOperation MongoDB\Driver\Manager::prepareQuery(string $namespace, MongoDB\Driver\Query $query[, array $options = null])
+   Prepares a query for repeated execution */
+static PHP_METHOD(Manager, prepareQuery)
+{
+	zend_error_handling error_handling;
+	char*               namespace;
+	size_t              namespace_len;
+	zval*               query;
+	zval*               options = NULL;
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "sO|a!", &namespace, &namespace_len, &query, php_phongo_query_ce, &options) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	phongo_preparedoperation_init_for_query(return_value, getThis(), namespace, query, options);
 } /* }}} */
 
 /* {{{ proto MongoDB\Driver\Server MongoDB\Driver\Manager::selectServers(MongoDB\Driver\ReadPreference $readPreference)
@@ -695,7 +1033,7 @@ static PHP_METHOD(Manager, selectServer)
 	}
 	zend_restore_error_handling(&error_handling);
 
-	if (!php_phongo_manager_select_server(false, true, zreadPreference, NULL, intern->client, &server_id)) {
+	if (!php_phongo_manager_select_server(false, true, zreadPreference, NULL, intern, &server_id)) {
 		/* Exception should already have been thrown */
 		return;
 	}
@@ -703,6 +1041,36 @@ static PHP_METHOD(Manager, selectServer)
 	phongo_server_init(return_value, getThis(), server_id);
 } /* }}} */
 
+/* Applies the Manager's default read preference, read concern, and write
+ * concern to any default transaction options that were not specified. */
+static void php_phongo_manager_apply_transaction_defaults(php_phongo_manager_t* manager, mongoc_session_opt_t** cs_opts) /* {{{ */
+{
+	const mongoc_transaction_opt_t* default_txn_opts;
+	mongoc_transaction_opt_t*       txn_opts;
+
+	if (!*cs_opts) {
+		*cs_opts = mongoc_session_opts_new();
+	}
+
+	default_txn_opts = mongoc_session_opts_get_default_transaction_opts(*cs_opts);
+	txn_opts         = default_txn_opts ? mongoc_transaction_opts_clone(default_txn_opts) : mongoc_transaction_opts_new();
+
+	if (manager->read_prefs && !mongoc_transaction_opts_get_read_prefs(txn_opts)) {
+		mongoc_transaction_opts_set_read_prefs(txn_opts, manager->read_prefs);
+	}
+
+	if (manager->read_concern && mongoc_read_concern_is_default(mongoc_transaction_opts_get_read_concern(txn_opts))) {
+		mongoc_transaction_opts_set_read_concern(txn_opts, manager->read_concern);
+	}
+
+	if (manager->write_concern && mongoc_write_concern_is_default(mongoc_transaction_opts_get_write_concern(txn_opts))) {
+		mongoc_transaction_opts_set_write_concern(txn_opts, manager->write_concern);
+	}
+
+	mongoc_session_opts_set_default_transaction_opts(*cs_opts, txn_opts);
+	mongoc_transaction_opts_destroy(txn_opts);
+} /* }}} */
+
 /* {{{ proto MongoDB\Driver\Session MongoDB\Driver\Manager::startSession([array $options = null])
    Returns a new client session */
 static PHP_METHOD(Manager, startSession)
@@ -761,6 +1129,12 @@ static PHP_METHOD(Manager, startSession)
 		}
 	}
 
+	/* Transactions would otherwise inherit the client's read and write options,
+	 * which do not include defaults specified for the Manager itself */
+	if (intern->read_prefs || intern->read_concern || intern->write_concern) {
+		php_phongo_manager_apply_transaction_defaults(intern, &cs_opts);
+	}
+
 	/* If the Manager was created in a different process, reset the client so
 	 * that its session pool is cleared. This will ensure that we do not re-use
 	 * a server session (i.e. LSID) created by a parent process. */
@@ -791,6 +1165,11 @@ ZEND_BEGIN_ARG_INFO_EX(ai_Manager_createClientEncryption, 0, 0, 1)
 	ZEND_ARG_ARRAY_INFO(0, options, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(ai_Manager_deferBulkWrite, 0, 0, 2)
+	ZEND_ARG_INFO(0, namespace)
+	ZEND_ARG_OBJ_INFO(0, zbulk, MongoDB\\Driver\\BulkWrite, 0)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(ai_Manager_executeCommand, 0, 0, 2)
 	ZEND_ARG_INFO(0, db)
 	ZEND_ARG_OBJ_INFO(0, command, MongoDB\\Driver\\Command, 0)
@@ -809,12 +1188,36 @@ ZEND_BEGIN_ARG_INFO_EX(ai_Manager_executeQuery, 0, 0, 2)
 	ZEND_ARG_INFO(0, options)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(ai_Manager_prepareCommand, 0, 0, 2)
+	ZEND_ARG_INFO(0, db)
+	ZEND_ARG_OBJ_INFO(0, command, MongoDB\\Driver\\Command, 0)
+	ZEND_ARG_ARRAY_INFO(0, options, 1)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(ai_Manager_prepareQuery, 0, 0, 2)
+	ZEND_ARG_INFO(0, namespace)
+	ZEND_ARG_OBJ_INFO(0, zquery, MongoDB\\Driver\\Query, 0)
+	ZEND_ARG_ARRAY_INFO(0, options, 1)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(ai_Manager_executeParallelScan, 0, 0, 3)
+	ZEND_ARG_INFO(0, namespace)
+	ZEND_ARG_OBJ_INFO(0, zquery, MongoDB\\Driver\\Query, 0)
+	ZEND_ARG_INFO(0, partitions)
+	ZEND_ARG_ARRAY_INFO(0, options, 1)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(ai_Manager_executeBulkWrite, 0, 0, 2)
 	ZEND_ARG_INFO(0, namespace)
 	ZEND_ARG_OBJ_INFO(0, zbulk, MongoDB\\Driver\\BulkWrite, 0)
 	ZEND_ARG_INFO(0, options)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_INFO_EX(ai_Manager_executeClientBulkWrite, 0, 0, 1)
+	ZEND_ARG_OBJ_INFO(0, zbulk, MongoDB\\Driver\\ClientBulkWrite, 0)
+	ZEND_ARG_ARRAY_INFO(0, options, 1)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_INFO_EX(ai_Manager_selectServer, 0, 0, 1)
 	ZEND_ARG_OBJ_INFO(0, readPreference, MongoDB\\Driver\\ReadPreference, 1)
 ZEND_END_ARG_INFO()
@@ -830,16 +1233,22 @@ static zend_function_entry php_phongo_manager_me[] = {
 	/* clang-format off */
 	PHP_ME(Manager, __construct, ai_Manager___construct, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Manager, createClientEncryption, ai_Manager_createClientEncryption, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(Manager, deferBulkWrite, ai_Manager_deferBulkWrite, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Manager, executeCommand, ai_Manager_executeCommand, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Manager, executeReadCommand, ai_Manager_executeRWCommand, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Manager, executeWriteCommand, ai_Manager_executeRWCommand, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Manager, executeReadWriteCommand, ai_Manager_executeCommand, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Manager, executeQuery, ai_Manager_executeQuery, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(Manager, executeParallelScan, ai_Manager_executeParallelScan, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Manager, executeBulkWrite, ai_Manager_executeBulkWrite, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(Manager, executeClientBulkWrite, ai_Manager_executeClientBulkWrite, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(Manager, flushDeferredWrites, ai_Manager_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Manager, getReadConcern, ai_Manager_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Manager, getReadPreference, ai_Manager_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Manager, getServers, ai_Manager_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Manager, getWriteConcern, ai_Manager_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(Manager, prepareCommand, ai_Manager_prepareCommand, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(Manager, prepareQuery, ai_Manager_prepareQuery, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Manager, selectServer, ai_Manager_selectServer, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	PHP_ME(Manager, startSession, ai_Manager_startSession, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
 	ZEND_NAMED_ME(__wakeup, PHP_FN(MongoDB_disabled___wakeup), ai_Manager_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
@@ -875,6 +1284,23 @@ static void php_phongo_manager_free_object(zend_object* object) /* {{{ */
 		efree(intern->client_hash);
 	}
 
+	if (intern->read_cache) {
+		zend_hash_destroy(intern->read_cache);
+		FREE_HASHTABLE(intern->read_cache);
+	}
+
+	if (intern->read_prefs) {
+		mongoc_read_prefs_destroy(intern->read_prefs);
+	}
+
+	if (intern->read_concern) {
+		mongoc_read_concern_destroy(intern->read_concern);
+	}
+
+	if (intern->write_concern) {
+		mongoc_write_concern_destroy(intern->write_concern);
+	}
+
 	/* Free the keyVaultClient last to ensure that potential non-persistent
 	 * clients are destroyed in the correct order */
 	if (!Z_ISUNDEF(intern->key_vault_client_manager)) {
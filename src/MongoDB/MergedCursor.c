@@ -0,0 +1,679 @@
+/*
+ * Copyright 2021 MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <php.h>
+#include <Zend/zend_interfaces.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "phongo_compat.h"
+#include "php_phongo.h"
+#include "php_bson.h"
+
+zend_class_entry* php_phongo_mergedcursor_ce;
+
+/* Finds the value of a dotted sort field in a document. As with server-side
+ * sorting, missing fields are ordered as null. The server sorts on the
+ * smallest or largest element of an array, and on the fields of embedded
+ * documents within an array, which cannot be reproduced by comparing whole
+ * values. Arrays along the path are therefore rejected. Returns false and
+ * throws an exception if an array was found. */
+static bool php_phongo_mergedcursor_find_key(const bson_t* doc, const char* field, bson_value_t* key) /* {{{ */
+{
+	bson_iter_t iter, child;
+	const char* segment = field;
+
+	key->value_type = BSON_TYPE_NULL;
+
+	if (!bson_iter_init(&iter, doc)) {
+		return true;
+	}
+
+	for (;;) {
+		const char* dot = strchr(segment, '.');
+		size_t      len = dot ? (size_t) (dot - segment) : strlen(segment);
+
+		if (!bson_iter_find_w_len(&iter, segment, (int) len)) {
+			return true;
+		}
+
+		if (BSON_ITER_HOLDS_ARRAY(&iter)) {
+			phongo_throw_exception(PHONGO_ERROR_UNEXPECTED_VALUE, "Cannot merge cursors on sort field \"%s\", which contains an array", field);
+			return false;
+		}
+
+		if (!dot) {
+			*key = *bson_iter_value(&iter);
+			return true;
+		}
+
+		if (!BSON_ITER_HOLDS_DOCUMENT(&iter) || !bson_iter_recurse(&iter, &child)) {
+			return true;
+		}
+
+		iter    = child;
+		segment = dot + 1;
+	}
+} /* }}} */
+
+/* Extracts the sort key values for the current document of a cursor. Values
+ * reference the data of the copied head document and remain valid until it is
+ * replaced. Returns false if a key could not be extracted, in which case an
+ * exception will have been thrown. */
+static bool php_phongo_mergedcursor_load_keys(php_phongo_mergedcursor_t* intern, uint32_t source) /* {{{ */
+{
+	bson_value_t* keys = intern->keys + (size_t) source * intern->sort_count;
+	uint32_t      i;
+
+	for (i = 0; i < intern->sort_count; i++) {
+		if (!php_phongo_mergedcursor_find_key(intern->heads[source], intern->sort_fields[i], &keys[i])) {
+			/* Exception should already have been thrown */
+			return false;
+		}
+	}
+
+	return true;
+} /* }}} */
+
+/* Replaces the head document of a cursor with a copy of doc, which may be NULL
+ * if the cursor is exhausted. Heads are copied because documents returned by
+ * libmongoc are invalidated when their cursor advances, and the constituent
+ * Cursor objects remain accessible to (and may be iterated by) the caller. */
+static void php_phongo_mergedcursor_set_head(php_phongo_mergedcursor_t* intern, uint32_t source, const bson_t* doc) /* {{{ */
+{
+	if (intern->heads[source]) {
+		bson_destroy(intern->heads[source]);
+	}
+
+	intern->heads[source] = doc ? bson_copy(doc) : NULL;
+} /* }}} */
+
+/* Compares the current documents of two cursors according to the sort
+ * specification. Ties are broken by the cursor's position in the constructor
+ * argument, so that the merge is stable. */
+static int php_phongo_mergedcursor_compare(php_phongo_mergedcursor_t* intern, uint32_t a, uint32_t b) /* {{{ */
+{
+	const bson_value_t* keys_a = intern->keys + (size_t) a * intern->sort_count;
+	const bson_value_t* keys_b = intern->keys + (size_t) b * intern->sort_count;
+	uint32_t            i;
+
+	for (i = 0; i < intern->sort_count; i++) {
+		int cmp = php_phongo_bson_value_compare(&keys_a[i], &keys_b[i]);
+
+		if (cmp != 0) {
+			return cmp * intern->sort_directions[i];
+		}
+	}
+
+	return a < b ? -1 : (a > b ? 1 : 0);
+} /* }}} */
+
+static void php_phongo_mergedcursor_sift_down(php_phongo_mergedcursor_t* intern, uint32_t pos) /* {{{ */
+{
+	uint32_t* heap = intern->heap;
+
+	for (;;) {
+		uint32_t left     = 2 * pos + 1;
+		uint32_t right    = left + 1;
+		uint32_t smallest = pos;
+		uint32_t tmp;
+
+		if (left < intern->heap_size && php_phongo_mergedcursor_compare(intern, heap[left], heap[smallest]) < 0) {
+			smallest = left;
+		}
+
+		if (right < intern->heap_size && php_phongo_mergedcursor_compare(intern, heap[right], heap[smallest]) < 0) {
+			smallest = right;
+		}
+
+		if (smallest == pos) {
+			return;
+		}
+
+		tmp            = heap[pos];
+		heap[pos]      = heap[smallest];
+		heap[smallest] = tmp;
+		pos            = smallest;
+	}
+} /* }}} */
+
+static void php_phongo_mergedcursor_free_current(php_phongo_mergedcursor_t* intern) /* {{{ */
+{
+	if (!Z_ISUNDEF(intern->visitor_data.zchild)) {
+		zval_ptr_dtor(&intern->visitor_data.zchild);
+		ZVAL_UNDEF(&intern->visitor_data.zchild);
+	}
+} /* }}} */
+
+/* Decodes the document at the top of the heap. Only documents that are emitted
+ * are converted to PHP values. */
+static void php_phongo_mergedcursor_load_current(php_phongo_mergedcursor_t* intern) /* {{{ */
+{
+	const bson_t* doc;
+
+	php_phongo_mergedcursor_free_current(intern);
+
+	if (intern->heap_size == 0) {
+		return;
+	}
+
+	doc = intern->heads[intern->heap[0]];
+
+	if (!php_phongo_bson_to_zval_ex(bson_get_data(doc), doc->len, &intern->visitor_data)) {
+		php_phongo_mergedcursor_free_current(intern);
+	}
+} /* }}} */
+
+/* Positions each cursor on its first document and builds the heap. Returns
+ * false if any cursor failed, in which case an exception will have been
+ * thrown. */
+static bool php_phongo_mergedcursor_start(php_phongo_mergedcursor_t* intern) /* {{{ */
+{
+	uint32_t i;
+
+	intern->started = true;
+
+	for (i = 0; i < intern->cursors_count; i++) {
+		const bson_t* doc;
+
+		if (!php_phongo_cursor_raw_start(Z_CURSOR_OBJ_P(&intern->cursors[i]), &doc)) {
+			/* Exception should already have been thrown */
+			return false;
+		}
+
+		php_phongo_mergedcursor_set_head(intern, i, doc);
+
+		if (intern->heads[i]) {
+			if (!php_phongo_mergedcursor_load_keys(intern, i)) {
+				/* Exception should already have been thrown */
+				return false;
+			}
+
+			intern->heap[intern->heap_size++] = i;
+		}
+	}
+
+	for (i = intern->heap_size / 2; i > 0; i--) {
+		php_phongo_mergedcursor_sift_down(intern, i - 1);
+	}
+
+	return true;
+} /* }}} */
+
+static bool php_phongo_mergedcursor_parse_sort(php_phongo_mergedcursor_t* intern, zval* sort) /* {{{ */
+{
+	HashTable*   ht = Z_ARRVAL_P(sort);
+	zend_string* field;
+	zval*        direction;
+
+	if (zend_hash_num_elements(ht) == 0) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected sort specification to contain at least one field");
+		return false;
+	}
+
+	intern->sort_fields     = ecalloc(zend_hash_num_elements(ht), sizeof(char*));
+	intern->sort_directions = ecalloc(zend_hash_num_elements(ht), sizeof(int));
+
+	ZEND_HASH_FOREACH_STR_KEY_VAL(ht, field, direction)
+	{
+		double value;
+
+		if (!field || ZSTR_LEN(field) == 0) {
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected sort specification to contain only non-empty field names");
+			return false;
+		}
+
+		ZVAL_DEREF(direction);
+
+		if (Z_TYPE_P(direction) == IS_LONG) {
+			value = (double) Z_LVAL_P(direction);
+		} else if (Z_TYPE_P(direction) == IS_DOUBLE) {
+			value = Z_DVAL_P(direction);
+		} else {
+			value = 0;
+		}
+
+		if (value != 1 && value != -1) {
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected sort direction for \"%s\" to be 1 or -1", ZSTR_VAL(field));
+			return false;
+		}
+
+		intern->sort_fields[intern->sort_count]     = estrndup(ZSTR_VAL(field), ZSTR_LEN(field));
+		intern->sort_directions[intern->sort_count] = (int) value;
+		intern->sort_count++;
+	}
+	ZEND_HASH_FOREACH_END();
+
+	ZVAL_COPY(&intern->sort, sort);
+
+	return true;
+} /* }}} */
+
+static bool php_phongo_mergedcursor_parse_cursors(php_phongo_mergedcursor_t* intern, zval* cursors) /* {{{ */
+{
+	HashTable* ht = Z_ARRVAL_P(cursors);
+	zval*      cursor;
+
+	if (zend_hash_num_elements(ht) == 0) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected at least one cursor");
+		return false;
+	}
+
+	intern->cursors = ecalloc(zend_hash_num_elements(ht), sizeof(zval));
+
+	ZEND_HASH_FOREACH_VAL(ht, cursor)
+	{
+		uint32_t i;
+
+		ZVAL_DEREF(cursor);
+
+		if (Z_TYPE_P(cursor) != IS_OBJECT || !instanceof_function(Z_OBJCE_P(cursor), php_phongo_cursor_ce)) {
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected cursor %u to be %s, %s given", intern->cursors_count, ZSTR_VAL(php_phongo_cursor_ce->name), PHONGO_ZVAL_CLASS_OR_TYPE_NAME_P(cursor));
+			return false;
+		}
+
+		/* Merging a cursor with itself would advance it on behalf of two
+		 * heap entries */
+		for (i = 0; i < intern->cursors_count; i++) {
+			if (Z_OBJ(intern->cursors[i]) == Z_OBJ_P(cursor)) {
+				phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Expected cursor %u to be distinct from cursor %u", intern->cursors_count, i);
+				return false;
+			}
+		}
+
+		ZVAL_COPY(&intern->cursors[intern->cursors_count], cursor);
+		intern->cursors_count++;
+	}
+	ZEND_HASH_FOREACH_END();
+
+	return true;
+} /* }}} */
+
+/* {{{ proto void MongoDB\Driver\MergedCursor::__construct(array $cursors, array $sort)
+   Constructs a cursor that merges several cursors, each of which is already
+   sorted by the given specification, into a single ordered stream. Sort fields
+   may not contain arrays, since the server's ordering of arrays cannot be
+   reproduced; iteration throws if an array is encountered. */
+static PHP_METHOD(MergedCursor, __construct)
+{
+	zend_error_handling        error_handling;
+	php_phongo_mergedcursor_t* intern;
+	zval*                      cursors;
+	zval*                      sort;
+
+	intern = Z_MERGEDCURSOR_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "aa", &cursors, &sort) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	if (intern->sort_fields || intern->cursors) {
+		phongo_throw_exception(PHONGO_ERROR_LOGIC, "MergedCursor objects may only be constructed once");
+		return;
+	}
+
+	if (!php_phongo_mergedcursor_parse_sort(intern, sort)) {
+		/* Exception should already have been thrown */
+		return;
+	}
+
+	if (!php_phongo_mergedcursor_parse_cursors(intern, cursors)) {
+		/* Exception should already have been thrown */
+		return;
+	}
+
+	intern->heads = ecalloc(intern->cursors_count, sizeof(bson_t*));
+	intern->keys  = ecalloc((size_t) intern->cursors_count * intern->sort_count, sizeof(bson_value_t));
+	intern->heap  = ecalloc(intern->cursors_count, sizeof(uint32_t));
+
+	/* Default to the type map of the first cursor */
+	php_phongo_bson_typemap_copy(&intern->visitor_data.map, &Z_CURSOR_OBJ_P(&intern->cursors[0])->visitor_data.map);
+} /* }}} */
+
+/* {{{ proto void MongoDB\Driver\MergedCursor::setTypeMap(array $typemap)
+   Sets a type map to use for BSON unserialization */
+static PHP_METHOD(MergedCursor, setTypeMap)
+{
+	zend_error_handling        error_handling;
+	php_phongo_mergedcursor_t* intern;
+	php_phongo_bson_state      state;
+	zval*                      typemap                 = NULL;
+	bool                       restore_current_element = false;
+
+	PHONGO_BSON_INIT_STATE(state);
+
+	intern = Z_MERGEDCURSOR_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "a!", &typemap) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	if (!php_phongo_bson_typemap_to_state(typemap, &state.map)) {
+		return;
+	}
+
+	if (!Z_ISUNDEF(intern->visitor_data.zchild)) {
+		php_phongo_mergedcursor_free_current(intern);
+		restore_current_element = true;
+	}
+
+	php_phongo_bson_typemap_dtor(&intern->visitor_data.map);
+
+	intern->visitor_data = state;
+
+	if (restore_current_element) {
+		php_phongo_mergedcursor_load_current(intern);
+	}
+} /* }}} */
+
+static PHP_METHOD(MergedCursor, current)
+{
+	zend_error_handling        error_handling;
+	php_phongo_mergedcursor_t* intern = Z_MERGEDCURSOR_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	if (Z_ISUNDEF(intern->visitor_data.zchild)) {
+		RETURN_NULL();
+	}
+
+	ZVAL_COPY_DEREF(return_value, &intern->visitor_data.zchild);
+}
+
+static PHP_METHOD(MergedCursor, key)
+{
+	zend_error_handling        error_handling;
+	php_phongo_mergedcursor_t* intern = Z_MERGEDCURSOR_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	if (Z_ISUNDEF(intern->visitor_data.zchild)) {
+		RETURN_NULL();
+	}
+
+	RETURN_LONG(intern->current);
+}
+
+static PHP_METHOD(MergedCursor, next)
+{
+	zend_error_handling        error_handling;
+	php_phongo_mergedcursor_t* intern = Z_MERGEDCURSOR_OBJ_P(getThis());
+	const bson_t*              doc;
+	uint32_t                   top;
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	if (!intern->started || intern->heap_size == 0) {
+		return;
+	}
+
+	top = intern->heap[0];
+
+	if (!php_phongo_cursor_raw_next(Z_CURSOR_OBJ_P(&intern->cursors[top]), &doc)) {
+		/* Exception should already have been thrown */
+		php_phongo_mergedcursor_free_current(intern);
+		return;
+	}
+
+	php_phongo_mergedcursor_set_head(intern, top, doc);
+
+	if (intern->heads[top]) {
+		if (!php_phongo_mergedcursor_load_keys(intern, top)) {
+			/* Exception should already have been thrown */
+			php_phongo_mergedcursor_free_current(intern);
+			return;
+		}
+	} else {
+		intern->heap[0] = intern->heap[--intern->heap_size];
+	}
+
+	php_phongo_mergedcursor_sift_down(intern, 0);
+
+	intern->current++;
+	php_phongo_mergedcursor_load_current(intern);
+}
+
+static PHP_METHOD(MergedCursor, valid)
+{
+	zend_error_handling        error_handling;
+	php_phongo_mergedcursor_t* intern = Z_MERGEDCURSOR_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	RETURN_BOOL(!Z_ISUNDEF(intern->visitor_data.zchild));
+}
+
+static PHP_METHOD(MergedCursor, rewind)
+{
+	zend_error_handling        error_handling;
+	php_phongo_mergedcursor_t* intern = Z_MERGEDCURSOR_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	if (intern->current > 0) {
+		phongo_throw_exception(PHONGO_ERROR_LOGIC, "Cursors cannot rewind after starting iteration");
+		return;
+	}
+
+	if (intern->started) {
+		return;
+	}
+
+	if (!php_phongo_mergedcursor_start(intern)) {
+		/* Exception should already have been thrown */
+		return;
+	}
+
+	php_phongo_mergedcursor_load_current(intern);
+}
+
+/* {{{ MongoDB\Driver\MergedCursor function entries */
+ZEND_BEGIN_ARG_INFO_EX(ai_MergedCursor___construct, 0, 0, 2)
+	ZEND_ARG_ARRAY_INFO(0, cursors, 0)
+	ZEND_ARG_ARRAY_INFO(0, sort, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(ai_MergedCursor_setTypeMap, 0, 0, 1)
+	ZEND_ARG_ARRAY_INFO(0, typemap, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(ai_MergedCursor_void, 0, 0, 0)
+ZEND_END_ARG_INFO()
+
+static zend_function_entry php_phongo_mergedcursor_me[] = {
+	/* clang-format off */
+	PHP_ME(MergedCursor, __construct, ai_MergedCursor___construct, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(MergedCursor, setTypeMap, ai_MergedCursor_setTypeMap, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+
+	PHP_ME(MergedCursor, current, ai_MergedCursor_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(MergedCursor, key, ai_MergedCursor_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(MergedCursor, next, ai_MergedCursor_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(MergedCursor, valid, ai_MergedCursor_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(MergedCursor, rewind, ai_MergedCursor_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+
+	ZEND_NAMED_ME(__wakeup, PHP_FN(MongoDB_disabled___wakeup), ai_MergedCursor_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_FE_END
+	/* clang-format on */
+};
+/* }}} */
+
+/* {{{ MongoDB\Driver\MergedCursor object handlers */
+static zend_object_handlers php_phongo_handler_mergedcursor;
+
+static void php_phongo_mergedcursor_free_object(zend_object* object) /* {{{ */
+{
+	php_phongo_mergedcursor_t* intern = Z_OBJ_MERGEDCURSOR(object);
+	uint32_t                   i;
+
+	zend_object_std_dtor(&intern->std);
+
+	php_phongo_mergedcursor_free_current(intern);
+
+	if (intern->cursors) {
+		for (i = 0; i < intern->cursors_count; i++) {
+			zval_ptr_dtor(&intern->cursors[i]);
+		}
+
+		efree(intern->cursors);
+	}
+
+	if (intern->sort_fields) {
+		for (i = 0; i < intern->sort_count; i++) {
+			efree(intern->sort_fields[i]);
+		}
+
+		efree(intern->sort_fields);
+	}
+
+	if (intern->sort_directions) {
+		efree(intern->sort_directions);
+	}
+
+	if (intern->heads) {
+		for (i = 0; i < intern->cursors_count; i++) {
+			if (intern->heads[i]) {
+				bson_destroy(intern->heads[i]);
+			}
+		}
+
+		efree(intern->heads);
+	}
+
+	if (intern->keys) {
+		efree(intern->keys);
+	}
+
+	if (intern->heap) {
+		efree(intern->heap);
+	}
+
+	if (!Z_ISUNDEF(intern->sort)) {
+		zval_ptr_dtor(&intern->sort);
+	}
+
+	php_phongo_bson_typemap_dtor(&intern->visitor_data.map);
+} /* }}} */
+
+static zend_object* php_phongo_mergedcursor_create_object(zend_class_entry* class_type) /* {{{ */
+{
+	php_phongo_mergedcursor_t* intern = NULL;
+
+	intern = PHONGO_ALLOC_OBJECT_T(php_phongo_mergedcursor_t, class_type);
+
+	zend_object_std_init(&intern->std, class_type);
+	object_properties_init(&intern->std, class_type);
+
+	PHONGO_BSON_INIT_STATE(intern->visitor_data);
+	ZVAL_UNDEF(&intern->sort);
+
+	intern->std.handlers = &php_phongo_handler_mergedcursor;
+
+	return &intern->std;
+} /* }}} */
+
+static HashTable* php_phongo_mergedcursor_get_debug_info(phongo_compat_object_handler_type* object, int* is_temp) /* {{{ */
+{
+	php_phongo_mergedcursor_t* intern;
+	zval                       retval = ZVAL_STATIC_INIT;
+	zval                       cursors;
+	uint32_t                   i;
+
+	*is_temp = 1;
+	intern   = Z_OBJ_MERGEDCURSOR(PHONGO_COMPAT_GET_OBJ(object));
+
+	array_init_size(&retval, 3);
+
+	array_init_size(&cursors, intern->cursors_count);
+
+	for (i = 0; i < intern->cursors_count; i++) {
+		Z_ADDREF(intern->cursors[i]);
+		add_next_index_zval(&cursors, &intern->cursors[i]);
+	}
+
+	ADD_ASSOC_ZVAL_EX(&retval, "cursors", &cursors);
+
+	if (!Z_ISUNDEF(intern->sort)) {
+		Z_ADDREF(intern->sort);
+		ADD_ASSOC_ZVAL_EX(&retval, "sort", &intern->sort);
+	} else {
+		ADD_ASSOC_NULL_EX(&retval, "sort");
+	}
+
+	ADD_ASSOC_LONG_EX(&retval, "currentIndex", intern->current);
+
+	return Z_ARRVAL(retval);
+} /* }}} */
+/* }}} */
+
+void php_phongo_mergedcursor_init_ce(INIT_FUNC_ARGS) /* {{{ */
+{
+	zend_class_entry ce;
+
+	INIT_NS_CLASS_ENTRY(ce, "MongoDB\\Driver", "MergedCursor", php_phongo_mergedcursor_me);
+	php_phongo_mergedcursor_ce                = zend_register_internal_class(&ce);
+	php_phongo_mergedcursor_ce->create_object = php_phongo_mergedcursor_create_object;
+	PHONGO_CE_FINAL(php_phongo_mergedcursor_ce);
+	PHONGO_CE_DISABLE_SERIALIZATION(php_phongo_mergedcursor_ce);
+
+	zend_class_implements(php_phongo_mergedcursor_ce, 1, zend_ce_iterator);
+
+	memcpy(&php_phongo_handler_mergedcursor, phongo_get_std_object_handlers(), sizeof(zend_object_handlers));
+	php_phongo_handler_mergedcursor.get_debug_info = php_phongo_mergedcursor_get_debug_info;
+	php_phongo_handler_mergedcursor.free_obj       = php_phongo_mergedcursor_free_object;
+	php_phongo_handler_mergedcursor.offset         = XtOffsetOf(php_phongo_mergedcursor_t, std);
+} /* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
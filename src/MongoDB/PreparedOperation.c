@@ -0,0 +1,329 @@
+/*
+ * Copyright 2021 MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <php.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "php_array_api.h"
+#include "phongo_compat.h"
+#include "php_phongo.h"
+
+zend_class_entry* php_phongo_preparedoperation_ce;
+
+/* Sessions are bound to each execution, so they may not be specified when
+ * preparing an operation. */
+static bool php_phongo_preparedoperation_check_options(zval* options) /* {{{ */
+{
+	if (options && php_array_existsc(options, "session")) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "The \"session\" option must be specified when executing a prepared operation");
+		return false;
+	}
+
+	return true;
+} /* }}} */
+
+static void php_phongo_preparedoperation_init(php_phongo_preparedoperation_t* intern, zval* manager, const char* namespace, zval* operation, zval* zreadPreference) /* {{{ */
+{
+	ZVAL_ZVAL(&intern->manager, manager, 1, 0);
+	ZVAL_ZVAL(&intern->operation, operation, 1, 0);
+
+	if (zreadPreference) {
+		ZVAL_ZVAL(&intern->read_preference, zreadPreference, 1, 0);
+	}
+
+	intern->namespace = estrdup(namespace);
+} /* }}} */
+
+bool phongo_preparedoperation_init_for_query(zval* return_value, zval* manager, const char* namespace, zval* zquery, zval* options) /* {{{ */
+{
+	php_phongo_preparedoperation_t* intern;
+	bson_t                          opts            = BSON_INITIALIZER;
+	mongoc_collection_t*            collection      = NULL;
+	zval*                           zreadPreference = NULL;
+
+	if (!php_phongo_preparedoperation_check_options(options)) {
+		/* Exception should already have been thrown */
+		return false;
+	}
+
+	if (!phongo_parse_read_preference(options, &zreadPreference)) {
+		/* Exception should already have been thrown */
+		return false;
+	}
+
+	if (!phongo_query_prepare(manager, namespace, zquery, &collection, &opts)) {
+		/* Exception should already have been thrown */
+		bson_destroy(&opts);
+		return false;
+	}
+
+	object_init_ex(return_value, php_phongo_preparedoperation_ce);
+
+	intern             = Z_PREPAREDOPERATION_OBJ_P(return_value);
+	intern->is_query   = true;
+	intern->collection = collection;
+	intern->opts       = bson_copy(&opts);
+
+	php_phongo_preparedoperation_init(intern, manager, namespace, zquery, zreadPreference);
+
+	bson_destroy(&opts);
+
+	return true;
+} /* }}} */
+
+bool phongo_preparedoperation_init_for_command(zval* return_value, zval* manager, const char* db, zval* zcommand, zval* options) /* {{{ */
+{
+	php_phongo_preparedoperation_t* intern;
+	bson_t                          opts                            = BSON_INITIALIZER;
+	zval*                           zreadPreference                 = NULL;
+	bool                            is_unacknowledged_write_concern = false;
+
+	if (!php_phongo_preparedoperation_check_options(options)) {
+		/* Exception should already have been thrown */
+		return false;
+	}
+
+	if (!phongo_command_prepare(manager, PHONGO_COMMAND_RAW, options, &opts, &zreadPreference, &is_unacknowledged_write_concern)) {
+		/* Exception should already have been thrown */
+		bson_destroy(&opts);
+		return false;
+	}
+
+	object_init_ex(return_value, php_phongo_preparedoperation_ce);
+
+	intern                                  = Z_PREPAREDOPERATION_OBJ_P(return_value);
+	intern->is_query                        = false;
+	intern->opts                            = bson_copy(&opts);
+	intern->is_unacknowledged_write_concern = is_unacknowledged_write_concern;
+
+	php_phongo_preparedoperation_init(intern, manager, db, zcommand, zreadPreference);
+
+	bson_destroy(&opts);
+
+	return true;
+} /* }}} */
+
+/* Checks that the options for PreparedOperation::execute() only contain a
+ * session. All other options are fixed when the operation is prepared, so they
+ * are rejected rather than silently ignored. Returns true if the options are
+ * valid; otherwise, false is returned and an exception is thrown. */
+static bool php_phongo_preparedoperation_check_execute_options(zval* options) /* {{{ */
+{
+	zend_string* key;
+
+	if (!options) {
+		return true;
+	}
+
+	ZEND_HASH_FOREACH_STR_KEY(Z_ARRVAL_P(options), key)
+	{
+		if (!key || !zend_string_equals_literal(key, "session")) {
+			phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Only the \"session\" option may be specified when executing a prepared operation, \"%s\" given", key ? ZSTR_VAL(key) : "(integer key)");
+			return false;
+		}
+	}
+	ZEND_HASH_FOREACH_END();
+
+	return true;
+} /* }}} */
+
+/* {{{ proto MongoDB\Driver\Cursor MongoDB\Driver\PreparedOperation::execute([array $options = array()])
+   Executes the prepared query or command. Only the session and selected server
+   are determined for each execution. */
+static PHP_METHOD(PreparedOperation, execute)
+{
+	zend_error_handling             error_handling;
+	php_phongo_preparedoperation_t* intern;
+	php_phongo_manager_t*           manager;
+	zval*                           options         = NULL;
+	zval*                           zreadPreference = NULL;
+	zval*                           zsession        = NULL;
+	uint32_t                        server_id       = 0;
+	bson_t                          opts            = BSON_INITIALIZER;
+
+	intern = Z_PREPAREDOPERATION_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "|a!", &options) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	manager = Z_MANAGER_OBJ_P(&intern->manager);
+
+	if (!php_phongo_preparedoperation_check_execute_options(options)) {
+		/* Exception should already have been thrown */
+		return;
+	}
+
+	if (!phongo_parse_session(options, manager->client, NULL, &zsession)) {
+		/* Exception should already have been thrown */
+		return;
+	}
+
+	if (!Z_ISUNDEF(intern->read_preference)) {
+		zreadPreference = &intern->read_preference;
+	}
+
+	/* Queries inherit the client's read preference, while commands default to
+	 * a primary read preference (see: Manager::executeCommand()) */
+	if (!php_phongo_manager_select_server(false, intern->is_query, zreadPreference, zsession, manager, &server_id)) {
+		/* Exception should already have been thrown */
+		return;
+	}
+
+	/* If the Manager was created in a different process, reset the client so
+	 * that cursors created by this process can be differentiated and its
+	 * session pool is cleared. */
+	PHONGO_RESET_CLIENT_IF_PID_DIFFERS(manager, manager);
+
+	bson_copy_to(intern->opts, &opts);
+
+	if (intern->is_query) {
+		phongo_execute_query_with_opts(&intern->manager, intern->namespace, &intern->operation, intern->collection, &opts, zreadPreference, zsession, server_id, return_value);
+	} else {
+		phongo_execute_command_with_opts(&intern->manager, PHONGO_COMMAND_RAW, intern->namespace, &intern->operation, &opts, zreadPreference, zsession, intern->is_unacknowledged_write_concern, server_id, return_value);
+	}
+
+	bson_destroy(&opts);
+} /* }}} */
+
+/* {{{ MongoDB\Driver\PreparedOperation function entries */
+ZEND_BEGIN_ARG_INFO_EX(ai_PreparedOperation_execute, 0, 0, 0)
+	ZEND_ARG_ARRAY_INFO(0, options, 1)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(ai_PreparedOperation_void, 0, 0, 0)
+ZEND_END_ARG_INFO()
+
+static zend_function_entry php_phongo_preparedoperation_me[] = {
+	/* clang-format off */
+	PHP_ME(PreparedOperation, execute, ai_PreparedOperation_execute, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	ZEND_NAMED_ME(__construct, PHP_FN(MongoDB_disabled___construct), ai_PreparedOperation_void, ZEND_ACC_PRIVATE | ZEND_ACC_FINAL)
+	ZEND_NAMED_ME(__wakeup, PHP_FN(MongoDB_disabled___wakeup), ai_PreparedOperation_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_FE_END
+	/* clang-format on */
+};
+/* }}} */
+
+/* {{{ MongoDB\Driver\PreparedOperation object handlers */
+static zend_object_handlers php_phongo_handler_preparedoperation;
+
+static void php_phongo_preparedoperation_free_object(zend_object* object) /* {{{ */
+{
+	php_phongo_preparedoperation_t* intern = Z_OBJ_PREPAREDOPERATION(object);
+
+	zend_object_std_dtor(&intern->std);
+
+	/* The collection must be destroyed before the Manager, which may own
+	 * the only reference to its client */
+	if (intern->collection) {
+		mongoc_collection_destroy(intern->collection);
+	}
+
+	if (intern->opts) {
+		bson_destroy(intern->opts);
+	}
+
+	if (intern->namespace) {
+		efree(intern->namespace);
+	}
+
+	if (!Z_ISUNDEF(intern->operation)) {
+		zval_ptr_dtor(&intern->operation);
+	}
+
+	if (!Z_ISUNDEF(intern->read_preference)) {
+		zval_ptr_dtor(&intern->read_preference);
+	}
+
+	if (!Z_ISUNDEF(intern->manager)) {
+		zval_ptr_dtor(&intern->manager);
+	}
+} /* }}} */
+
+static zend_object* php_phongo_preparedoperation_create_object(zend_class_entry* class_type) /* {{{ */
+{
+	php_phongo_preparedoperation_t* intern = NULL;
+
+	intern = PHONGO_ALLOC_OBJECT_T(php_phongo_preparedoperation_t, class_type);
+
+	zend_object_std_init(&intern->std, class_type);
+	object_properties_init(&intern->std, class_type);
+
+	intern->std.handlers = &php_phongo_handler_preparedoperation;
+
+	return &intern->std;
+} /* }}} */
+
+static HashTable* php_phongo_preparedoperation_get_debug_info(phongo_compat_object_handler_type* object, int* is_temp) /* {{{ */
+{
+	php_phongo_preparedoperation_t* intern;
+	zval                            retval = ZVAL_STATIC_INIT;
+
+	*is_temp = 1;
+	intern   = Z_OBJ_PREPAREDOPERATION(PHONGO_COMPAT_GET_OBJ(object));
+
+	array_init_size(&retval, 3);
+
+	if (intern->is_query) {
+		ADD_ASSOC_STRING(&retval, "namespace", intern->namespace);
+		ADD_ASSOC_ZVAL_EX(&retval, "query", &intern->operation);
+	} else {
+		ADD_ASSOC_STRING(&retval, "database", intern->namespace);
+		ADD_ASSOC_ZVAL_EX(&retval, "command", &intern->operation);
+	}
+	Z_ADDREF(intern->operation);
+
+	if (!Z_ISUNDEF(intern->read_preference)) {
+		ADD_ASSOC_ZVAL_EX(&retval, "readPreference", &intern->read_preference);
+		Z_ADDREF(intern->read_preference);
+	} else {
+		ADD_ASSOC_NULL_EX(&retval, "readPreference");
+	}
+
+	return Z_ARRVAL(retval);
+} /* }}} */
+/* }}} */
+
+void php_phongo_preparedoperation_init_ce(INIT_FUNC_ARGS) /* {{{ */
+{
+	zend_class_entry ce;
+
+	INIT_NS_CLASS_ENTRY(ce, "MongoDB\\Driver", "PreparedOperation", php_phongo_preparedoperation_me);
+	php_phongo_preparedoperation_ce                = zend_register_internal_class(&ce);
+	php_phongo_preparedoperation_ce->create_object = php_phongo_preparedoperation_create_object;
+	PHONGO_CE_FINAL(php_phongo_preparedoperation_ce);
+	PHONGO_CE_DISABLE_SERIALIZATION(php_phongo_preparedoperation_ce);
+
+	memcpy(&php_phongo_handler_preparedoperation, phongo_get_std_object_handlers(), sizeof(zend_object_handlers));
+	php_phongo_handler_preparedoperation.get_debug_info = php_phongo_preparedoperation_get_debug_info;
+	php_phongo_handler_preparedoperation.free_obj       = php_phongo_preparedoperation_free_object;
+	php_phongo_handler_preparedoperation.offset         = XtOffsetOf(php_phongo_preparedoperation_t, std);
+} /* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
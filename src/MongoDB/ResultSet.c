@@ -0,0 +1,487 @@
+/*
+ * Copyright 2021 MongoDB, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <php.h>
+#include <main/php_open_temporary_file.h>
+#include <Zend/zend_interfaces.h>
+#include <Zend/zend_smart_str.h>
+#include <ext/spl/spl_iterators.h>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+#include "phongo_compat.h"
+#include "php_phongo.h"
+#include "php_bson.h"
+
+/* Size at which buffered documents are written to the temporary file */
+#define PHONGO_RESULTSET_WRITE_BUFFER_SIZE 65536
+
+typedef struct {
+	php_phongo_resultset_t* intern;
+	smart_str               buffer;
+} php_phongo_resultset_writer;
+
+zend_class_entry* php_phongo_resultset_ce;
+
+static bool php_phongo_resultset_flush(php_phongo_resultset_writer* writer) /* {{{ */
+{
+	const char* data;
+	size_t      remaining;
+
+	if (!writer->buffer.s || ZSTR_LEN(writer->buffer.s) == 0) {
+		return true;
+	}
+
+	data      = ZSTR_VAL(writer->buffer.s);
+	remaining = ZSTR_LEN(writer->buffer.s);
+
+	while (remaining > 0) {
+		ssize_t written = write(writer->intern->fd, data, remaining);
+
+		if (written <= 0) {
+			phongo_throw_exception(PHONGO_ERROR_RUNTIME, "Failed to write results to temporary file: %s", strerror(errno));
+			return false;
+		}
+
+		data += written;
+		remaining -= written;
+	}
+
+	ZSTR_LEN(writer->buffer.s) = 0;
+
+	return true;
+} /* }}} */
+
+static bool php_phongo_resultset_append(const bson_t* doc, void* data) /* {{{ */
+{
+	php_phongo_resultset_writer* writer = (php_phongo_resultset_writer*) data;
+	php_phongo_resultset_t*      intern = writer->intern;
+
+	if (intern->count == intern->offsets_size) {
+		intern->offsets_size = intern->offsets_size ? intern->offsets_size * 2 : 64;
+		intern->offsets      = erealloc(intern->offsets, sizeof(size_t) * intern->offsets_size);
+	}
+
+	intern->offsets[intern->count++] = intern->size;
+	intern->size += doc->len;
+
+	smart_str_appendl(&writer->buffer, (const char*) bson_get_data(doc), doc->len);
+
+	if (ZSTR_LEN(writer->buffer.s) >= PHONGO_RESULTSET_WRITE_BUFFER_SIZE) {
+		return php_phongo_resultset_flush(writer);
+	}
+
+	return true;
+} /* }}} */
+
+/* Decodes the document at the given index into the state's zchild. Documents
+ * are read from the mapped file if possible; otherwise, they are read into a
+ * temporary buffer. */
+static bool php_phongo_resultset_decode(php_phongo_resultset_t* intern, zend_long index, php_phongo_bson_state* state) /* {{{ */
+{
+	size_t         offset = intern->offsets[index];
+	size_t         len    = (index + 1 < intern->count ? intern->offsets[index + 1] : intern->size) - offset;
+	unsigned char* buf;
+	bool           retval;
+
+	if (intern->map) {
+		return php_phongo_bson_to_zval_ex((const unsigned char*) intern->map + offset, len, state);
+	}
+
+	buf = emalloc(len);
+
+	if (lseek(intern->fd, (zend_off_t) offset, SEEK_SET) == -1 || read(intern->fd, buf, len) != (ssize_t) len) {
+		phongo_throw_exception(PHONGO_ERROR_RUNTIME, "Failed to read result %" PHONGO_LONG_FORMAT " from temporary file", index);
+		efree(buf);
+		return false;
+	}
+
+	retval = php_phongo_bson_to_zval_ex(buf, len, state);
+	efree(buf);
+
+	return retval;
+} /* }}} */
+
+static void php_phongo_resultset_free_current(php_phongo_resultset_t* intern) /* {{{ */
+{
+	if (!Z_ISUNDEF(intern->visitor_data.zchild)) {
+		zval_ptr_dtor(&intern->visitor_data.zchild);
+		ZVAL_UNDEF(&intern->visitor_data.zchild);
+	}
+} /* }}} */
+
+static void php_phongo_resultset_load_current(php_phongo_resultset_t* intern) /* {{{ */
+{
+	php_phongo_resultset_free_current(intern);
+
+	if (intern->current >= intern->count) {
+		return;
+	}
+
+	if (!php_phongo_resultset_decode(intern, intern->current, &intern->visitor_data)) {
+		php_phongo_resultset_free_current(intern);
+	}
+} /* }}} */
+
+/* Drains the cursor into a temporary file and initializes a ResultSet over it.
+ * On error, an exception will have been thrown and false is returned. */
+bool phongo_resultset_init(zval* return_value, php_phongo_cursor_t* cursor) /* {{{ */
+{
+	php_phongo_resultset_t*     intern;
+	php_phongo_resultset_writer writer;
+	zend_string*                path = NULL;
+
+	object_init_ex(return_value, php_phongo_resultset_ce);
+
+	intern = Z_RESULTSET_OBJ_P(return_value);
+
+	memset(&writer, 0, sizeof(writer));
+	writer.intern = intern;
+
+	php_phongo_bson_typemap_copy(&intern->visitor_data.map, &cursor->visitor_data.map);
+
+	intern->fd = php_open_temporary_fd(NULL, "PHONGO-RS-", &path);
+
+	if (intern->fd == -1) {
+		phongo_throw_exception(PHONGO_ERROR_RUNTIME, "Failed to create temporary file for results");
+		goto failure;
+	}
+
+#ifdef PHP_WIN32
+	/* Open files cannot be unlinked on Windows, so this is deferred until the
+	 * ResultSet is freed. */
+	intern->path = path;
+	path         = NULL;
+#else
+	/* Unlink the file immediately so it is removed even if the process exits
+	 * abnormally. */
+	unlink(ZSTR_VAL(path));
+#endif
+
+	if (!php_phongo_cursor_visit_raw(cursor, php_phongo_resultset_append, &writer)) {
+		/* Exception should already have been thrown */
+		goto failure;
+	}
+
+	if (!php_phongo_resultset_flush(&writer)) {
+		/* Exception should already have been thrown */
+		goto failure;
+	}
+
+	smart_str_free(&writer.buffer);
+
+#ifdef HAVE_MMAP
+	if (intern->size > 0) {
+		void* map = mmap(NULL, intern->size, PROT_READ, MAP_SHARED, intern->fd, 0);
+
+		/* If mapping fails, documents will be read from the file on demand */
+		if (map != MAP_FAILED) {
+			intern->map = map;
+		}
+	}
+#endif
+
+	if (path) {
+		zend_string_release(path);
+	}
+
+	return true;
+
+failure:
+	if (path) {
+		zend_string_release(path);
+	}
+
+	smart_str_free(&writer.buffer);
+
+	zval_ptr_dtor(return_value);
+	ZVAL_NULL(return_value);
+
+	return false;
+} /* }}} */
+
+/* {{{ proto integer MongoDB\Driver\ResultSet::count()
+   Returns the number of documents in the result set */
+static PHP_METHOD(ResultSet, count)
+{
+	zend_error_handling     error_handling;
+	php_phongo_resultset_t* intern;
+
+	intern = Z_RESULTSET_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	RETURN_LONG(intern->count);
+} /* }}} */
+
+/* {{{ proto array|object MongoDB\Driver\ResultSet::get(integer $index)
+   Returns the document at the given position in the result set */
+static PHP_METHOD(ResultSet, get)
+{
+	zend_error_handling     error_handling;
+	php_phongo_resultset_t* intern;
+	zend_long               index;
+	php_phongo_bson_state   state;
+
+	intern = Z_RESULTSET_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters(ZEND_NUM_ARGS(), "l", &index) == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	if (index < 0 || index >= intern->count) {
+		phongo_throw_exception(PHONGO_ERROR_INVALID_ARGUMENT, "Index %" PHONGO_LONG_FORMAT " is out of range for a result set of %" PHONGO_LONG_FORMAT " documents", index, intern->count);
+		return;
+	}
+
+	/* Borrow the type map without taking ownership of it */
+	PHONGO_BSON_INIT_STATE(state);
+	state.map = intern->visitor_data.map;
+
+	if (!php_phongo_resultset_decode(intern, index, &state)) {
+		zval_ptr_dtor(&state.zchild);
+		return;
+	}
+
+	RETURN_ZVAL(&state.zchild, 0, 1);
+} /* }}} */
+
+static PHP_METHOD(ResultSet, current)
+{
+	zend_error_handling     error_handling;
+	php_phongo_resultset_t* intern = Z_RESULTSET_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	if (Z_ISUNDEF(intern->visitor_data.zchild)) {
+		RETURN_NULL();
+	}
+
+	ZVAL_COPY_DEREF(return_value, &intern->visitor_data.zchild);
+}
+
+static PHP_METHOD(ResultSet, key)
+{
+	zend_error_handling     error_handling;
+	php_phongo_resultset_t* intern = Z_RESULTSET_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	if (intern->current >= intern->count) {
+		RETURN_NULL();
+	}
+
+	RETURN_LONG(intern->current);
+}
+
+static PHP_METHOD(ResultSet, next)
+{
+	zend_error_handling     error_handling;
+	php_phongo_resultset_t* intern = Z_RESULTSET_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	if (intern->current < intern->count) {
+		intern->current++;
+	}
+
+	php_phongo_resultset_load_current(intern);
+}
+
+static PHP_METHOD(ResultSet, valid)
+{
+	zend_error_handling     error_handling;
+	php_phongo_resultset_t* intern = Z_RESULTSET_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	RETURN_BOOL(intern->current < intern->count && !Z_ISUNDEF(intern->visitor_data.zchild));
+}
+
+static PHP_METHOD(ResultSet, rewind)
+{
+	zend_error_handling     error_handling;
+	php_phongo_resultset_t* intern = Z_RESULTSET_OBJ_P(getThis());
+
+	zend_replace_error_handling(EH_THROW, phongo_exception_from_phongo_domain(PHONGO_ERROR_INVALID_ARGUMENT), &error_handling);
+	if (zend_parse_parameters_none() == FAILURE) {
+		zend_restore_error_handling(&error_handling);
+		return;
+	}
+	zend_restore_error_handling(&error_handling);
+
+	/* Unlike cursors, result sets may be iterated any number of times */
+	intern->current = 0;
+
+	php_phongo_resultset_load_current(intern);
+}
+
+/* {{{ MongoDB\Driver\ResultSet function entries */
+ZEND_BEGIN_ARG_INFO_EX(ai_ResultSet_get, 0, 0, 1)
+	ZEND_ARG_INFO(0, index)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(ai_ResultSet_void, 0, 0, 0)
+ZEND_END_ARG_INFO()
+
+static zend_function_entry php_phongo_resultset_me[] = {
+	/* clang-format off */
+	PHP_ME(ResultSet, count, ai_ResultSet_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(ResultSet, get, ai_ResultSet_get, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+
+	PHP_ME(ResultSet, current, ai_ResultSet_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(ResultSet, key, ai_ResultSet_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(ResultSet, next, ai_ResultSet_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(ResultSet, valid, ai_ResultSet_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_ME(ResultSet, rewind, ai_ResultSet_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+
+	ZEND_NAMED_ME(__construct, PHP_FN(MongoDB_disabled___construct), ai_ResultSet_void, ZEND_ACC_PRIVATE | ZEND_ACC_FINAL)
+	ZEND_NAMED_ME(__wakeup, PHP_FN(MongoDB_disabled___wakeup), ai_ResultSet_void, ZEND_ACC_PUBLIC | ZEND_ACC_FINAL)
+	PHP_FE_END
+	/* clang-format on */
+};
+/* }}} */
+
+/* {{{ MongoDB\Driver\ResultSet object handlers */
+static zend_object_handlers php_phongo_handler_resultset;
+
+static void php_phongo_resultset_free_object(zend_object* object) /* {{{ */
+{
+	php_phongo_resultset_t* intern = Z_OBJ_RESULTSET(object);
+
+	zend_object_std_dtor(&intern->std);
+
+#ifdef HAVE_MMAP
+	if (intern->map) {
+		munmap(intern->map, intern->size);
+	}
+#endif
+
+	if (intern->fd != -1) {
+		close(intern->fd);
+	}
+
+	if (intern->path) {
+		unlink(ZSTR_VAL(intern->path));
+		zend_string_release(intern->path);
+	}
+
+	if (intern->offsets) {
+		efree(intern->offsets);
+	}
+
+	php_phongo_bson_typemap_dtor(&intern->visitor_data.map);
+
+	php_phongo_resultset_free_current(intern);
+} /* }}} */
+
+static zend_object* php_phongo_resultset_create_object(zend_class_entry* class_type) /* {{{ */
+{
+	php_phongo_resultset_t* intern = NULL;
+
+	intern = PHONGO_ALLOC_OBJECT_T(php_phongo_resultset_t, class_type);
+
+	zend_object_std_init(&intern->std, class_type);
+	object_properties_init(&intern->std, class_type);
+
+	intern->fd = -1;
+
+	intern->std.handlers = &php_phongo_handler_resultset;
+
+	return &intern->std;
+} /* }}} */
+
+static HashTable* php_phongo_resultset_get_debug_info(phongo_compat_object_handler_type* object, int* is_temp) /* {{{ */
+{
+	php_phongo_resultset_t* intern;
+	zval                    retval = ZVAL_STATIC_INIT;
+
+	*is_temp = 1;
+	intern   = Z_OBJ_RESULTSET(PHONGO_COMPAT_GET_OBJ(object));
+
+	array_init_size(&retval, 2);
+
+	ADD_ASSOC_LONG_EX(&retval, "count", intern->count);
+	ADD_ASSOC_LONG_EX(&retval, "currentIndex", intern->current);
+
+	return Z_ARRVAL(retval);
+} /* }}} */
+/* }}} */
+
+void php_phongo_resultset_init_ce(INIT_FUNC_ARGS) /* {{{ */
+{
+	zend_class_entry ce;
+
+	INIT_NS_CLASS_ENTRY(ce, "MongoDB\\Driver", "ResultSet", php_phongo_resultset_me);
+	php_phongo_resultset_ce                = zend_register_internal_class(&ce);
+	php_phongo_resultset_ce->create_object = php_phongo_resultset_create_object;
+	PHONGO_CE_FINAL(php_phongo_resultset_ce);
+	PHONGO_CE_DISABLE_SERIALIZATION(php_phongo_resultset_ce);
+
+	zend_class_implements(php_phongo_resultset_ce, 1, zend_ce_iterator);
+	zend_class_implements(php_phongo_resultset_ce, 1, spl_ce_Countable);
+
+	memcpy(&php_phongo_handler_resultset, phongo_get_std_object_handlers(), sizeof(zend_object_handlers));
+	php_phongo_handler_resultset.get_debug_info = php_phongo_resultset_get_debug_info;
+	php_phongo_handler_resultset.free_obj       = php_phongo_resultset_free_object;
+	php_phongo_handler_resultset.offset         = XtOffsetOf(php_phongo_resultset_t, std);
+} /* }}} */
+
+/*
+ * Local variables:
+ * tab-width: 4
+ * c-basic-offset: 4
+ * End:
+ * vim600: noet sw=4 ts=4 fdm=marker
+ * vim<600: noet sw=4 ts=4
+ */
@@ -947,6 +947,47 @@ bool php_phongo_bson_value_to_zval(const bson_value_t* value, zval* zv) /* {{{ *
 	zval*                 return_value;
 	bool                  retval = false;
 
+	/* Scalar types map directly onto PHP values and do not need to be routed
+	 * through a temporary document and the visitor machinery. */
+	switch (value->value_type) {
+		case BSON_TYPE_INT32:
+			ZVAL_LONG(zv, value->value.v_int32);
+			return true;
+
+#if SIZEOF_ZEND_LONG == 8
+		case BSON_TYPE_INT64:
+			ZVAL_LONG(zv, value->value.v_int64);
+			return true;
+#endif
+
+		case BSON_TYPE_DOUBLE:
+			ZVAL_DOUBLE(zv, value->value.v_double);
+			return true;
+
+		case BSON_TYPE_BOOL:
+			ZVAL_BOOL(zv, value->value.v_bool);
+			return true;
+
+		case BSON_TYPE_NULL:
+			ZVAL_NULL(zv);
+			return true;
+
+		case BSON_TYPE_UTF8:
+			/* Invalid strings fall through so that an exception is thrown */
+			if (bson_utf8_validate(value->value.v_utf8.str, value->value.v_utf8.len, true)) {
+				ZVAL_STRINGL(zv, value->value.v_utf8.str, value->value.v_utf8.len);
+				return true;
+			}
+			break;
+
+		case BSON_TYPE_OID:
+			php_phongo_objectid_new_from_oid(zv, &value->value.v_oid);
+			return true;
+
+		default:
+			break;
+	}
+
 	PHONGO_BSON_INIT_STATE(state);
 	state.map.root_type = PHONGO_TYPEMAP_NATIVE_ARRAY;
 
@@ -969,6 +1010,270 @@ cleanup:
 	return retval;
 } /* }}} */
 
+/* Returns the canonical type order of a BSON type, as used by the server when
+ * comparing values of different types. Numeric types share an order, as do
+ * strings and symbols. */
+static int php_phongo_bson_type_order(bson_type_t type) /* {{{ */
+{
+	switch (type) {
+		case BSON_TYPE_MINKEY:
+			return -1;
+		case BSON_TYPE_EOD:
+		case BSON_TYPE_UNDEFINED:
+			return 0;
+		case BSON_TYPE_NULL:
+			return 5;
+		case BSON_TYPE_DOUBLE:
+		case BSON_TYPE_INT32:
+		case BSON_TYPE_INT64:
+		case BSON_TYPE_DECIMAL128:
+			return 10;
+		case BSON_TYPE_UTF8:
+		case BSON_TYPE_SYMBOL:
+			return 15;
+		case BSON_TYPE_DOCUMENT:
+			return 20;
+		case BSON_TYPE_ARRAY:
+			return 25;
+		case BSON_TYPE_BINARY:
+			return 30;
+		case BSON_TYPE_OID:
+			return 35;
+		case BSON_TYPE_BOOL:
+			return 40;
+		case BSON_TYPE_DATE_TIME:
+			return 45;
+		case BSON_TYPE_TIMESTAMP:
+			return 47;
+		case BSON_TYPE_REGEX:
+			return 50;
+		case BSON_TYPE_DBPOINTER:
+			return 55;
+		case BSON_TYPE_CODE:
+			return 60;
+		case BSON_TYPE_CODEWSCOPE:
+			return 65;
+		case BSON_TYPE_MAXKEY:
+		default:
+			return 127;
+	}
+} /* }}} */
+
+#define PHONGO_COMPARE(a, b) ((a) < (b) ? -1 : ((a) > (b) ? 1 : 0))
+
+static int php_phongo_bson_compare_int64_double(int64_t i, double d) /* {{{ */
+{
+	/* NaN sorts before all other numbers */
+	if (zend_isnan(d)) {
+		return 1;
+	}
+
+	if (d >= 9223372036854775808.0) {
+		return -1;
+	}
+
+	if (d < -9223372036854775808.0) {
+		return 1;
+	}
+
+	if ((double) i != d) {
+		return PHONGO_COMPARE((double) i, d);
+	}
+
+	/* The double is integral and in range, so it may be compared exactly */
+	return PHONGO_COMPARE(i, (int64_t) d);
+} /* }}} */
+
+static double php_phongo_bson_decimal128_to_double(const bson_decimal128_t* decimal) /* {{{ */
+{
+	char str[BSON_DECIMAL128_STRING];
+
+	bson_decimal128_to_string(decimal, str);
+
+	return zend_strtod(str, NULL);
+} /* }}} */
+
+static int php_phongo_bson_compare_numbers(const bson_value_t* a, const bson_value_t* b) /* {{{ */
+{
+	bool    a_is_int = a->value_type == BSON_TYPE_INT32 || a->value_type == BSON_TYPE_INT64;
+	bool    b_is_int = b->value_type == BSON_TYPE_INT32 || b->value_type == BSON_TYPE_INT64;
+	int64_t a_int    = a->value_type == BSON_TYPE_INT32 ? a->value.v_int32 : a->value.v_int64;
+	int64_t b_int    = b->value_type == BSON_TYPE_INT32 ? b->value.v_int32 : b->value.v_int64;
+	double  a_double;
+	double  b_double;
+
+	if (a_is_int && b_is_int) {
+		return PHONGO_COMPARE(a_int, b_int);
+	}
+
+	/* Decimal128 values are compared by their nearest double approximation */
+	a_double = a->value_type == BSON_TYPE_DECIMAL128 ? php_phongo_bson_decimal128_to_double(&a->value.v_decimal128) : a->value.v_double;
+	b_double = b->value_type == BSON_TYPE_DECIMAL128 ? php_phongo_bson_decimal128_to_double(&b->value.v_decimal128) : b->value.v_double;
+
+	if (a_is_int) {
+		return php_phongo_bson_compare_int64_double(a_int, b_double);
+	}
+
+	if (b_is_int) {
+		return -php_phongo_bson_compare_int64_double(b_int, a_double);
+	}
+
+	if (zend_isnan(a_double) || zend_isnan(b_double)) {
+		return PHONGO_COMPARE(!zend_isnan(a_double), !zend_isnan(b_double));
+	}
+
+	return PHONGO_COMPARE(a_double, b_double);
+} /* }}} */
+
+static int php_phongo_bson_compare_strings(const char* a, size_t a_len, const char* b, size_t b_len) /* {{{ */
+{
+	int cmp = memcmp(a, b, BSON_MIN(a_len, b_len));
+
+	if (cmp != 0) {
+		return cmp < 0 ? -1 : 1;
+	}
+
+	return PHONGO_COMPARE(a_len, b_len);
+} /* }}} */
+
+static int php_phongo_bson_compare_documents(const uint8_t* a_data, uint32_t a_len, const uint8_t* b_data, uint32_t b_len, bool compare_keys) /* {{{ */
+{
+	bson_t      a_doc, b_doc;
+	bson_iter_t a_iter, b_iter;
+
+	if (!bson_init_static(&a_doc, a_data, a_len) || !bson_init_static(&b_doc, b_data, b_len) || !bson_iter_init(&a_iter, &a_doc) || !bson_iter_init(&b_iter, &b_doc)) {
+		return PHONGO_COMPARE(a_len, b_len);
+	}
+
+	while (true) {
+		bool a_next = bson_iter_next(&a_iter);
+		bool b_next = bson_iter_next(&b_iter);
+		int  cmp;
+
+		if (!a_next || !b_next) {
+			return PHONGO_COMPARE(a_next, b_next);
+		}
+
+		cmp = PHONGO_COMPARE(php_phongo_bson_type_order(bson_iter_type(&a_iter)), php_phongo_bson_type_order(bson_iter_type(&b_iter)));
+
+		if (cmp != 0) {
+			return cmp;
+		}
+
+		if (compare_keys) {
+			cmp = strcmp(bson_iter_key(&a_iter), bson_iter_key(&b_iter));
+
+			if (cmp != 0) {
+				return cmp < 0 ? -1 : 1;
+			}
+		}
+
+		cmp = php_phongo_bson_value_compare(bson_iter_value(&a_iter), bson_iter_value(&b_iter));
+
+		if (cmp != 0) {
+			return cmp;
+		}
+	}
+} /* }}} */
+
+/* Compares two BSON values using the server's comparison order for values of
+ * different types (MinKey < null < numbers < strings < documents < arrays <
+ * binary < ObjectId < bool < date < timestamp < regex < MaxKey). Strings are
+ * compared bytewise (i.e. the "simple" collation). Returns a negative number,
+ * zero, or a positive number if a is less than, equal to, or greater than b. */
+int php_phongo_bson_value_compare(const bson_value_t* a, const bson_value_t* b) /* {{{ */
+{
+	int cmp = PHONGO_COMPARE(php_phongo_bson_type_order(a->value_type), php_phongo_bson_type_order(b->value_type));
+
+	if (cmp != 0) {
+		return cmp;
+	}
+
+	switch (a->value_type) {
+		case BSON_TYPE_DOUBLE:
+		case BSON_TYPE_INT32:
+		case BSON_TYPE_INT64:
+		case BSON_TYPE_DECIMAL128:
+			return php_phongo_bson_compare_numbers(a, b);
+
+		case BSON_TYPE_UTF8:
+		case BSON_TYPE_SYMBOL: {
+			const char* a_str = a->value_type == BSON_TYPE_UTF8 ? a->value.v_utf8.str : a->value.v_symbol.symbol;
+			size_t      a_len = a->value_type == BSON_TYPE_UTF8 ? a->value.v_utf8.len : a->value.v_symbol.len;
+			const char* b_str = b->value_type == BSON_TYPE_UTF8 ? b->value.v_utf8.str : b->value.v_symbol.symbol;
+			size_t      b_len = b->value_type == BSON_TYPE_UTF8 ? b->value.v_utf8.len : b->value.v_symbol.len;
+
+			return php_phongo_bson_compare_strings(a_str, a_len, b_str, b_len);
+		}
+
+		case BSON_TYPE_DOCUMENT:
+			return php_phongo_bson_compare_documents(a->value.v_doc.data, a->value.v_doc.data_len, b->value.v_doc.data, b->value.v_doc.data_len, true);
+
+		case BSON_TYPE_ARRAY:
+			return php_phongo_bson_compare_documents(a->value.v_doc.data, a->value.v_doc.data_len, b->value.v_doc.data, b->value.v_doc.data_len, false);
+
+		case BSON_TYPE_BINARY:
+			if ((cmp = PHONGO_COMPARE(a->value.v_binary.data_len, b->value.v_binary.data_len)) != 0) {
+				return cmp;
+			}
+
+			if ((cmp = PHONGO_COMPARE(a->value.v_binary.subtype, b->value.v_binary.subtype)) != 0) {
+				return cmp;
+			}
+
+			return php_phongo_bson_compare_strings((const char*) a->value.v_binary.data, a->value.v_binary.data_len, (const char*) b->value.v_binary.data, b->value.v_binary.data_len);
+
+		case BSON_TYPE_OID:
+			cmp = bson_oid_compare(&a->value.v_oid, &b->value.v_oid);
+			return PHONGO_COMPARE(cmp, 0);
+
+		case BSON_TYPE_BOOL:
+			return PHONGO_COMPARE(a->value.v_bool, b->value.v_bool);
+
+		case BSON_TYPE_DATE_TIME:
+			return PHONGO_COMPARE(a->value.v_datetime, b->value.v_datetime);
+
+		case BSON_TYPE_TIMESTAMP:
+			if ((cmp = PHONGO_COMPARE(a->value.v_timestamp.timestamp, b->value.v_timestamp.timestamp)) != 0) {
+				return cmp;
+			}
+
+			return PHONGO_COMPARE(a->value.v_timestamp.increment, b->value.v_timestamp.increment);
+
+		case BSON_TYPE_REGEX:
+			if ((cmp = strcmp(a->value.v_regex.regex, b->value.v_regex.regex)) != 0) {
+				return cmp < 0 ? -1 : 1;
+			}
+
+			cmp = strcmp(a->value.v_regex.options, b->value.v_regex.options);
+			return PHONGO_COMPARE(cmp, 0);
+
+		case BSON_TYPE_DBPOINTER:
+			if ((cmp = php_phongo_bson_compare_strings(a->value.v_dbpointer.collection, a->value.v_dbpointer.collection_len, b->value.v_dbpointer.collection, b->value.v_dbpointer.collection_len)) != 0) {
+				return cmp;
+			}
+
+			cmp = bson_oid_compare(&a->value.v_dbpointer.oid, &b->value.v_dbpointer.oid);
+			return PHONGO_COMPARE(cmp, 0);
+
+		case BSON_TYPE_CODE:
+			return php_phongo_bson_compare_strings(a->value.v_code.code, a->value.v_code.code_len, b->value.v_code.code, b->value.v_code.code_len);
+
+		case BSON_TYPE_CODEWSCOPE:
+			if ((cmp = php_phongo_bson_compare_strings(a->value.v_codewscope.code, a->value.v_codewscope.code_len, b->value.v_codewscope.code, b->value.v_codewscope.code_len)) != 0) {
+				return cmp;
+			}
+
+			return php_phongo_bson_compare_documents(a->value.v_codewscope.scope_data, a->value.v_codewscope.scope_len, b->value.v_codewscope.scope_data, b->value.v_codewscope.scope_len, true);
+
+		default:
+			/* MinKey, MaxKey, null and undefined are only equal to themselves */
+			return 0;
+	}
+} /* }}} */
+
+#undef PHONGO_COMPARE
+
 /* Converts a BSON document to a PHP value according to the typemap specified in
  * the state argument.
  *
@@ -1215,6 +1520,30 @@ bool php_phongo_bson_state_add_field_path(php_phongo_bson_typemap* map, char* fi
 	return true;
 }
 
+/* Copies a type map, including its field paths. The destination must later be
+ * freed with php_phongo_bson_typemap_dtor(). */
+void php_phongo_bson_typemap_copy(php_phongo_bson_typemap* dst, const php_phongo_bson_typemap* src)
+{
+	size_t i, j;
+
+	*dst                            = *src;
+	dst->field_paths.map            = NULL;
+	dst->field_paths.size           = 0;
+	dst->field_paths.allocated_size = 0;
+
+	for (i = 0; i < src->field_paths.size; i++) {
+		php_phongo_field_path_map_element* src_element = src->field_paths.map[i];
+		php_phongo_field_path_map_element* dst_element = field_path_map_element_alloc();
+
+		for (j = 0; j < src_element->entry->size; j++) {
+			php_phongo_field_path_push(dst_element->entry, src_element->entry->elements[j], src_element->entry->element_types[j]);
+		}
+
+		field_path_map_element_set_info(dst_element, src_element->node_type, src_element->node_ce);
+		map_add_field_path_element(dst, dst_element);
+	}
+}
+
 void php_phongo_bson_typemap_dtor(php_phongo_bson_typemap* map)
 {
 	size_t i;
@@ -0,0 +1,55 @@
+--TEST--
+MongoDB\Driver\BulkWrite::__construct() with invalid auto-flush options
+--FILE--
+<?php
+
+require_once __DIR__ . '/../utils/tools.php';
+
+$manager = new MongoDB\Driver\Manager();
+
+echo throws(function() use ($manager) {
+    new MongoDB\Driver\BulkWrite(['manager' => $manager]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n\n";
+
+echo throws(function() {
+    new MongoDB\Driver\BulkWrite(['manager' => new stdClass, 'namespace' => 'db.coll']);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n\n";
+
+echo throws(function() use ($manager) {
+    new MongoDB\Driver\BulkWrite(['manager' => $manager, 'namespace' => 1]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n\n";
+
+echo throws(function() use ($manager) {
+    new MongoDB\Driver\BulkWrite(['manager' => $manager, 'namespace' => 'db']);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n\n";
+
+echo throws(function() use ($manager) {
+    new MongoDB\Driver\BulkWrite(['manager' => $manager, 'namespace' => 'db.coll', 'flushOperations' => 0]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n\n";
+
+echo throws(function() use ($manager) {
+    new MongoDB\Driver\BulkWrite(['manager' => $manager, 'namespace' => 'db.coll', 'writeConcern' => 1]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+The "manager" and "namespace" options must be specified together
+
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected "manager" option to be MongoDB\Driver\Manager, stdClass given
+
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected "namespace" option to be string, %s given
+
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Invalid namespace provided: db
+
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected "flushOperations" option to be >= 1, 0 given
+
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected "writeConcern" option to be MongoDB\Driver\WriteConcern, %s given
+===DONE===
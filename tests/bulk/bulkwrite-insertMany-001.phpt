@@ -0,0 +1,47 @@
+--TEST--
+MongoDB\Driver\BulkWrite::insertMany() returns the identifier of each document
+--FILE--
+<?php
+
+$bulk = new MongoDB\Driver\BulkWrite;
+
+var_dump($bulk->insertMany([
+    ['_id' => 1, 'x' => 1],
+    ['x' => 2],
+    (object) ['_id' => 'foo', 'x' => 3],
+]));
+
+var_dump($bulk->insertMany(new ArrayIterator([
+    ['_id' => ['a' => 1]],
+])));
+
+var_dump($bulk->insertMany([]));
+
+var_dump(count($bulk));
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+array(3) {
+  [0]=>
+  int(1)
+  [1]=>
+  object(MongoDB\BSON\ObjectId)#%d (%d) {
+    ["oid"]=>
+    string(24) "%x"
+  }
+  [2]=>
+  string(3) "foo"
+}
+array(1) {
+  [0]=>
+  object(stdClass)#%d (%d) {
+    ["a"]=>
+    int(1)
+  }
+}
+array(0) {
+}
+int(4)
+===DONE===
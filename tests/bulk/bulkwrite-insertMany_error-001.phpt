@@ -0,0 +1,46 @@
+--TEST--
+MongoDB\Driver\BulkWrite::insertMany() with invalid arguments
+--FILE--
+<?php
+
+require_once __DIR__ . '/../utils/tools.php';
+
+$bulk = new MongoDB\Driver\BulkWrite;
+
+echo throws(function() use ($bulk) {
+    $bulk->insertMany('foo');
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n\n";
+
+echo throws(function() use ($bulk) {
+    $bulk->insertMany(new stdClass);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n\n";
+
+echo throws(function() use ($bulk) {
+    $bulk->insertMany([['x' => 1], 2]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n\n";
+
+echo throws(function() use ($bulk) {
+    $bulk->insertMany(new ArrayIterator([['x' => 1], ['$x' => 1]]));
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n\n";
+
+/* Documents preceding the invalid document remain in the BulkWrite */
+var_dump(count($bulk));
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected documents to be array or Traversable, string given
+
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected documents to be array or Traversable, stdClass given
+
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected document to be array or object, %s given
+
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+invalid document for insert: keys cannot begin with "$": "$x"
+
+int(2)
+===DONE===
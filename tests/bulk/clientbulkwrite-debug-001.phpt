@@ -0,0 +1,39 @@
+--TEST--
+MongoDB\Driver\ClientBulkWrite debug output before execution
+--FILE--
+<?php
+
+$bulk = new MongoDB\Driver\ClientBulkWrite(['ordered' => false]);
+$bulk->insert('db.foo', ['x' => 1]);
+$bulk->insert('db.bar', ['x' => 1]);
+$bulk->update('db.foo', ['x' => 1], ['$set' => ['y' => 1]]);
+$bulk->delete('db.baz', ['x' => 1]);
+
+var_dump($bulk);
+var_dump(count($bulk));
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+object(MongoDB\Driver\ClientBulkWrite)#%d (%d) {
+  ["namespaces"]=>
+  array(3) {
+    ["db.foo"]=>
+    int(2)
+    ["db.bar"]=>
+    int(1)
+    ["db.baz"]=>
+    int(1)
+  }
+  ["ordered"]=>
+  bool(false)
+  ["bypassDocumentValidation"]=>
+  NULL
+  ["executed"]=>
+  bool(false)
+  ["session"]=>
+  NULL
+}
+int(4)
+===DONE===
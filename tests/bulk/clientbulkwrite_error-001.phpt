@@ -0,0 +1,40 @@
+--TEST--
+MongoDB\Driver\ClientBulkWrite operations require a valid namespace
+--FILE--
+<?php
+require_once __DIR__ . '/../utils/tools.php';
+
+$bulk = new MongoDB\Driver\ClientBulkWrite;
+
+echo throws(function() use ($bulk) {
+    $bulk->insert('foo', ['x' => 1]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+echo throws(function() use ($bulk) {
+    $bulk->update('.foo', ['x' => 1], ['$set' => ['x' => 2]]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+echo throws(function() use ($bulk) {
+    $bulk->delete('foo.', ['x' => 1]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+echo throws(function() use ($bulk) {
+    $bulk->update('db.foo', ['x' => 1], ['x' => 2], ['multi' => true]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+var_dump(count($bulk));
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Invalid namespace provided: foo
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Invalid namespace provided: .foo
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Invalid namespace provided: foo.
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Replacement document conflicts with true "multi" option
+int(0)
+===DONE===
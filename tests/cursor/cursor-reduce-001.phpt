@@ -0,0 +1,80 @@
+--TEST--
+MongoDB\Driver\Cursor::reduce()
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite();
+$bulk->insert(['_id' => 1, 'status' => 'A', 'amount' => 10, 'ts' => 3]);
+$bulk->insert(['_id' => 2, 'status' => 'B', 'amount' => 2.5, 'ts' => 7]);
+$bulk->insert(['_id' => 3, 'status' => 'A', 'amount' => 5, 'ts' => 1]);
+$bulk->insert(['_id' => 4, 'amount' => 'n/a']);
+$manager->executeBulkWrite(NS, $bulk);
+
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([], ['sort' => ['_id' => 1]]));
+var_dump($cursor->reduce(['sum' => 'amount', 'max' => 'ts', 'min' => ['ts', 'status']]));
+
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([], ['sort' => ['_id' => 1]]));
+var_dump($cursor->reduce(['groupBy' => 'status', 'sum' => 'amount', 'avg' => 'amount']));
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+array(4) {
+  ["count"]=>
+  int(4)
+  ["sum"]=>
+  float(17.5)
+  ["max"]=>
+  int(7)
+  ["min"]=>
+  array(2) {
+    ["ts"]=>
+    int(1)
+    ["status"]=>
+    string(1) "A"
+  }
+}
+array(3) {
+  [0]=>
+  array(4) {
+    ["_id"]=>
+    string(1) "A"
+    ["count"]=>
+    int(2)
+    ["sum"]=>
+    int(15)
+    ["avg"]=>
+    float(7.5)
+  }
+  [1]=>
+  array(4) {
+    ["_id"]=>
+    string(1) "B"
+    ["count"]=>
+    int(1)
+    ["sum"]=>
+    float(2.5)
+    ["avg"]=>
+    float(2.5)
+  }
+  [2]=>
+  array(4) {
+    ["_id"]=>
+    NULL
+    ["count"]=>
+    int(1)
+    ["sum"]=>
+    int(0)
+    ["avg"]=>
+    NULL
+  }
+}
+===DONE===
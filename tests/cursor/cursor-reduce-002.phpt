@@ -0,0 +1,38 @@
+--TEST--
+MongoDB\Driver\Cursor::reduce() sums and averages Decimal128 values
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite();
+$bulk->insert(['_id' => 1, 'status' => 'A', 'amount' => 10]);
+$bulk->insert(['_id' => 2, 'status' => 'A', 'amount' => new MongoDB\BSON\Decimal128('5.25')]);
+$bulk->insert(['_id' => 3, 'status' => 'A', 'amount' => 1]);
+$bulk->insert(['_id' => 4, 'status' => 'B', 'amount' => 2.5]);
+$bulk->insert(['_id' => 5, 'status' => 'B', 'amount' => new MongoDB\BSON\Decimal128('0.5')]);
+$manager->executeBulkWrite(NS, $bulk);
+
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([], ['sort' => ['_id' => 1]]));
+
+foreach ($cursor->reduce(['groupBy' => 'status', 'sum' => 'amount', 'avg' => 'amount']) as $group) {
+    printf("%s: sum=%s avg=%s\n", $group['_id'], $group['sum'], $group['avg']);
+    var_dump($group['sum'] instanceof MongoDB\BSON\Decimal128, $group['avg'] instanceof MongoDB\BSON\Decimal128);
+}
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+A: sum=16.25 avg=5.416666666666666666666666666666667
+bool(true)
+bool(true)
+B: sum=3.00000000000000 avg=1.50000000000000
+bool(true)
+bool(true)
+===DONE===
@@ -0,0 +1,42 @@
+--TEST--
+MongoDB\Driver\Cursor::reduce() with invalid specifications
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([]));
+
+$specs = [
+    ['median' => 'x'],
+    ['sum' => 1],
+    ['sum' => []],
+    ['max' => ['x', '']],
+    ['groupBy' => ['x']],
+];
+
+foreach ($specs as $spec) {
+    echo throws(function() use ($cursor, $spec) {
+        $cursor->reduce($spec);
+    }, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+}
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Unsupported reducer: "median"
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected "sum" reducer to be a field name or a non-empty array of field names, %s given
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected "sum" reducer to be a field name or a non-empty array of field names, array given
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected "max" reducer to contain only non-empty field names
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected "groupBy" to be a non-empty field name
+===DONE===
@@ -0,0 +1,59 @@
+--TEST--
+MongoDB\Driver\Cursor debug output for exhausted command cursor omits implicit session
+--SKIPIF--
+<?php require __DIR__ . "/" ."../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_libmongoc_crypto(); ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_server_version('<', '3.6'); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite;
+$bulk->insert(['_id' => 1]);
+$bulk->insert(['_id' => 2]);
+$manager->executeBulkWrite(NS, $bulk);
+
+$command = new MongoDB\Driver\Command([
+    'aggregate' => COLLECTION_NAME,
+    'pipeline' => [['$match' => new stdClass]],
+    'cursor' => new stdClass,
+]);
+
+$lsids = [];
+
+(new CommandObserver)->observe(
+    function() use ($manager, $command) {
+        $cursor = $manager->executeCommand(DATABASE_NAME, $command);
+
+        printf("Cursor ID is zero: %s\n", (string) $cursor->getId() === '0' ? 'yes' : 'no');
+        var_dump($cursor);
+
+        $manager->executeCommand(DATABASE_NAME, new MongoDB\Driver\Command(['ping' => 1]));
+    },
+    function(stdClass $command) use (&$lsids) {
+        $lsids[] = bin2hex((string) $command->lsid->id);
+    }
+);
+
+/* The implicit session is returned to the pool as soon as the command
+ * completes, so the following command should reuse it. */
+printf("\nCommands used the same session: %s\n", count($lsids) === 2 && $lsids[0] === $lsids[1] ? 'yes' : 'no');
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+Cursor ID is zero: yes
+object(MongoDB\Driver\Cursor)#%d (%d) {
+  %a
+  ["session"]=>
+  NULL
+  %a
+}
+
+Commands used the same session: yes
+===DONE===
@@ -0,0 +1,69 @@
+--TEST--
+MongoDB\Driver\Cursor::toColumns()
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite();
+$bulk->insert(['_id' => 1, 'price' => 1.5, 'qty' => 3, 'meta' => ['tag' => 'a']]);
+$bulk->insert(['_id' => 2, 'price' => 2.0, 'meta' => ['tag' => 'b']]);
+$bulk->insert(['_id' => 3, 'qty' => 7]);
+$manager->executeBulkWrite(NS, $bulk);
+
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([], ['sort' => ['_id' => 1]]));
+var_dump($cursor->toColumns(['price', 'qty', 'meta.tag']));
+
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([], ['sort' => ['_id' => 1]]));
+var_dump($cursor->toColumns(['qty'], ['missingValue' => 0]));
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+array(3) {
+  ["price"]=>
+  array(3) {
+    [0]=>
+    float(1.5)
+    [1]=>
+    float(2)
+    [2]=>
+    NULL
+  }
+  ["qty"]=>
+  array(3) {
+    [0]=>
+    int(3)
+    [1]=>
+    NULL
+    [2]=>
+    int(7)
+  }
+  ["meta.tag"]=>
+  array(3) {
+    [0]=>
+    string(1) "a"
+    [1]=>
+    string(1) "b"
+    [2]=>
+    NULL
+  }
+}
+array(1) {
+  ["qty"]=>
+  array(3) {
+    [0]=>
+    int(3)
+    [1]=>
+    int(0)
+    [2]=>
+    int(7)
+  }
+}
+===DONE===
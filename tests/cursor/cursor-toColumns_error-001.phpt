@@ -0,0 +1,36 @@
+--TEST--
+MongoDB\Driver\Cursor::toColumns() expects non-empty string field names
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([]));
+
+echo throws(function() use ($cursor) {
+    $cursor->toColumns([]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+echo throws(function() use ($cursor) {
+    $cursor->toColumns(['x', 1]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+echo throws(function() use ($cursor) {
+    $cursor->toColumns(['']);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected at least one field
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected fields to contain only strings, %s given
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected field names to be non-empty and not contain null bytes
+===DONE===
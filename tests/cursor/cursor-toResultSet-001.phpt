@@ -0,0 +1,58 @@
+--TEST--
+MongoDB\Driver\Cursor::toResultSet() returns a repeatable result set
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite();
+$bulk->insert(['_id' => 1, 'x' => ['y' => 'a']]);
+$bulk->insert(['_id' => 2, 'x' => ['y' => 'b']]);
+$bulk->insert(['_id' => 3, 'x' => ['y' => 'c']]);
+$manager->executeBulkWrite(NS, $bulk);
+
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([], ['batchSize' => 2]));
+$cursor->setTypeMap(['root' => 'array', 'document' => 'array']);
+
+$resultSet = $cursor->toResultSet();
+
+var_dump(count($resultSet));
+var_dump($resultSet->get(1));
+
+foreach ($resultSet as $key => $document) {
+    printf("%d: %d\n", $key, $document['_id']);
+}
+
+foreach ($resultSet as $key => $document) {
+    printf("%d: %s\n", $key, $document['x']['y']);
+}
+
+var_dump($cursor->isDead());
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+int(3)
+array(2) {
+  ["_id"]=>
+  int(2)
+  ["x"]=>
+  array(1) {
+    ["y"]=>
+    string(1) "b"
+  }
+}
+0: 1
+1: 2
+2: 3
+0: a
+1: b
+2: c
+bool(true)
+===DONE===
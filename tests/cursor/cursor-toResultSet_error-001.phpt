@@ -0,0 +1,44 @@
+--TEST--
+MongoDB\Driver\ResultSet::get() with an out of range index
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite();
+$bulk->insert(['_id' => 1]);
+$manager->executeBulkWrite(NS, $bulk);
+
+$resultSet = $manager->executeQuery(NS, new MongoDB\Driver\Query([]))->toResultSet();
+
+echo throws(function() use ($resultSet) {
+    $resultSet->get(1);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+echo throws(function() use ($resultSet) {
+    $resultSet->get(-1);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([]));
+foreach ($cursor as $document) {}
+
+echo throws(function() use ($cursor) {
+    $cursor->toResultSet();
+}, 'MongoDB\Driver\Exception\LogicException'), "\n";
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Index 1 is out of range for a result set of 1 documents
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Index -1 is out of range for a result set of 1 documents
+OK: Got MongoDB\Driver\Exception\LogicException
+Cursors cannot rewind after starting iteration
+===DONE===
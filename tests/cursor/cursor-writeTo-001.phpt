@@ -0,0 +1,66 @@
+--TEST--
+MongoDB\Driver\Cursor::writeTo()
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite();
+$bulk->insert(['_id' => 1, 'x' => 1]);
+$bulk->insert(['_id' => 2, 'x' => 2.5]);
+$manager->executeBulkWrite(NS, $bulk);
+
+$formats = [
+    'FORMAT_RELAXED_EXTENDED_JSON' => MongoDB\Driver\Cursor::FORMAT_RELAXED_EXTENDED_JSON,
+    'FORMAT_CANONICAL_EXTENDED_JSON' => MongoDB\Driver\Cursor::FORMAT_CANONICAL_EXTENDED_JSON,
+    'FORMAT_JSON_ARRAY' => MongoDB\Driver\Cursor::FORMAT_JSON_ARRAY,
+];
+
+foreach ($formats as $name => $format) {
+    $cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([], ['sort' => ['_id' => 1]]));
+    $stream = fopen('php://memory', 'w+');
+
+    printf("%s: wrote %d documents\n", $name, $cursor->writeTo($stream, $format));
+    rewind($stream);
+    echo stream_get_contents($stream), "\n";
+    fclose($stream);
+}
+
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([], ['sort' => ['_id' => 1]]));
+$stream = fopen('php://memory', 'w+');
+
+printf("FORMAT_BSON: wrote %d documents\n", $cursor->writeTo($stream));
+rewind($stream);
+$bson = stream_get_contents($stream);
+
+for ($offset = 0; $offset < strlen($bson); $offset += $length) {
+    $length = unpack('V', substr($bson, $offset, 4))[1];
+    echo MongoDB\BSON\toRelaxedExtendedJSON(substr($bson, $offset, $length)), "\n";
+}
+
+var_dump($cursor->isDead());
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+FORMAT_RELAXED_EXTENDED_JSON: wrote 2 documents
+{ "_id" : 1, "x" : 1 }
+{ "_id" : 2, "x" : 2.5 }
+
+FORMAT_CANONICAL_EXTENDED_JSON: wrote 2 documents
+{ "_id" : { "$numberInt" : "1" }, "x" : { "$numberInt" : "1" } }
+{ "_id" : { "$numberInt" : "2" }, "x" : { "$numberDouble" : "2.5" } }
+
+FORMAT_JSON_ARRAY: wrote 2 documents
+[{ "_id" : 1, "x" : 1 },{ "_id" : 2, "x" : 2.5 }]
+FORMAT_BSON: wrote 2 documents
+{ "_id" : 1, "x" : 1 }
+{ "_id" : 2, "x" : 2.5 }
+bool(true)
+===DONE===
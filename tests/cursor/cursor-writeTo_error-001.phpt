@@ -0,0 +1,45 @@
+--TEST--
+MongoDB\Driver\Cursor::writeTo() error cases
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite();
+$bulk->insert(['_id' => 1]);
+$bulk->insert(['_id' => 2]);
+$manager->executeBulkWrite(NS, $bulk);
+
+$stream = fopen('php://memory', 'w+');
+
+echo throws(function() use ($manager, $stream) {
+    $cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([]));
+    $cursor->writeTo($stream, 42);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+echo throws(function() use ($manager, $stream) {
+    $cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([]));
+
+    foreach ($cursor as $i => $document) {
+        if ($i == 1) {
+            break;
+        }
+    }
+
+    $cursor->writeTo($stream);
+}, 'MongoDB\Driver\Exception\LogicException'), "\n";
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Invalid format: 42
+OK: Got MongoDB\Driver\Exception\LogicException
+Cursors cannot rewind after starting iteration
+===DONE===
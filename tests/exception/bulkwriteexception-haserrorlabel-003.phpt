@@ -0,0 +1,43 @@
+--TEST--
+MongoDB\Driver\Exception\BulkWriteException::hasErrorLabel() with an auto-flushing BulkWrite
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_replica_set(); ?>
+<?php skip_if_no_failcommand_failpoint(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+// Disable retryWrites since we want to check for a RetryableWriteError error label
+$manager = new MongoDB\Driver\Manager(URI, ['retryWrites' => false]);
+
+configureFailPoint($manager, 'failCommand', [ 'times' => 1 ], [
+    'failCommands' => ['insert'],
+    'writeConcernError' => [
+        'code' => 91,
+        'errmsg' => 'Replication is being shut down',
+        'errorLabels' => ['RetryableWriteError'],
+    ],
+]);
+
+$bulk = new MongoDB\Driver\BulkWrite(['manager' => $manager, 'namespace' => NS, 'flushOperations' => 2]);
+
+// The first flush reports the write concern error, which does not stop execution
+$bulk->insertMany([['x' => 1], ['x' => 2], ['x' => 3]]);
+
+try {
+    $manager->executeBulkWrite(NS, $bulk);
+} catch (MongoDB\Driver\Exception\BulkWriteException $e) {
+    var_dump($e->hasErrorLabel('RetryableWriteError'));
+    var_dump($e->getWriteResult()->getInsertedCount());
+}
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+bool(true)
+int(3)
+===DONE===
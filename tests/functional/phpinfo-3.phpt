@@ -0,0 +1,15 @@
+--TEST--
+phpinfo() reports mongodb.preconnect (no value)
+--FILE--
+<?php
+
+phpinfo();
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+%a
+mongodb.preconnect => no value => no value
+%a
+===DONE===
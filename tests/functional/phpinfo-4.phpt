@@ -0,0 +1,17 @@
+--TEST--
+phpinfo() reports mongodb.client_pool (ZTS)
+--SKIPIF--
+<?php if (!PHP_ZTS) die('skip mongodb.client_pool is only available for ZTS builds'); ?>
+--FILE--
+<?php
+
+phpinfo();
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+%a
+mongodb.client_pool => Off => Off
+%a
+===DONE===
@@ -0,0 +1,15 @@
+--TEST--
+phpinfo() reports mongodb.preconnect_ping (default)
+--FILE--
+<?php
+
+phpinfo();
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+%a
+mongodb.preconnect_ping => Off => Off
+%a
+===DONE===
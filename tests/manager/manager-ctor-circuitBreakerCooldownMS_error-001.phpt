@@ -0,0 +1,24 @@
+--TEST--
+MongoDB\Driver\Manager::__construct(): invalid circuitBreakerCooldownMS driver option
+--FILE--
+<?php
+
+require_once __DIR__ . '/../utils/tools.php';
+
+echo throws(function() {
+    new MongoDB\Driver\Manager(null, [], ['circuitBreakerCooldownMS' => 'foo']);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+echo throws(function() {
+    new MongoDB\Driver\Manager(null, [], ['circuitBreakerCooldownMS' => -1]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected "circuitBreakerCooldownMS" driver option to be a non-negative 32-bit integer, string given
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected "circuitBreakerCooldownMS" driver option to be a non-negative 32-bit integer, %s given
+===DONE===
@@ -0,0 +1,26 @@
+--TEST--
+MongoDB\Driver\Manager: mongodb.max_persistent_clients evicts unreferenced clients
+--INI--
+mongodb.debug=stderr
+mongodb.max_persistent_clients=1
+--FILE--
+<?php
+
+$a = new MongoDB\Driver\Manager('mongodb://127.0.0.1:27017/?appname=a');
+$b = new MongoDB\Driver\Manager('mongodb://127.0.0.1:27017/?appname=b');
+
+echo "Releasing first Manager\n";
+unset($a);
+
+$c = new MongoDB\Driver\Manager('mongodb://127.0.0.1:27017/?appname=c');
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+%A[%s]     PHONGO: DEBUG   > Stored persistent client with hash: %s
+%A[%s]     PHONGO: DEBUG   > Stored persistent client with hash: %s
+%AReleasing first Manager
+%A[%s]     PHONGO: DEBUG   > Stored persistent client with hash: %s
+[%s]     PHONGO: DEBUG   > Evicting least recently used persistent client with hash: %s
+%A===DONE===%A
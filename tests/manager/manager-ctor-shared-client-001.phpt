@@ -0,0 +1,30 @@
+--TEST--
+MongoDB\Driver\Manager: Managers differing only in read and write options share a client
+--INI--
+mongodb.debug=stderr
+--FILE--
+<?php
+
+$a = new MongoDB\Driver\Manager('mongodb://127.0.0.1:27017/?appname=shared&readPreference=secondary&w=majority');
+$b = new MongoDB\Driver\Manager('mongodb://127.0.0.1:27017/?appname=shared', ['readPreference' => 'nearest', 'readConcernLevel' => 'local']);
+$c = new MongoDB\Driver\Manager('mongodb://127.0.0.1:27017/?appname=shared');
+
+foreach ([$a, $b, $c] as $manager) {
+    printf("%s %s %s\n",
+        $manager->getReadPreference()->getModeString(),
+        var_export($manager->getReadConcern()->getLevel(), true),
+        var_export($manager->getWriteConcern()->getW(), true)
+    );
+}
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+%A[%s]     PHONGO: DEBUG   > Created client with hash: %s
+%A[%s]     PHONGO: DEBUG   > Found client for hash: %s
+%A[%s]     PHONGO: DEBUG   > Found client for hash: %s
+%Asecondary NULL 'majority'
+nearest 'local' NULL
+primary NULL NULL
+===DONE===%A
@@ -0,0 +1,46 @@
+--TEST--
+MongoDB\Driver\Manager::deferBulkWrite() executes writes when flushed
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite;
+$bulk->insert(['_id' => 1]);
+$bulk->insert(['_id' => 2]);
+
+var_dump($manager->deferBulkWrite(NS, $bulk));
+
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([]));
+printf("Documents before flushing: %d\n", count($cursor->toArray()));
+
+echo throws(function() use ($manager, $bulk) {
+    $manager->deferBulkWrite(NS, $bulk);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+$manager->flushDeferredWrites();
+
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([]));
+printf("Documents after flushing: %d\n", count($cursor->toArray()));
+
+/* Writes that are not flushed explicitly are executed at the end of the
+ * request */
+$bulk = new MongoDB\Driver\BulkWrite;
+$bulk->insert(['_id' => 3]);
+$manager->deferBulkWrite(NS, $bulk);
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+NULL
+Documents before flushing: 0
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+BulkWrite objects may only be executed once and this instance has already been executed
+Documents after flushing: 2
+===DONE===
@@ -0,0 +1,38 @@
+--TEST--
+MongoDB\Driver\Manager::deferBulkWrite() with invalid BulkWrite or namespace
+--FILE--
+<?php
+
+require_once __DIR__ . '/../utils/tools.php';
+
+$manager = new MongoDB\Driver\Manager();
+
+echo throws(function() use ($manager) {
+    $manager->deferBulkWrite('db.coll', new MongoDB\Driver\BulkWrite);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n\n";
+
+echo throws(function() use ($manager) {
+    $bulk = new MongoDB\Driver\BulkWrite;
+    $bulk->insert(['x' => 1]);
+    $manager->deferBulkWrite('db', $bulk);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n\n";
+
+echo throws(function() use ($manager) {
+    $bulk = new MongoDB\Driver\BulkWrite(['manager' => $manager, 'namespace' => 'db.coll']);
+    $bulk->insert(['x' => 1]);
+    $manager->deferBulkWrite('db.coll', $bulk);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Cannot do an empty bulk write
+
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Invalid namespace provided: db
+
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Auto-flushing BulkWrite objects cannot be deferred
+===DONE===
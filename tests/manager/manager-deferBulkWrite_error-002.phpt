@@ -0,0 +1,25 @@
+--TEST--
+MongoDB\Driver\Manager::deferBulkWrite() prohibits adding operations to a deferred BulkWrite
+--FILE--
+<?php
+
+require_once __DIR__ . '/../utils/tools.php';
+
+// Valid host refuses connection, so the deferred write is discarded
+$manager = new MongoDB\Driver\Manager('mongodb://localhost:54321', ['serverSelectionTimeoutMS' => 1]);
+
+$bulk = new MongoDB\Driver\BulkWrite;
+$bulk->insert(['x' => 1]);
+$manager->deferBulkWrite('db.coll', $bulk);
+
+echo throws(function() use ($bulk) {
+    $bulk->insert(['x' => 2]);
+}, 'MongoDB\Driver\Exception\LogicException'), "\n";
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+OK: Got MongoDB\Driver\Exception\LogicException
+Cannot add operations to a BulkWrite that has already been executed
+===DONE===
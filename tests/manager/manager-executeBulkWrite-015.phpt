@@ -0,0 +1,49 @@
+--TEST--
+MongoDB\Driver\Manager::executeBulkWrite() with an auto-flushing BulkWrite
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite(['manager' => $manager, 'namespace' => NS, 'flushOperations' => 2]);
+
+$bulk->insertMany([['_id' => 1], ['_id' => 2], ['_id' => 3], ['_id' => 4], ['_id' => 5]]);
+
+/* The first four inserts have already been executed */
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([]));
+printf("Documents before execution: %d\n", count($cursor->toArray()));
+
+$bulk->update(['_id' => 6], ['$set' => ['x' => 1]], ['upsert' => true]);
+$bulk->delete(['_id' => 1]);
+
+$result = $manager->executeBulkWrite(NS, $bulk);
+printWriteResult($result);
+
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([]));
+printf("Documents after execution: %d\n", count($cursor->toArray()));
+
+echo throws(function() use ($bulk) {
+    $bulk->insert(['_id' => 7]);
+}, 'MongoDB\Driver\Exception\LogicException'), "\n";
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+Documents before execution: 4
+server: %s:%d
+insertedCount: 5
+matchedCount: 0
+modifiedCount: 0
+upsertedCount: 1
+deletedCount: 1
+upsertedId[5]: int(6)
+Documents after execution: 5
+OK: Got MongoDB\Driver\Exception\LogicException
+Cannot add operations to a BulkWrite that has already been executed
+===DONE===
@@ -0,0 +1,82 @@
+--TEST--
+MongoDB\Driver\Manager::executeBulkWrite() stops an ordered auto-flushing BulkWrite at the first failing flush
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite(['manager' => $manager, 'namespace' => NS, 'flushOperations' => 2]);
+
+try {
+    $bulk->insertMany([['_id' => 1], ['_id' => 2], ['_id' => 3], ['_id' => 2], ['_id' => 4]]);
+    echo "FAILED\n";
+} catch (MongoDB\Driver\Exception\BulkWriteException $e) {
+    printf("BulkWriteException: %s\n", $e->getMessage());
+
+    echo "\n===> WriteResult\n";
+    printWriteResult($e->getWriteResult());
+}
+
+echo "\n";
+
+echo throws(function() use ($manager, $bulk) {
+    $manager->executeBulkWrite(NS, $bulk);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+echo "\n===> Collection\n";
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([]));
+var_dump(iterator_to_array($cursor));
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+BulkWriteException: %SE11000 duplicate key error %s: phongo.manager_manager_executeBulkWrite_error_012%sdup key: { %S: 2 }
+
+===> WriteResult
+server: %s:%d
+insertedCount: 3
+matchedCount: 0
+modifiedCount: 0
+upsertedCount: 0
+deletedCount: 0
+object(MongoDB\Driver\WriteError)#%d (%d) {
+  ["message"]=>
+  string(%d) "%s"
+  ["code"]=>
+  int(11000)
+  ["index"]=>
+  int(3)
+  ["info"]=>
+  NULL
+}
+writeError[3].message: %s
+writeError[3].code: 11000
+
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+BulkWrite objects may only be executed once and this instance has already been executed
+
+===> Collection
+array(3) {
+  [0]=>
+  object(stdClass)#%d (1) {
+    ["_id"]=>
+    int(1)
+  }
+  [1]=>
+  object(stdClass)#%d (1) {
+    ["_id"]=>
+    int(2)
+  }
+  [2]=>
+  object(stdClass)#%d (1) {
+    ["_id"]=>
+    int(3)
+  }
+}
+===DONE===
@@ -0,0 +1,73 @@
+--TEST--
+MongoDB\Driver\Manager::executeClientBulkWrite() writes to multiple namespaces
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+<?php skip_if_not_clean(DATABASE_NAME, COLLECTION_NAME . '_other'); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+$otherNs = NS . '_other';
+
+$bulk = new MongoDB\Driver\ClientBulkWrite;
+$bulk->insert(NS, ['_id' => 1, 'x' => 1]);
+$bulk->insert($otherNs, ['_id' => 1, 'x' => 1]);
+$bulk->insert(NS, ['_id' => 2, 'x' => 2]);
+$bulk->update($otherNs, ['_id' => 1], ['$set' => ['x' => 2]]);
+$bulk->update($otherNs, ['_id' => 2], ['$set' => ['x' => 3]], ['upsert' => true]);
+$bulk->delete(NS, ['_id' => 2]);
+
+$result = $manager->executeClientBulkWrite($bulk);
+
+printf("Inserted %d document(s)\n", $result->getInsertedCount());
+printf("Matched %d document(s)\n", $result->getMatchedCount());
+printf("Modified %d document(s)\n", $result->getModifiedCount());
+printf("Upserted %d document(s)\n", $result->getUpsertedCount());
+printf("Deleted %d document(s)\n", $result->getDeletedCount());
+var_dump($result->getUpsertedIds());
+
+var_dump($manager->executeQuery(NS, new MongoDB\Driver\Query([]))->toArray());
+var_dump($manager->executeQuery($otherNs, new MongoDB\Driver\Query([]))->toArray());
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+Inserted 3 document(s)
+Matched 1 document(s)
+Modified 1 document(s)
+Upserted 1 document(s)
+Deleted 1 document(s)
+array(1) {
+  [4]=>
+  int(2)
+}
+array(1) {
+  [0]=>
+  object(stdClass)#%d (2) {
+    ["_id"]=>
+    int(1)
+    ["x"]=>
+    int(1)
+  }
+}
+array(2) {
+  [0]=>
+  object(stdClass)#%d (2) {
+    ["_id"]=>
+    int(1)
+    ["x"]=>
+    int(2)
+  }
+  [1]=>
+  object(stdClass)#%d (2) {
+    ["_id"]=>
+    int(2)
+    ["x"]=>
+    int(3)
+  }
+}
+===DONE===
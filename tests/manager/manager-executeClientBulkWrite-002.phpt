@@ -0,0 +1,37 @@
+--TEST--
+MongoDB\Driver\Manager::executeClientBulkWrite() write concern inheritance
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_replica_set(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+require_once __DIR__ . "/../utils/observer.php";
+
+$manager = new MongoDB\Driver\Manager(URI, ['w' => 'majority']);
+
+(new CommandObserver)->observe(
+    function() use ($manager) {
+        $bulk = new MongoDB\Driver\ClientBulkWrite;
+        $bulk->insert(NS, ['x' => 1]);
+        $result = $manager->executeClientBulkWrite($bulk);
+        var_dump($result->getWriteConcern()->getW());
+
+        $bulk = new MongoDB\Driver\ClientBulkWrite;
+        $bulk->insert(NS, ['x' => 1]);
+        $manager->executeClientBulkWrite($bulk, ['writeConcern' => new MongoDB\Driver\WriteConcern(1)]);
+    },
+    function(stdClass $command) {
+        echo json_encode($command->writeConcern), "\n";
+    }
+);
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+{"w":"majority"}
+string(8) "majority"
+{"w":1}
+===DONE===
@@ -0,0 +1,55 @@
+--TEST--
+MongoDB\Driver\Manager::executeClientBulkWrite() reports write errors by operation index
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+<?php skip_if_not_clean(DATABASE_NAME, COLLECTION_NAME . '_other'); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+$otherNs = NS . '_other';
+
+foreach ([true, false] as $ordered) {
+    $bulk = new MongoDB\Driver\ClientBulkWrite(['ordered' => $ordered]);
+    $bulk->insert(NS, ['_id' => $ordered ? 1 : 2]);
+    $bulk->insert($otherNs, ['_id' => $ordered ? 1 : 2]);
+    $bulk->insert($otherNs, ['_id' => $ordered ? 1 : 2]);
+    $bulk->insert(NS, ['_id' => $ordered ? 3 : 4]);
+
+    try {
+        $manager->executeClientBulkWrite($bulk);
+    } catch (MongoDB\Driver\Exception\BulkWriteException $e) {
+        $result = $e->getWriteResult();
+
+        printf("ordered: %s, inserted: %d\n", var_export($ordered, true), $result->getInsertedCount());
+
+        foreach ($result->getWriteErrors() as $error) {
+            printf("index: %d, code: %d\n", $error->getIndex(), $error->getCode());
+        }
+    }
+}
+
+echo throws(function() use ($manager, $bulk) {
+    $manager->executeClientBulkWrite($bulk);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+echo throws(function() use ($manager) {
+    $manager->executeClientBulkWrite(new MongoDB\Driver\ClientBulkWrite);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+ordered: true, inserted: 2
+index: 2, code: 11000
+ordered: false, inserted: 3
+index: 2, code: 11000
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+ClientBulkWrite objects may only be executed once and this instance has already been executed
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Cannot do an empty bulk write
+===DONE===
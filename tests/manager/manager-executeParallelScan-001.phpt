@@ -0,0 +1,48 @@
+--TEST--
+MongoDB\Driver\Manager::executeParallelScan() partitions a query by _id
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite();
+for ($i = 0; $i < 200; $i++) {
+    $bulk->insert(['_id' => $i, 'even' => $i % 2 == 0]);
+}
+$bulk->insert(['_id' => 'string', 'even' => true]);
+$manager->executeBulkWrite(NS, $bulk);
+
+foreach ([1, 4] as $partitions) {
+    $cursors = $manager->executeParallelScan(NS, new MongoDB\Driver\Query(['even' => true]), $partitions);
+
+    var_dump(count($cursors) >= 1 && count($cursors) <= $partitions);
+
+    $ids = [];
+
+    foreach ($cursors as $cursor) {
+        foreach ($cursor as $document) {
+            $ids[] = $document->_id;
+        }
+    }
+
+    var_dump(count($ids), count(array_unique($ids, SORT_STRING)), in_array('string', $ids, true));
+}
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+bool(true)
+int(101)
+int(101)
+bool(true)
+bool(true)
+int(101)
+int(101)
+bool(true)
+===DONE===
@@ -0,0 +1,40 @@
+--TEST--
+MongoDB\Driver\Manager::executeParallelScan() samples split points using the session option
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_libmongoc_crypto(); ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_server_version('<', '3.6'); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+require_once __DIR__ . "/../utils/observer.php";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite();
+for ($i = 0; $i < 20; $i++) {
+    $bulk->insert(['_id' => $i]);
+}
+$manager->executeBulkWrite(NS, $bulk);
+
+$session = $manager->startSession();
+$lsid = $session->getLogicalSessionId();
+
+(new CommandObserver)->observe(
+    function() use ($manager, $session) {
+        $manager->executeParallelScan(NS, new MongoDB\Driver\Query([]), 2, ['session' => $session]);
+    },
+    function(stdClass $command) use ($lsid) {
+        printf("%s uses session: %s\n", array_keys((array) $command)[0], $command->lsid == $lsid ? 'yes' : 'no');
+    }
+);
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+aggregate uses session: yes
+find uses session: yes
+%A===DONE===
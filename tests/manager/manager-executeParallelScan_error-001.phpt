@@ -0,0 +1,25 @@
+--TEST--
+MongoDB\Driver\Manager::executeParallelScan() with an invalid number of partitions
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager();
+
+foreach ([0, 1025] as $partitions) {
+    echo throws(function() use ($manager, $partitions) {
+        $manager->executeParallelScan(NS, new MongoDB\Driver\Query([]), $partitions);
+    }, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+}
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected partitions to be between 1 and 1024, 0 given
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected partitions to be between 1 and 1024, 1025 given
+===DONE===
@@ -0,0 +1,36 @@
+--TEST--
+MongoDB\Driver\Manager::executeParallelScan() with unsupported query options
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager();
+
+$tests = [
+    ['sort' => ['x' => 1]],
+    ['limit' => 5],
+    ['limit' => -5],
+    ['skip' => 10],
+];
+
+foreach ($tests as $options) {
+    echo throws(function() use ($manager, $options) {
+        $manager->executeParallelScan(NS, new MongoDB\Driver\Query([], $options), 2);
+    }, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+}
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Parallel scans do not support the "sort" query option
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Parallel scans do not support the "limit" query option
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Parallel scans do not support the "limit" query option
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Parallel scans do not support the "skip" query option
+===DONE===
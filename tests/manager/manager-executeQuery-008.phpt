@@ -0,0 +1,74 @@
+--TEST--
+MongoDB\Driver\Manager::executeQuery() coalesces identical reads with the "coalesceReads" driver option
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+class CommandLogger implements MongoDB\Driver\Monitoring\CommandSubscriber
+{
+    public function commandStarted(MongoDB\Driver\Monitoring\CommandStartedEvent $event)
+    {
+        printf("Started: %s\n", $event->getCommandName());
+    }
+
+    public function commandSucceeded(MongoDB\Driver\Monitoring\CommandSucceededEvent $event)
+    {
+    }
+
+    public function commandFailed(MongoDB\Driver\Monitoring\CommandFailedEvent $event)
+    {
+    }
+}
+
+$manager = new MongoDB\Driver\Manager(URI, [], ['coalesceReads' => true]);
+
+$bulk = new MongoDB\Driver\BulkWrite;
+$bulk->insert(['_id' => 1, 'x' => 1]);
+$bulk->insert(['_id' => 2, 'x' => 2]);
+$manager->executeBulkWrite(NS, $bulk);
+
+MongoDB\Driver\Monitoring\addSubscriber(new CommandLogger);
+
+$query = new MongoDB\Driver\Query(['x' => ['$gt' => 0]]);
+
+echo "Executing query twice\n";
+var_dump(count($manager->executeQuery(NS, $query)->toArray()));
+var_dump(count($manager->executeQuery(NS, new MongoDB\Driver\Query(['x' => ['$gt' => 0]]))->toArray()));
+
+echo "\nExecuting query with a different filter\n";
+var_dump(count($manager->executeQuery(NS, new MongoDB\Driver\Query(['x' => 1]))->toArray()));
+
+echo "\nWriting to the namespace\n";
+$bulk = new MongoDB\Driver\BulkWrite;
+$bulk->insert(['_id' => 3, 'x' => 3]);
+$manager->executeBulkWrite(NS, $bulk);
+
+echo "\nExecuting query after the write\n";
+var_dump(count($manager->executeQuery(NS, $query)->toArray()));
+var_dump(count($manager->executeQuery(NS, $query)->toArray()));
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+Executing query twice
+Started: find
+int(2)
+int(2)
+
+Executing query with a different filter
+Started: find
+int(1)
+
+Writing to the namespace
+Started: insert
+
+Executing query after the write
+Started: find
+int(3)
+int(3)
+===DONE===
@@ -0,0 +1,58 @@
+--TEST--
+MongoDB\Driver\Manager::executeQuery() does not coalesce reads with different hedge options
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+class CommandLogger implements MongoDB\Driver\Monitoring\CommandSubscriber
+{
+    public function commandStarted(MongoDB\Driver\Monitoring\CommandStartedEvent $event)
+    {
+        printf("Started: %s\n", $event->getCommandName());
+    }
+
+    public function commandSucceeded(MongoDB\Driver\Monitoring\CommandSucceededEvent $event)
+    {
+    }
+
+    public function commandFailed(MongoDB\Driver\Monitoring\CommandFailedEvent $event)
+    {
+    }
+}
+
+$manager = new MongoDB\Driver\Manager(URI, [], ['coalesceReads' => true]);
+
+$bulk = new MongoDB\Driver\BulkWrite;
+$bulk->insert(['_id' => 1, 'x' => 1]);
+$manager->executeBulkWrite(NS, $bulk);
+
+MongoDB\Driver\Monitoring\addSubscriber(new CommandLogger);
+
+$query = new MongoDB\Driver\Query(['x' => 1]);
+$unhedged = new MongoDB\Driver\ReadPreference(MongoDB\Driver\ReadPreference::RP_PRIMARY_PREFERRED);
+$hedged = new MongoDB\Driver\ReadPreference(MongoDB\Driver\ReadPreference::RP_PRIMARY_PREFERRED, null, ['hedge' => ['enabled' => true]]);
+
+echo "Executing query without hedge\n";
+var_dump(count($manager->executeQuery(NS, $query, ['readPreference' => $unhedged])->toArray()));
+
+echo "\nExecuting query with hedge\n";
+var_dump(count($manager->executeQuery(NS, $query, ['readPreference' => $hedged])->toArray()));
+var_dump(count($manager->executeQuery(NS, $query, ['readPreference' => $hedged])->toArray()));
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+Executing query without hedge
+Started: find
+int(1)
+
+Executing query with hedge
+Started: find
+int(1)
+int(1)
+===DONE===
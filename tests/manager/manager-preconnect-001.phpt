@@ -0,0 +1,17 @@
+--TEST--
+MongoDB\Driver\Manager: mongodb.preconnect creates a persistent client before the first Manager
+--INI--
+mongodb.debug=stderr
+mongodb.preconnect="mongodb://127.0.0.1:27999/?connectTimeoutMS=100&serverSelectionTimeoutMS=100"
+--FILE--
+<?php
+
+$manager = new MongoDB\Driver\Manager('mongodb://127.0.0.1:27999/?connectTimeoutMS=100&serverSelectionTimeoutMS=100');
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+%A[%s]     PHONGO: DEBUG   > Created client with hash: %s
+%A[%s]     PHONGO: DEBUG   > Found client for hash: %s
+%A===DONE===%A
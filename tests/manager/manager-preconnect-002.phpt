@@ -0,0 +1,19 @@
+--TEST--
+MongoDB\Driver\Manager: mongodb.preconnect_ping connects preconnected clients
+--INI--
+mongodb.debug=stderr
+mongodb.preconnect="mongodb://127.0.0.1:27999/?connectTimeoutMS=100&serverSelectionTimeoutMS=100"
+mongodb.preconnect_ping=1
+--FILE--
+<?php
+
+$manager = new MongoDB\Driver\Manager('mongodb://127.0.0.1:27999/?connectTimeoutMS=100&serverSelectionTimeoutMS=100');
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+%A[%s]     PHONGO: DEBUG   > Created client with hash: %s
+%A[%s]     PHONGO: WARNING > Could not connect client for mongodb.preconnect: %s
+%A[%s]     PHONGO: DEBUG   > Found client for hash: %s
+%A===DONE===%A
@@ -0,0 +1,49 @@
+--TEST--
+MongoDB\Driver\Manager::prepareQuery() returns a reusable prepared query
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_libmongoc_crypto(); ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_server_version('<', '3.6'); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite();
+$bulk->insert(['_id' => 1, 'x' => 1]);
+$bulk->insert(['_id' => 2, 'x' => 2]);
+$bulk->insert(['_id' => 3, 'x' => 3]);
+$manager->executeBulkWrite(NS, $bulk);
+
+$prepared = $manager->prepareQuery(NS, new MongoDB\Driver\Query(['x' => ['$gt' => 1]], ['projection' => ['_id' => 1]]));
+
+var_dump($prepared instanceof MongoDB\Driver\PreparedOperation);
+
+for ($i = 0; $i < 2; $i++) {
+    echo json_encode($prepared->execute()->toArray()), "\n";
+}
+
+$session = $manager->startSession();
+$cursor = $prepared->execute(['session' => $session]);
+echo json_encode($cursor->toArray()), "\n";
+
+$prepared = $manager->prepareCommand(DATABASE_NAME, new MongoDB\Driver\Command(['count' => COLLECTION_NAME]));
+
+for ($i = 0; $i < 2; $i++) {
+    var_dump($prepared->execute()->toArray()[0]->n);
+}
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+bool(true)
+[{"_id":2},{"_id":3}]
+[{"_id":2},{"_id":3}]
+[{"_id":2},{"_id":3}]
+int(3)
+int(3)
+===DONE===
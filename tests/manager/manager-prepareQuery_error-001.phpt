@@ -0,0 +1,37 @@
+--TEST--
+MongoDB\Driver\Manager::prepareQuery() and prepareCommand() do not accept a session
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_libmongoc_crypto(); ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_server_version('<', '3.6'); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+$session = $manager->startSession();
+
+echo throws(function() use ($manager, $session) {
+    $manager->prepareQuery(NS, new MongoDB\Driver\Query([]), ['session' => $session]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+echo throws(function() use ($manager, $session) {
+    $manager->prepareCommand(DATABASE_NAME, new MongoDB\Driver\Command(['ping' => 1]), ['session' => $session]);
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+echo throws(function() use ($manager) {
+    $manager->prepareQuery('invalid', new MongoDB\Driver\Query([]));
+}, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+The "session" option must be specified when executing a prepared operation
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+The "session" option must be specified when executing a prepared operation
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Invalid namespace provided: invalid
+===DONE===
@@ -0,0 +1,37 @@
+--TEST--
+MongoDB\Driver\PreparedOperation::execute() only accepts a session option
+--FILE--
+<?php
+
+require_once __DIR__ . '/../utils/tools.php';
+
+$manager = new MongoDB\Driver\Manager();
+
+$operations = [
+    $manager->prepareQuery('db.coll', new MongoDB\Driver\Query([])),
+    $manager->prepareCommand('db', new MongoDB\Driver\Command(['ping' => 1])),
+];
+
+foreach ($operations as $operation) {
+    echo throws(function() use ($operation) {
+        $operation->execute(['readPreference' => new MongoDB\Driver\ReadPreference('secondary')]);
+    }, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+
+    echo throws(function() use ($operation) {
+        $operation->execute(['typeMap' => ['root' => 'array']]);
+    }, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+}
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Only the "session" option may be specified when executing a prepared operation, "readPreference" given
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Only the "session" option may be specified when executing a prepared operation, "typeMap" given
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Only the "session" option may be specified when executing a prepared operation, "readPreference" given
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Only the "session" option may be specified when executing a prepared operation, "typeMap" given
+===DONE===
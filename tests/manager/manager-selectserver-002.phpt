@@ -0,0 +1,48 @@
+--TEST--
+MongoDB\Driver\Manager::selectServer() reuses selection results for equivalent read preferences
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_replica_set(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+ini_set('mongodb.debug', 'stderr');
+
+echo "Selecting primary\n";
+$primary = $manager->selectServer(new MongoDB\Driver\ReadPreference('primary'));
+
+echo "Selecting primary again\n";
+var_dump($primary == $manager->selectServer(new MongoDB\Driver\ReadPreference('primary')));
+
+ini_set('mongodb.debug', '');
+
+/* Read preferences with tags that cannot match must not use the cached result
+ * for the untagged read preference. */
+$manager->selectServer(new MongoDB\Driver\ReadPreference('nearest'));
+
+ini_set('mongodb.debug', 'stderr');
+
+echo "Selecting with unmatched tags\n";
+echo throws(function() use ($manager) {
+    $manager->selectServer(new MongoDB\Driver\ReadPreference('nearest', [['dc' => 'does-not-exist']]));
+}, 'MongoDB\Driver\Exception\ConnectionTimeoutException'), "\n";
+
+ini_set('mongodb.debug', '');
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+Selecting primary
+%A[%s]     PHONGO: DEBUG   > Caching selection of server %d for reads
+Selecting primary again
+[%s]     PHONGO: DEBUG   > Reusing cached selection of server %d for reads
+bool(true)
+Selecting with unmatched tags
+%AOK: Got MongoDB\Driver\Exception\ConnectionTimeoutException
+No suitable servers found (`serverSelectionTryOnce` set): %s
+===DONE===
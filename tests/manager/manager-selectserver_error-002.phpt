@@ -0,0 +1,38 @@
+--TEST--
+MongoDB\Driver\Manager::selectServer() fails immediately while the circuit breaker is open
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$rp = new MongoDB\Driver\ReadPreference(MongoDB\Driver\ReadPreference::RP_PRIMARY);
+
+// Valid host refuses connection
+$manager = new MongoDB\Driver\Manager('mongodb://localhost:54321', ['serverSelectionTimeoutMS' => 1], ['circuitBreakerCooldownMS' => 60000]);
+
+echo throws(function() use ($manager, $rp) {
+    $manager->selectServer($rp);
+}, 'MongoDB\Driver\Exception\ConnectionTimeoutException'), "\n";
+
+// The breaker is shared by Managers using the same client
+$manager = new MongoDB\Driver\Manager('mongodb://localhost:54321', ['serverSelectionTimeoutMS' => 1], ['circuitBreakerCooldownMS' => 60000]);
+
+echo throws(function() use ($manager, $rp) {
+    $manager->selectServer($rp);
+}, 'MongoDB\Driver\Exception\ConnectionTimeoutException'), "\n";
+
+// Breakers are kept per read preference, so other selections are attempted
+echo throws(function() use ($manager) {
+    $manager->selectServer(new MongoDB\Driver\ReadPreference(MongoDB\Driver\ReadPreference::RP_SECONDARY));
+}, 'MongoDB\Driver\Exception\ConnectionTimeoutException'), "\n";
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECTF--
+OK: Got MongoDB\Driver\Exception\ConnectionTimeoutException
+No suitable servers found (`serverSelectionTryOnce` set): %s
+OK: Got MongoDB\Driver\Exception\ConnectionTimeoutException
+No suitable servers found: server selection failed recently, retrying in %dms
+OK: Got MongoDB\Driver\Exception\ConnectionTimeoutException
+No suitable servers found (`serverSelectionTryOnce` set): %s
+===DONE===
@@ -0,0 +1,69 @@
+--TEST--
+MongoDB\Driver\MergedCursor merges sorted cursors
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite();
+$bulk->insert(['_id' => 1, 'shard' => 'a', 'x' => ['y' => 5]]);
+$bulk->insert(['_id' => 2, 'shard' => 'a', 'x' => ['y' => 2]]);
+$bulk->insert(['_id' => 3, 'shard' => 'b', 'x' => ['y' => 4]]);
+$bulk->insert(['_id' => 4, 'shard' => 'b', 'x' => ['y' => 2]]);
+$bulk->insert(['_id' => 5, 'shard' => 'c', 'x' => ['y' => 3.5]]);
+$bulk->insert(['_id' => 6, 'shard' => 'c']);
+$manager->executeBulkWrite(NS, $bulk);
+
+function shardCursor($manager, $shard, array $sort)
+{
+    $query = new MongoDB\Driver\Query(['shard' => $shard], ['sort' => $sort, 'batchSize' => 1]);
+
+    return $manager->executeQuery(NS, $query);
+}
+
+$sort = ['x.y' => 1, '_id' => -1];
+$cursors = [shardCursor($manager, 'a', $sort), shardCursor($manager, 'b', $sort), shardCursor($manager, 'c', $sort)];
+$cursors[0]->setTypeMap(['root' => 'array']);
+
+$merged = new MongoDB\Driver\MergedCursor($cursors, $sort);
+
+foreach ($merged as $key => $document) {
+    printf("%d: %d\n", $key, $document['_id']);
+}
+
+$sort = ['x.y' => -1];
+$merged = new MongoDB\Driver\MergedCursor([shardCursor($manager, 'a', $sort), shardCursor($manager, 'b', $sort), shardCursor($manager, 'c', $sort)], $sort);
+$merged->setTypeMap(['root' => 'array', 'document' => 'array']);
+
+var_dump(array_map(function($document) { return $document['x']['y'] ?? null; }, iterator_to_array($merged)));
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+0: 6
+1: 4
+2: 2
+3: 5
+4: 3
+5: 1
+array(6) {
+  [0]=>
+  int(5)
+  [1]=>
+  int(4)
+  [2]=>
+  float(3.5)
+  [3]=>
+  int(2)
+  [4]=>
+  int(2)
+  [5]=>
+  NULL
+}
+===DONE===
@@ -0,0 +1,48 @@
+--TEST--
+MongoDB\Driver\MergedCursor::__construct() with invalid arguments
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([]));
+
+$tests = [
+    [[$cursor], []],
+    [[$cursor], ['x']],
+    [[$cursor], ['x' => 0]],
+    [[$cursor], ['x' => 'asc']],
+    [[], ['x' => 1]],
+    [[$cursor, new stdClass], ['x' => 1]],
+    [[$cursor, $cursor], ['x' => 1]],
+];
+
+foreach ($tests as $test) {
+    echo throws(function() use ($test) {
+        new MongoDB\Driver\MergedCursor($test[0], $test[1]);
+    }, 'MongoDB\Driver\Exception\InvalidArgumentException'), "\n";
+}
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected sort specification to contain at least one field
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected sort specification to contain only non-empty field names
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected sort direction for "x" to be 1 or -1
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected sort direction for "x" to be 1 or -1
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected at least one cursor
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected cursor 1 to be MongoDB\Driver\Cursor, stdClass given
+OK: Got MongoDB\Driver\Exception\InvalidArgumentException
+Expected cursor 1 to be distinct from cursor 0
+===DONE===
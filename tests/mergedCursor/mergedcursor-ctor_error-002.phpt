@@ -0,0 +1,26 @@
+--TEST--
+MongoDB\Driver\MergedCursor::__construct() cannot be called twice
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+$cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query([]));
+
+$merged = new MongoDB\Driver\MergedCursor([$cursor], ['x' => 1]);
+
+echo throws(function() use ($merged, $cursor) {
+    $merged->__construct([$cursor], ['x' => 1]);
+}, 'MongoDB\Driver\Exception\LogicException'), "\n";
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+OK: Got MongoDB\Driver\Exception\LogicException
+MergedCursor objects may only be constructed once
+===DONE===
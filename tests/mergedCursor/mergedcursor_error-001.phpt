@@ -0,0 +1,36 @@
+--TEST--
+MongoDB\Driver\MergedCursor does not support sort fields containing arrays
+--SKIPIF--
+<?php require __DIR__ . "/../utils/basic-skipif.inc"; ?>
+<?php skip_if_not_live(); ?>
+<?php skip_if_not_clean(); ?>
+--FILE--
+<?php
+require_once __DIR__ . "/../utils/basic.inc";
+
+$manager = new MongoDB\Driver\Manager(URI);
+
+$bulk = new MongoDB\Driver\BulkWrite();
+$bulk->insert(['_id' => 1, 'x' => [3, 1]]);
+$bulk->insert(['_id' => 2, 'x' => ['y' => 2]]);
+$bulk->insert(['_id' => 3, 'x' => [['y' => 1]]]);
+$manager->executeBulkWrite(NS, $bulk);
+
+foreach (['x', 'x.y'] as $field) {
+    $sort = [$field => 1];
+    $cursor = $manager->executeQuery(NS, new MongoDB\Driver\Query(['_id' => ['$ne' => 2]], ['sort' => $sort]));
+
+    echo throws(function() use ($cursor, $sort) {
+        foreach (new MongoDB\Driver\MergedCursor([$cursor], $sort) as $document) {}
+    }, 'MongoDB\Driver\Exception\UnexpectedValueException'), "\n";
+}
+
+?>
+===DONE===
+<?php exit(0); ?>
+--EXPECT--
+OK: Got MongoDB\Driver\Exception\UnexpectedValueException
+Cannot merge cursors on sort field "x", which contains an array
+OK: Got MongoDB\Driver\Exception\UnexpectedValueException
+Cannot merge cursors on sort field "x.y", which contains an array
+===DONE===